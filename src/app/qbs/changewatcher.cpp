@@ -0,0 +1,186 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#include "changewatcher.h"
+
+#include <QtCore/qdir.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qfilesystemwatcher.h>
+#include <QtCore/qtimer.h>
+
+#include <algorithm>
+
+namespace qbs {
+
+ChangeWatcher::ChangeWatcher(QObject *parent)
+    : QObject(parent)
+    , m_watcher(new QFileSystemWatcher(this))
+    , m_timer(new QTimer(this))
+    , m_projectChanged(false)
+{
+    // Editors and version control systems tend to touch several files in a row, so we wait
+    // for things to settle down before reporting anything.
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(200);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged,
+            this, &ChangeWatcher::handleFileChanged);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged,
+            this, &ChangeWatcher::handleDirectoryChanged);
+    connect(m_timer, &QTimer::timeout, this, &ChangeWatcher::handleTimeout);
+}
+
+void ChangeWatcher::watch(const QSet<QString> &files, const QSet<QString> &buildSystemFiles,
+                          const QSet<QString> &directories, const QStringList &buildDirectories)
+{
+    // Compare against the old snapshot first, so changes that came in during the last
+    // build do not get lost.
+    checkDirectories();
+
+    m_buildSystemFiles = buildSystemFiles;
+    m_buildDirectories = buildDirectories;
+    m_unwatchedPaths.clear();
+
+    const QSet<QString> allFiles = files + buildSystemFiles;
+    const QStringList watchedFiles = m_watcher->files();
+    QStringList filesToRemove;
+    for (const QString &filePath : watchedFiles) {
+        if (!allFiles.contains(filePath))
+            filesToRemove << filePath;
+    }
+    if (!filesToRemove.empty())
+        m_watcher->removePaths(filesToRemove);
+    const QSet<QString> filesToAdd = allFiles - watchedFiles.toSet();
+    if (!filesToAdd.empty())
+        addPaths(filesToAdd.toList());
+
+    const QStringList watchedDirectories = m_watcher->directories();
+    QStringList directoriesToRemove;
+    for (const QString &dirPath : watchedDirectories) {
+        if (!directories.contains(dirPath))
+            directoriesToRemove << dirPath;
+    }
+    if (!directoriesToRemove.empty())
+        m_watcher->removePaths(directoriesToRemove);
+    const QSet<QString> directoriesToAdd = directories - watchedDirectories.toSet();
+    if (!directoriesToAdd.empty())
+        addPaths(directoriesToAdd.toList());
+
+    m_directoryEntries.clear();
+    for (const QString &dirPath : directories)
+        m_directoryEntries.insert(dirPath, directoryEntries(dirPath));
+}
+
+QStringList ChangeWatcher::takeChangedFiles()
+{
+    const QStringList changedFiles = m_changedFiles.toList();
+    m_changedFiles.clear();
+    m_projectChanged = false;
+    return changedFiles;
+}
+
+void ChangeWatcher::handleFileChanged(const QString &filePath)
+{
+    if (m_buildSystemFiles.contains(filePath))
+        m_projectChanged = true;
+    else
+        m_changedFiles.insert(filePath);
+    m_timer->start();
+}
+
+void ChangeWatcher::handleDirectoryChanged(const QString &dirPath)
+{
+    m_changedDirectories.insert(dirPath);
+    m_timer->start();
+}
+
+void ChangeWatcher::handleTimeout()
+{
+    checkDirectories();
+
+    // Files that get saved by replacing them are no longer watched afterwards.
+    const QSet<QString> watchedFiles = m_watcher->files().toSet();
+    for (const QString &filePath : qAsConst(m_changedFiles)) {
+        if (!watchedFiles.contains(filePath) && QFileInfo(filePath).exists())
+            addPaths(QStringList(filePath));
+    }
+    for (const QString &filePath : qAsConst(m_buildSystemFiles)) {
+        if (!watchedFiles.contains(filePath) && QFileInfo(filePath).exists())
+            addPaths(QStringList(filePath));
+    }
+
+    if (hasChanges())
+        emit changesDetected();
+}
+
+// Modifications of existing files are reported via the file watches, so a directory is
+// only relevant if its list of entries has changed. This can invalidate wildcards.
+void ChangeWatcher::checkDirectories()
+{
+    for (const QString &dirPath : qAsConst(m_changedDirectories)) {
+        const auto it = m_directoryEntries.find(dirPath);
+        if (it != m_directoryEntries.end() && it.value() != directoryEntries(dirPath))
+            m_projectChanged = true;
+    }
+    m_changedDirectories.clear();
+}
+
+void ChangeWatcher::addPaths(const QStringList &paths)
+{
+    const QStringList failedPaths = m_watcher->addPaths(paths);
+    for (const QString &path : failedPaths)
+        m_unwatchedPaths.insert(path);
+}
+
+QStringList ChangeWatcher::directoryEntries(const QString &dirPath) const
+{
+    QStringList entries;
+    const QStringList allEntries = QDir(dirPath).entryList(QDir::AllEntries
+                                                           | QDir::NoDotAndDotDot, QDir::Name);
+    for (const QString &entry : allEntries) {
+        const QString entryPath = dirPath + QLatin1Char('/') + entry;
+        const bool isBuildDirectory = std::any_of(m_buildDirectories.cbegin(),
+                m_buildDirectories.cend(), [&entryPath](const QString &buildDir) {
+            return buildDir == entryPath || buildDir.startsWith(entryPath + QLatin1Char('/'));
+        });
+        if (!isBuildDirectory)
+            entries << entry;
+    }
+    return entries;
+}
+
+} // namespace qbs
@@ -0,0 +1,100 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_CHANGEWATCHER_H
+#define QBS_CHANGEWATCHER_H
+
+#include <QtCore/qhash.h>
+#include <QtCore/qobject.h>
+#include <QtCore/qset.h>
+#include <QtCore/qstringlist.h>
+
+QT_BEGIN_NAMESPACE
+class QFileSystemWatcher;
+class QTimer;
+QT_END_NAMESPACE
+
+namespace qbs {
+
+// Watches the files of resolved projects and reports which of them have changed.
+// A change to a build system file or the appearance or disappearance of a file in one of the
+// watched directories means that the project needs to be re-resolved.
+class ChangeWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ChangeWatcher(QObject *parent = nullptr);
+
+    // The build directories are ignored when looking for new or removed files.
+    void watch(const QSet<QString> &files, const QSet<QString> &buildSystemFiles,
+               const QSet<QString> &directories, const QStringList &buildDirectories);
+
+    bool hasChanges() const { return m_projectChanged || !m_changedFiles.empty(); }
+    bool projectChanged() const { return m_projectChanged; }
+    QStringList takeChangedFiles();
+
+    // Every file and directory needs its own watch, which can fail, for instance if the
+    // system limit for the number of watches is reached. Changes to these paths go unnoticed.
+    QStringList unwatchedPaths() const { return m_unwatchedPaths.toList(); }
+    bool watchesAllPaths() const { return m_unwatchedPaths.empty(); }
+
+signals:
+    void changesDetected();
+
+private:
+    void handleFileChanged(const QString &filePath);
+    void handleDirectoryChanged(const QString &dirPath);
+    void handleTimeout();
+    void checkDirectories();
+    void addPaths(const QStringList &paths);
+    QStringList directoryEntries(const QString &dirPath) const;
+
+    QFileSystemWatcher * const m_watcher;
+    QTimer * const m_timer;
+    QSet<QString> m_buildSystemFiles;
+    QStringList m_buildDirectories;
+    QHash<QString, QStringList> m_directoryEntries;
+    QSet<QString> m_changedDirectories;
+    QSet<QString> m_changedFiles;
+    QSet<QString> m_unwatchedPaths;
+    bool m_projectChanged;
+};
+
+} // namespace qbs
+
+#endif // QBS_CHANGEWATCHER_H
@@ -39,6 +39,7 @@
 #include "commandlinefrontend.h"
 
 #include "application.h"
+#include "changewatcher.h"
 #include "consoleprogressobserver.h"
 #include "status.h"
 #include "parser/commandlineoption.h"
@@ -68,6 +69,7 @@ CommandLineFrontend::CommandLineFrontend(const CommandLineParser &parser, Settin
     : QObject(parent)
     , m_parser(parser)
     , m_settings(settings)
+    , m_changeWatcher(nullptr)
     , m_observer(nullptr)
     , m_cancelStatus(CancelStatusNone)
     , m_cancelTimer(new QTimer(this))
@@ -176,10 +178,7 @@ void CommandLineFrontend::start()
             params.setConfigurationName(configurationName);
             params.setBuildRoot(buildDirectory(profileName));
             params.setOverriddenValues(userConfig);
-            SetupProjectJob * const job = Project().setupProject(params,
-                    ConsoleLogger::instance().logSink(), this);
-            connectJob(job);
-            m_resolveJobs.push_back(job);
+            setupProject(Project(), params);
         }
 
         /*
@@ -210,6 +209,16 @@ void CommandLineFrontend::start()
     }
 }
 
+void CommandLineFrontend::setupProject(const Project &existingProject,
+                                       const SetupProjectParameters &parameters)
+{
+    SetupProjectJob * const job = Project(existingProject).setupProject(parameters,
+            ConsoleLogger::instance().logSink(), this);
+    connectJob(job);
+    m_resolveJobs.push_back(job);
+    m_setupJobs.insert(job, std::make_pair(existingProject, parameters));
+}
+
 void CommandLineFrontend::handleCommandDescriptionReport(const QString &highlight,
                                                          const QString &message)
 {
@@ -220,18 +229,32 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
 {
     try {
         job->deleteLater();
+        const auto setup = m_setupJobs.take(job);
         if (!success) {
             qbsError() << job->error().toString();
             m_resolveJobs.removeOne(job);
             m_buildJobs.removeOne(job);
+
+            // When watching, a project that failed to re-resolve keeps its old state, so that
+            // its files are still watched.
+            if (canWatch() && setup.first.isValid()) {
+                m_projects.push_back(setup.first);
+                m_setupParameters.insert(setup.first, setup.second);
+            }
             if (m_resolveJobs.empty() && m_buildJobs.empty()) {
+                if (canWatch() && !m_projects.empty()) {
+                    watchForChanges();
+                    return;
+                }
                 qApp->exit(EXIT_FAILURE);
                 return;
             }
-            cancel();
+            if (!canWatch())
+                cancel();
         } else if (SetupProjectJob * const setupJob = qobject_cast<SetupProjectJob *>(job)) {
             m_resolveJobs.removeOne(job);
             m_projects.push_back(setupJob->project());
+            m_setupParameters.insert(setupJob->project(), setup.second);
             if (m_observer && resolvingMultipleProjects())
                 m_observer->incrementProgressValue();
             if (m_resolveJobs.empty())
@@ -254,7 +277,10 @@ void CommandLineFrontend::handleJobFinished(bool success, AbstractJob *job)
                     // fall through
                 case BuildCommandType:
                 case CleanCommandType:
-                    qApp->quit();
+                    if (canWatch())
+                        watchForChanges();
+                    else
+                        qApp->quit();
                     break;
                 default:
                     Q_ASSERT_X(false, Q_FUNC_INFO, "Missing case in switch statement");
@@ -336,6 +362,11 @@ bool CommandLineFrontend::isBuilding() const
     return !m_buildJobs.empty();
 }
 
+bool CommandLineFrontend::canWatch() const
+{
+    return m_parser.watch() && m_cancelStatus == CancelStatusNone;
+}
+
 CommandLineFrontend::ProductMap CommandLineFrontend::productsToUse() const
 {
     ProductMap products;
@@ -449,6 +480,11 @@ int CommandLineFrontend::runShell()
 BuildOptions CommandLineFrontend::buildOptions(const Project &project) const
 {
     BuildOptions options = m_parser.buildOptions(m_projects.front().profile());
+    if (!m_changedFiles.empty()) {
+        // The change watcher also watches the file dependencies found by the scanners.
+        options.setChangedFiles(m_changedFiles);
+        options.setChangedFilesIncludeFileDependencies(true);
+    }
     if (options.maxJobCount() <= 0) {
         const QString profileName = project.profile();
         QBS_CHECK(!profileName.isEmpty());
@@ -502,6 +538,7 @@ void CommandLineFrontend::build()
      * efforts, we can start the overall progress report.
      */
     m_buildEffortsNeeded = m_buildJobs.size();
+    m_buildEfforts.clear();
     m_buildEffortsRetrieved = 0;
     m_totalBuildEffort = 0;
     m_currentBuildEffort = 0;
@@ -658,6 +695,82 @@ ProductData CommandLineFrontend::getTheOneRunnableProduct()
     throw error;
 }
 
+void CommandLineFrontend::watchForChanges()
+{
+    if (!m_changeWatcher) {
+        m_changeWatcher = new ChangeWatcher(this);
+        connect(m_changeWatcher, &ChangeWatcher::changesDetected,
+                this, &CommandLineFrontend::handleChangesDetected);
+    }
+
+    QSet<QString> files;
+    QSet<QString> buildSystemFiles;
+    QSet<QString> directories;
+    QStringList buildDirectories;
+    for (const Project &project : qAsConst(m_projects)) {
+        const ProjectData projectData = project.projectData();
+        buildDirectories << projectData.buildDirectory();
+        const auto products = projectData.allProducts();
+        for (const ProductData &product : products) {
+            const auto groups = product.groups();
+            for (const GroupData &group : groups) {
+                const auto filePaths = group.allFilePaths();
+                for (const QString &filePath : filePaths) {
+                    files.insert(filePath);
+                    directories.insert(QFileInfo(filePath).path());
+                }
+            }
+        }
+        for (const QString &filePath : project.buildSystemFiles()) {
+            buildSystemFiles.insert(filePath);
+            directories.insert(QFileInfo(filePath).path());
+        }
+        for (const QString &filePath : project.fileDependencies())
+            files.insert(filePath);
+    }
+    m_changeWatcher->watch(files, buildSystemFiles, directories, buildDirectories);
+    m_changedFiles.clear();
+    const QStringList unwatchedPaths = m_changeWatcher->unwatchedPaths();
+    if (!unwatchedPaths.empty()) {
+        qbsWarning() << Tr::tr("Cannot watch %1 path(s) for changes, for instance '%2'. "
+                               "Changes to these paths are not detected, and all timestamps "
+                               "are checked when building.").arg(unwatchedPaths.size())
+                        .arg(QDir::toNativeSeparators(unwatchedPaths.first()));
+    }
+
+    if (m_changeWatcher->hasChanges())
+        handleChangesDetected();
+    else
+        qbsInfo() << Tr::tr("Watching for changes...");
+}
+
+void CommandLineFrontend::handleChangesDetected()
+{
+    // Changes that come in while we are busy are picked up in watchForChanges().
+    if (isResolving() || isBuilding())
+        return;
+    try {
+        const bool projectChanged = m_changeWatcher->projectChanged();
+        const QStringList changedFiles = m_changeWatcher->takeChangedFiles();
+        if (projectChanged) {
+            qbsInfo() << Tr::tr("Project files changed, setting up projects again.");
+            const QHash<Project, SetupProjectParameters> setupParameters = m_setupParameters;
+            m_projects.clear();
+            m_setupParameters.clear();
+            for (auto it = setupParameters.cbegin(); it != setupParameters.cend(); ++it)
+                setupProject(it.key(), it.value());
+        } else {
+            // If some file could not be watched, we cannot rely on the list of changed files.
+            if (m_changeWatcher->watchesAllPaths())
+                m_changedFiles = changedFiles;
+            build();
+        }
+    } catch (const ErrorInfo &error) {
+        qbsError() << error.toString();
+        qApp->exit(EXIT_FAILURE);
+    }
+}
+
 void CommandLineFrontend::install()
 {
     Q_ASSERT(m_projects.size() == 1);
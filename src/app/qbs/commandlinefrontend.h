@@ -42,12 +42,14 @@
 #include "parser/commandlineparser.h"
 #include <api/project.h>
 #include <api/projectdata.h>
+#include <tools/setupprojectparameters.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qobject.h>
 
 #include <memory>
+#include <utility>
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -55,6 +57,7 @@ QT_END_NAMESPACE
 
 namespace qbs {
 class AbstractJob;
+class ChangeWatcher;
 class ConsoleProgressObserver;
 class ErrorInfo;
 class ProcessResult;
@@ -79,6 +82,7 @@ private:
     void handleTotalEffortChanged(int totalEffort);
     void handleTaskProgress(int value, qbs::AbstractJob *job);
     void handleProcessResultReport(const qbs::ProcessResult &result);
+    void handleChangesDetected();
     void checkCancelStatus();
 
     typedef QHash<Project, QList<ProductData> > ProductMap;
@@ -87,6 +91,8 @@ private:
     bool resolvingMultipleProjects() const;
     bool isResolving() const;
     bool isBuilding() const;
+    bool canWatch() const;
+    void setupProject(const Project &existingProject, const SetupProjectParameters &parameters);
     void handleProjectsResolved();
     void makeClean();
     int runShell();
@@ -102,6 +108,7 @@ private:
     void connectJob(AbstractJob *job);
     ProductData getTheOneRunnableProduct();
     void install();
+    void watchForChanges();
     BuildOptions buildOptions(const Project &project) const;
     QString buildDirectory(const QString &profileName) const;
 
@@ -110,6 +117,10 @@ private:
     QList<AbstractJob *> m_resolveJobs;
     QList<AbstractJob *> m_buildJobs;
     QList<Project> m_projects;
+    QHash<AbstractJob *, std::pair<Project, SetupProjectParameters>> m_setupJobs;
+    QHash<Project, SetupProjectParameters> m_setupParameters;
+    ChangeWatcher *m_changeWatcher;
+    QStringList m_changedFiles;
 
     ConsoleProgressObserver *m_observer;
 
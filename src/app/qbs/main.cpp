@@ -44,6 +44,7 @@
 #include "../shared/logging/consolelogger.h"
 
 #include <qbs.h>
+#include <tools/profiling.h>
 
 #include <QtCore/qtimer.h>
 #include <cstdlib>
@@ -87,8 +88,20 @@ int main(int argc, char *argv[])
         ConsoleLogger::instance().setSettings(&settings);
         CommandLineFrontend clFrontend(parser, &settings);
         app.setCommandLineFrontend(&clFrontend);
+        const QString traceFilePath = parser.traceFilePath();
+        if (!traceFilePath.isEmpty())
+            Internal::TraceRecorder::instance().start();
         QTimer::singleShot(0, &clFrontend, &CommandLineFrontend::start);
-        return app.exec();
+        const int exitCode = app.exec();
+        if (!traceFilePath.isEmpty()) {
+            // The trace is a diagnostic aid, so failing to write it does not fail the command.
+            try {
+                Internal::TraceRecorder::instance().writeToFile(traceFilePath);
+            } catch (const ErrorInfo &error) {
+                qbsWarning() << error.toString();
+            }
+        }
+        return exitCode;
     } catch (const ErrorInfo &error) {
         qbsError() << error.toString();
         return EXIT_FAILURE;
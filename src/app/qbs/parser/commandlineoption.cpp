@@ -239,6 +239,37 @@ void JobsOption::doParse(const QString &representation, QStringList &input)
                     .arg(representation, jobCountString, description(command())));
 }
 
+QString JobLimitsOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <pool>:<n>[,<pool>:<n>...]\n"
+                  "\tRun at most <n> commands from the respective job pool concurrently.\n"
+                  "\tCommands are assigned to pools via their jobPool property.\n")
+            .arg(longRepresentation());
+}
+
+QString JobLimitsOption::longRepresentation() const
+{
+    return QLatin1String("--job-limits");
+}
+
+void JobLimitsOption::doParse(const QString &representation, QStringList &input)
+{
+    m_jobLimits.clear();
+    const QStringList entries = getArgument(representation, input).split(QLatin1Char(','));
+    for (const QString &entry : entries) {
+        const int separatorPos = entry.lastIndexOf(QLatin1Char(':'));
+        bool stringOk = false;
+        const int limit = entry.mid(separatorPos + 1).toInt(&stringOk);
+        if (separatorPos <= 0 || !stringOk || limit <= 0) {
+            throw ErrorInfo(Tr::tr("Invalid use of option '%1': Illegal job limit '%2'.\n"
+                                   "Usage: %3")
+                            .arg(representation, entry, description(command())));
+        }
+        m_jobLimits.insert(entry.left(separatorPos), limit);
+    }
+}
+
 QString KeepGoingOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -449,6 +480,20 @@ QString ForceOutputCheckOption::longRepresentation() const
     return QLatin1String("--check-outputs");
 }
 
+QString UseContentHashesOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n\tUse file contents for up-to-date checks.\n"
+                  "\tIf an artifact appears out of date according to its timestamp, but\n"
+                  "\tthe contents of its inputs are the same as when it was last built,\n"
+                  "\tthe command creating it is not run again.\n").arg(longRepresentation());
+}
+
+QString UseContentHashesOption::longRepresentation() const
+{
+    return QLatin1String("--use-content-hashes");
+}
+
 QString BuildNonDefaultOption::description(CommandType command) const
 {
     Q_UNUSED(command);
@@ -640,4 +685,42 @@ QString RunEnvConfigOption::longRepresentation() const
     return QLatin1String("--setup-run-env-config");
 }
 
+QString WatchOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1\n"
+                  "\tKeep running after the build and build again whenever files change.\n"
+                  "\tThe project stays loaded, and only files reported as changed by the\n"
+                  "\tfile system are checked for being out of date.\n")
+            .arg(longRepresentation());
+}
+
+QString WatchOption::longRepresentation() const
+{
+    return QLatin1String("--watch");
+}
+
+QString TraceFileOption::description(CommandType command) const
+{
+    Q_UNUSED(command);
+    return Tr::tr("%1 <file>\n"
+                  "\tRecord the timing of jobs, rules, scanners, probes and other activities\n"
+                  "\tand write it to the given file in the Chrome trace event format.\n")
+            .arg(longRepresentation());
+}
+
+QString TraceFileOption::longRepresentation() const
+{
+    return QLatin1String("--trace-file");
+}
+
+void TraceFileOption::doParse(const QString &representation, QStringList &input)
+{
+    if (input.empty()) {
+        throw ErrorInfo(Tr::tr("Invalid use of option '%1': Argument expected.\n"
+                           "Usage: %2").arg(representation, description(command())));
+    }
+    m_traceFilePath = input.takeFirst();
+}
+
 } // namespace qbs
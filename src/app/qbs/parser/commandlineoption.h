@@ -43,6 +43,7 @@
 
 #include <tools/commandechomode.h>
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
 
 namespace qbs {
@@ -55,6 +56,7 @@ public:
         BuildDirectoryOptionType,
         LogLevelOptionType, VerboseOptionType, QuietOptionType,
         JobsOptionType,
+        JobLimitsOptionType,
         KeepGoingOptionType,
         DryRunOptionType,
         ForceProbesOptionType,
@@ -65,6 +67,7 @@ public:
         InstallRootOptionType, RemoveFirstOptionType, NoBuildOptionType,
         ForceTimestampCheckOptionType,
         ForceOutputCheckOptionType,
+        UseContentHashesOptionType,
         BuildNonDefaultOptionType,
         LogTimeOptionType,
         CommandEchoModeOptionType,
@@ -72,6 +75,8 @@ public:
         GeneratorOptionType,
         WaitLockOptionType,
         RunEnvConfigOptionType,
+        WatchOptionType,
+        TraceFileOptionType,
     };
 
     virtual ~CommandLineOption();
@@ -184,6 +189,20 @@ private:
     int m_jobCount;
 };
 
+class JobLimitsOption : public CommandLineOption
+{
+public:
+    QHash<QString, int> jobLimits() const { return m_jobLimits; }
+
+private:
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return QString(); }
+    QString longRepresentation() const override;
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QHash<QString, int> m_jobLimits;
+};
+
 class OnOffOption : public CommandLineOption
 {
 public:
@@ -248,6 +267,13 @@ class ForceOutputCheckOption : public OnOffOption
     QString longRepresentation() const override;
 };
 
+class UseContentHashesOption : public OnOffOption
+{
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return QString(); }
+    QString longRepresentation() const override;
+};
+
 class BuildNonDefaultOption : public OnOffOption
 {
     QString description(CommandType command) const override;
@@ -388,6 +414,28 @@ public:
     QString longRepresentation() const override;
 };
 
+class WatchOption : public OnOffOption
+{
+public:
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return QString(); }
+    QString longRepresentation() const override;
+};
+
+class TraceFileOption : public CommandLineOption
+{
+public:
+    QString traceFilePath() const { return m_traceFilePath; }
+
+private:
+    QString description(CommandType command) const override;
+    QString shortRepresentation() const override { return QString(); }
+    QString longRepresentation() const override;
+    void doParse(const QString &representation, QStringList &input) override;
+
+    QString m_traceFilePath;
+};
+
 } // namespace qbs
 
 #endif // QBS_COMMANDLINEOPTION_H
@@ -104,6 +104,9 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::ForceOutputCheckOptionType:
             option = new ForceOutputCheckOption;
             break;
+        case CommandLineOption::UseContentHashesOptionType:
+            option = new UseContentHashesOption;
+            break;
         case CommandLineOption::BuildNonDefaultOptionType:
             option = new BuildNonDefaultOption;
             break;
@@ -122,6 +125,15 @@ CommandLineOption *CommandLineOptionPool::getOption(CommandLineOption::Type type
         case CommandLineOption::WaitLockOptionType:
             option = new WaitLockOption;
             break;
+        case CommandLineOption::JobLimitsOptionType:
+            option = new JobLimitsOption;
+            break;
+        case CommandLineOption::WatchOptionType:
+            option = new WatchOption;
+            break;
+        case CommandLineOption::TraceFileOptionType:
+            option = new TraceFileOption;
+            break;
         case CommandLineOption::RunEnvConfigOptionType:
             option = new RunEnvConfigOption;
             break;
@@ -187,6 +199,11 @@ JobsOption *CommandLineOptionPool::jobsOption() const
     return static_cast<JobsOption *>(getOption(CommandLineOption::JobsOptionType));
 }
 
+JobLimitsOption *CommandLineOptionPool::jobLimitsOption() const
+{
+    return static_cast<JobLimitsOption *>(getOption(CommandLineOption::JobLimitsOptionType));
+}
+
 ProductsOption *CommandLineOptionPool::productsOption() const
 {
     return static_cast<ProductsOption *>(getOption(CommandLineOption::ProductsOptionType));
@@ -224,6 +241,12 @@ ForceOutputCheckOption *CommandLineOptionPool::forceOutputCheckOption() const
                 getOption(CommandLineOption::ForceOutputCheckOptionType));
 }
 
+UseContentHashesOption *CommandLineOptionPool::useContentHashesOption() const
+{
+    return static_cast<UseContentHashesOption *>(
+                getOption(CommandLineOption::UseContentHashesOptionType));
+}
+
 BuildNonDefaultOption *CommandLineOptionPool::buildNonDefaultOption() const
 {
     return static_cast<BuildNonDefaultOption *>(
@@ -261,4 +284,14 @@ RunEnvConfigOption *CommandLineOptionPool::runEnvConfigOption() const
     return static_cast<RunEnvConfigOption *>(getOption(CommandLineOption::RunEnvConfigOptionType));
 }
 
+WatchOption *CommandLineOptionPool::watchOption() const
+{
+    return static_cast<WatchOption *>(getOption(CommandLineOption::WatchOptionType));
+}
+
+TraceFileOption *CommandLineOptionPool::traceFileOption() const
+{
+    return static_cast<TraceFileOption *>(getOption(CommandLineOption::TraceFileOptionType));
+}
+
 } // namespace qbs
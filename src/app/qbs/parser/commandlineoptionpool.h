@@ -62,6 +62,7 @@ public:
     ChangedFilesOption *changedFilesOption() const;
     KeepGoingOption *keepGoingOption() const;
     JobsOption *jobsOption() const;
+    JobLimitsOption *jobLimitsOption() const;
     ProductsOption *productsOption() const;
     NoInstallOption *noInstallOption() const;
     InstallRootOption *installRootOption() const;
@@ -69,6 +70,7 @@ public:
     NoBuildOption *noBuildOption() const;
     ForceTimeStampCheckOption *forceTimestampCheckOption() const;
     ForceOutputCheckOption *forceOutputCheckOption() const;
+    UseContentHashesOption *useContentHashesOption() const;
     BuildNonDefaultOption *buildNonDefaultOption() const;
     LogTimeOption *logTimeOption() const;
     CommandEchoModeOption *commandEchoModeOption() const;
@@ -76,6 +78,8 @@ public:
     GeneratorOption *generatorOption() const;
     WaitLockOption *waitLockOption() const;
     RunEnvConfigOption *runEnvConfigOption() const;
+    WatchOption *watchOption() const;
+    TraceFileOption *traceFileOption() const;
 
 private:
     mutable QHash<CommandLineOption::Type, CommandLineOption *> m_options;
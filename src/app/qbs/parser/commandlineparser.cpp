@@ -170,6 +170,18 @@ BuildOptions CommandLineParser::buildOptions(const QString &profile) const
         d->buildOptions.setEchoMode(preferences.defaultEchoMode());
     }
 
+    if (d->buildOptions.artifactCacheDirectory().isEmpty())
+        d->buildOptions.setArtifactCacheDirectory(preferences.artifactCacheDirectory());
+    d->buildOptions.setArtifactCacheRelocatable(preferences.artifactCacheIsRelocatable());
+
+    // Limits given on the command line take precedence over the ones from the preferences.
+    QHash<QString, int> jobLimits = preferences.jobLimits();
+    const QHash<QString, int> jobLimitsFromCommandLine
+            = d->optionPool.jobLimitsOption()->jobLimits();
+    for (auto it = jobLimitsFromCommandLine.cbegin(); it != jobLimitsFromCommandLine.cend(); ++it)
+        jobLimits.insert(it.key(), it.value());
+    d->buildOptions.setJobLimits(jobLimits);
+
     return d->buildOptions;
 }
 
@@ -231,6 +243,16 @@ bool CommandLineParser::waitLockBuildGraph() const
     return d->optionPool.waitLockOption()->enabled();
 }
 
+bool CommandLineParser::watch() const
+{
+    return d->optionPool.watchOption()->enabled();
+}
+
+QString CommandLineParser::traceFilePath() const
+{
+    return d->optionPool.traceFileOption()->traceFilePath();
+}
+
 bool CommandLineParser::logTime() const
 {
     return d->logTime;
@@ -456,6 +478,7 @@ void CommandLineParser::CommandLineParserPrivate::setupBuildOptions()
     buildOptions.setKeepGoing(optionPool.keepGoingOption()->enabled());
     buildOptions.setForceTimestampCheck(optionPool.forceTimestampCheckOption()->enabled());
     buildOptions.setForceOutputCheck(optionPool.forceOutputCheckOption()->enabled());
+    buildOptions.setUseContentHashes(optionPool.useContentHashesOption()->enabled());
     const JobsOption * jobsOption = optionPool.jobsOption();
     buildOptions.setMaxJobCount(jobsOption->jobCount());
     buildOptions.setLogElapsedTime(logTime);
@@ -76,6 +76,8 @@ public:
     bool dryRun() const;
     bool forceProbesExecution() const;
     bool waitLockBuildGraph() const;
+    bool watch() const;
+    QString traceFilePath() const;
     bool logTime() const;
     bool withNonDefaultProducts() const;
     bool buildBeforeInstalling() const;
@@ -282,8 +282,10 @@ static QList<CommandLineOption::Type> buildOptions()
             << CommandLineOption::ChangedFilesOptionType
             << CommandLineOption::ForceTimestampCheckOptionType
             << CommandLineOption::ForceOutputCheckOptionType
+            << CommandLineOption::UseContentHashesOptionType
             << CommandLineOption::BuildNonDefaultOptionType
             << CommandLineOption::JobsOptionType
+            << CommandLineOption::JobLimitsOptionType
             << CommandLineOption::CommandEchoModeOptionType
             << CommandLineOption::NoInstallOptionType
             << CommandLineOption::RemoveFirstOptionType
@@ -292,7 +294,8 @@ static QList<CommandLineOption::Type> buildOptions()
 
 QList<CommandLineOption::Type> BuildCommand::supportedOptions() const
 {
-    return buildOptions();
+    return buildOptions() << CommandLineOption::WatchOptionType
+                          << CommandLineOption::TraceFileOptionType;
 }
 
 QString CleanCommand::shortDescription() const
@@ -4,6 +4,7 @@ include(parser/parser.pri)
 TARGET = qbs
 
 SOURCES += main.cpp \
+    changewatcher.cpp \
     ctrlchandler.cpp \
     application.cpp \
     status.cpp \
@@ -12,6 +13,7 @@ SOURCES += main.cpp \
     qbstool.cpp
 
 HEADERS += \
+    changewatcher.h \
     ctrlchandler.h \
     application.h \
     status.h \
@@ -726,7 +726,7 @@ RuleCommandList ProjectPrivate::ruleCommands(const ProductData &product,
         for (const Artifact * const inputArtifact : qAsConst(transformer->inputs)) {
             if (inputArtifact->filePath() == inputFilePath) {
                 RuleCommandList list;
-                for (const AbstractCommandPtr &internalCommand : qAsConst(transformer->commands)) {
+                for (const AbstractCommandPtr &internalCommand : transformer->commands()) {
                     RuleCommand externalCommand;
                     externalCommand.d->description = internalCommand->description();
                     externalCommand.d->extendedDescription = internalCommand->extendedDescription();
@@ -1111,6 +1111,26 @@ std::set<QString> Project::buildSystemFiles() const
     return d->internalProject->buildSystemFiles.toStdSet();
 }
 
+/*!
+ * \brief Returns the files that are not part of the project, but that artifacts depend on.
+ * Typically, these are headers found by a dependency scanner. The list is only complete
+ * after the project has been built.
+ */
+std::set<QString> Project::fileDependencies() const
+{
+    QBS_ASSERT(isValid(), return std::set<QString>());
+    std::set<QString> filePaths;
+    for (const ResolvedProductPtr &product : d->internalProject->allProducts()) {
+        if (!product->buildData)
+            continue;
+        for (const Artifact * const artifact : filterByType<Artifact>(product->buildData->nodes)) {
+            for (const FileDependency * const fileDependency : artifact->fileDependencies)
+                filePaths.insert(fileDependency->filePath());
+        }
+    }
+    return filePaths;
+}
+
 RuleCommandList Project::ruleCommands(const ProductData &product,
         const QString &inputFilePath, const QString &outputFileTag, ErrorInfo *error) const
 {
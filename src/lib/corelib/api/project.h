@@ -133,6 +133,7 @@ public:
     QVariantMap projectConfiguration() const;
 
     std::set<QString> buildSystemFiles() const;
+    std::set<QString> fileDependencies() const;
 
     RuleCommandList ruleCommands(const ProductData &product, const QString &inputFilePath,
                                  const QString &outputFileTag, ErrorInfo *error = 0) const;
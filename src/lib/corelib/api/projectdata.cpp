@@ -803,7 +803,8 @@ bool operator<(const ProjectData &lhs, const ProjectData &rhs)
 PropertyMap::PropertyMap()
     : d(new Internal::PropertyMapPrivate)
 {
-    static Internal::PropertyMapPtr defaultInternalMap = Internal::PropertyMapInternal::create();
+    static Internal::PropertyMapPtr defaultInternalMap
+            = Internal::PropertyMapInternal::create(QVariantMap());
     d->m_map = defaultInternalMap;
 }
 
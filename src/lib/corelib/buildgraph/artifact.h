@@ -87,6 +87,10 @@ public:
     PropertyMapPtr properties;
     QString targetOfModule;
 
+    // Combined hash of the commands and input contents this artifact was last built from.
+    // Only maintained if content hashes are used for up-to-date checks.
+    QByteArray inputsHash;
+
     enum ArtifactType
     {
         Unknown = 1,
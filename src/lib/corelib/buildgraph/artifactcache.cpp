@@ -0,0 +1,360 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "artifactcache.h"
+
+#include "artifact.h"
+#include "rulecommands.h"
+#include "transformer.h"
+
+#include <language/language.h>
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/fileinfo.h>
+#include <tools/processresult.h>
+#include <tools/processresult_p.h>
+#include <tools/qttools.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qtemporarydir.h>
+
+#include <algorithm>
+#include <map>
+
+namespace qbs {
+namespace Internal {
+
+// Increase this whenever the key computation or the layout of the cache entries changes.
+static const int cacheFormatVersion = 2;
+
+static QString processOutputFileName() { return QStringLiteral("process-output"); }
+
+namespace {
+class InsertionRunnable : public QRunnable
+{
+public:
+    InsertionRunnable(const std::function<void()> &insert) : m_insert(insert) {}
+
+private:
+    void run() override { m_insert(); }
+
+    const std::function<void()> m_insert;
+};
+} // namespace
+
+ArtifactCache::ArtifactCache(const QString &cacheDir, bool relocatable,
+                             const TopLevelProject *project, const Logger &logger)
+    : m_cacheDir(QDir::cleanPath(cacheDir)), m_logger(logger)
+{
+    if (!relocatable)
+        return;
+
+    const QString buildDir = project->buildDirectory;
+    const QString sourceDir = FileInfo::path(project->location.filePath());
+    if (!buildDir.isEmpty())
+        m_pathReplacements.push_back(std::make_pair(buildDir, QStringLiteral("<build-dir>")));
+    if (!sourceDir.isEmpty())
+        m_pathReplacements.push_back(std::make_pair(sourceDir, QStringLiteral("<source-dir>")));
+
+    // The build directory is often located inside the source directory,
+    // so the longer path has to be replaced first.
+    std::sort(m_pathReplacements.begin(), m_pathReplacements.end(),
+              [](const std::pair<QString, QString> &p1, const std::pair<QString, QString> &p2) {
+        return p1.first.size() > p2.first.size();
+    });
+}
+
+ArtifactCache::~ArtifactCache()
+{
+    m_insertionPool.waitForDone();
+}
+
+bool ArtifactCache::isCacheable(const Transformer *transformer)
+{
+    if (transformer->alwaysRun || transformer->commands().empty())
+        return false;
+
+    // JavaScript commands can have side effects beyond writing their outputs and can make use
+    // of files that we do not know about, so we only cache the results of external processes.
+    return std::all_of(transformer->commands().cbegin(), transformer->commands().cend(),
+                       [](const AbstractCommandPtr &cmd) {
+        return cmd->type() == AbstractCommand::ProcessCommandType;
+    });
+}
+
+QByteArray ArtifactCache::key(const Transformer *transformer,
+                              const ContentHashFunction &contentHash) const
+{
+    const FingerprintStringFilter filter = [this](const QString &str) {
+        return normalizedPath(str);
+    };
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << cacheFormatVersion << commandListHash(transformer->commands(), filter);
+
+    const ResolvedProductPtr product = transformer->product();
+    for (const AbstractCommandPtr &cmd : transformer->commands()) {
+        const auto processCommand = static_cast<const ProcessCommand *>(cmd.get());
+
+        // Catches updates of the tool itself, as far as possible without hashing its contents.
+        if (FileInfo::isAbsolute(processCommand->program()))
+            stream << FileInfo(processCommand->program()).lastModified().asDouble();
+
+        for (const QString &varName : processCommand->relevantEnvVars()) {
+            stream << varName
+                   << filter(processCommand->environment().value(varName,
+                                product->buildEnvironment.value(varName)));
+        }
+    }
+
+    const auto addProperties = [&stream, &filter](const PropertySet &properties) {
+        stream << int(properties.size());
+        for (const Property &property : properties) {
+            stream << property.moduleName << property.propertyName << int(property.kind)
+                   << filteredForFingerprint(property.value, filter);
+        }
+    };
+    addProperties(transformer->propertiesRequestedInPrepareScript);
+    QStringList artifactKeys = transformer->propertiesRequestedFromArtifactInPrepareScript.keys();
+    artifactKeys.sort();
+    for (const QString &artifactKey : qAsConst(artifactKeys)) {
+        stream << filter(artifactKey);
+        addProperties(transformer->propertiesRequestedFromArtifactInPrepareScript
+                      .value(artifactKey));
+    }
+
+    std::map<QString, QByteArray> inputHashes;
+    const auto addInput = [this, &inputHashes, &contentHash](FileResourceBase *input) {
+        const QByteArray hash = contentHash(input);
+        if (hash.isEmpty()) {
+            qCDebug(lcExec) << "artifact cache: cannot get content hash of" << input->filePath();
+            return false;
+        }
+        inputHashes[normalizedPath(input->filePath())] = hash;
+        return true;
+    };
+    for (Artifact * const output : sortedOutputs(transformer)) {
+        stream << normalizedPath(output->filePath());
+        for (Artifact * const child : filterByType<Artifact>(output->children)) {
+            if (!addInput(child))
+                return QByteArray();
+        }
+        for (FileDependency * const fileDependency : qAsConst(output->fileDependencies)) {
+            if (!addInput(fileDependency))
+                return QByteArray();
+        }
+    }
+    for (const auto &input : inputHashes)
+        stream << input.first << input.second;
+
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+bool ArtifactCache::restore(const QByteArray &key, const Transformer *transformer,
+                            std::vector<ProcessResult> &processResults) const
+{
+    const QString entryDir = entryDirPath(key);
+    if (!FileInfo::exists(entryDir))
+        return false;
+
+    QFile processOutputFile(entryDir + QLatin1Char('/') + processOutputFileName());
+    if (!processOutputFile.open(QIODevice::ReadOnly)
+            || !deserializeProcessResults(processOutputFile.readAll(), processResults)) {
+        qCDebug(lcExec) << "artifact cache: cannot read process output of entry" << entryDir;
+        return false;
+    }
+
+    // The outputs are copied rather than hard-linked, because some tools modify
+    // existing output files in place, which would corrupt the cache entry.
+    // Where the file system supports it, the copy is a cheap reflink.
+    const std::vector<Artifact *> outputs = sortedOutputs(transformer);
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const QString cachedFilePath = entryDir + QLatin1Char('/') + QString::number(i);
+        const QString filePath = outputs.at(i)->filePath();
+        if (FileInfo::exists(filePath) && !QFile::remove(filePath)) {
+            qCDebug(lcExec) << "artifact cache: cannot remove" << filePath;
+            return false;
+        }
+        QString errorMessage;
+        if (!copyFileRecursion(cachedFilePath, filePath, false, false, &errorMessage)) {
+            qCDebug(lcExec) << "artifact cache: cannot copy" << cachedFilePath << "to"
+                            << filePath << errorMessage;
+            return false;
+        }
+    }
+    return true;
+}
+
+static void storeEntry(const std::vector<std::pair<QString, FileTime>> &outputs,
+                       const QByteArray &processOutput, const QString &tmpBaseDir,
+                       const QString &entryDir)
+{
+    if (FileInfo::exists(entryDir))
+        return;
+
+    // Entries are assembled in a temporary directory and then moved into place in one step,
+    // so concurrent builds sharing the cache never see incomplete entries.
+    QTemporaryDir tmpDir(tmpBaseDir + QLatin1String("/entry-XXXXXX"));
+    if (!tmpDir.isValid())
+        return;
+    QFile processOutputFile(tmpDir.path() + QLatin1Char('/') + processOutputFileName());
+    if (!processOutputFile.open(QIODevice::WriteOnly)
+            || processOutputFile.write(processOutput) != processOutput.size()) {
+        qCDebug(lcExec) << "artifact cache: cannot store process output"
+                        << processOutputFile.errorString();
+        return;
+    }
+    processOutputFile.close();
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        const QString &filePath = outputs.at(i).first;
+        QString errorMessage;
+        if (!copyFileRecursion(filePath, tmpDir.path() + QLatin1Char('/') + QString::number(i),
+                               false, false, &errorMessage)) {
+            qCDebug(lcExec) << "artifact cache: cannot store" << filePath << errorMessage;
+            return;
+        }
+
+        // The output must not have been changed while we were copying it.
+        if (FileInfo(filePath).lastModified() != outputs.at(i).second) {
+            qCDebug(lcExec) << "artifact cache: output changed during insertion" << filePath;
+            return;
+        }
+    }
+
+    // If the rename fails, another build was probably faster. The temporary directory
+    // gets removed either way.
+    if (!QDir::root().rename(tmpDir.path(), entryDir))
+        qCDebug(lcExec) << "artifact cache: cannot create entry" << entryDir;
+}
+
+void ArtifactCache::insert(const QByteArray &key, const Transformer *transformer,
+                           const std::vector<ProcessResult> &processResults)
+{
+    const QString entryDir = entryDirPath(key);
+    if (FileInfo::exists(entryDir))
+        return;
+
+    const QString tmpBaseDir = m_cacheDir + QLatin1String("/tmp");
+    if (!QDir::root().mkpath(tmpBaseDir) || !QDir::root().mkpath(FileInfo::path(entryDir))) {
+        m_logger.qbsWarning() << Tr::tr("Cannot create directory in artifact cache '%1'.")
+                                 .arg(QDir::toNativeSeparators(m_cacheDir));
+        return;
+    }
+
+    // Only the data gathered here is accessed from the pool thread, as the build graph
+    // is not thread-safe.
+    std::vector<std::pair<QString, FileTime>> outputs;
+    for (const Artifact * const output : sortedOutputs(transformer)) {
+        const QString filePath = output->filePath();
+        outputs.push_back(std::make_pair(filePath, FileInfo(filePath).lastModified()));
+    }
+    const QByteArray processOutput = serializedProcessResults(processResults);
+    m_insertionPool.start(new InsertionRunnable([outputs, processOutput, tmpBaseDir, entryDir] {
+        storeEntry(outputs, processOutput, tmpBaseDir, entryDir);
+    }));
+}
+
+QByteArray ArtifactCache::serializedProcessResults(const std::vector<ProcessResult> &results)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << int(results.size());
+    for (const ProcessResult &result : results) {
+        stream << result.executableFilePath() << result.arguments() << result.workingDirectory()
+               << result.exitCode() << result.stdOut() << result.stdErr();
+    }
+    return data;
+}
+
+bool ArtifactCache::deserializeProcessResults(const QByteArray &data,
+                                              std::vector<ProcessResult> &results)
+{
+    QDataStream stream(data);
+    int count;
+    stream >> count;
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        ProcessResult result;
+        result.d->success = true;
+        result.d->error = QProcess::UnknownError;
+        stream >> result.d->executableFilePath >> result.d->arguments
+               >> result.d->workingDirectory >> result.d->exitCode >> result.d->stdOut
+               >> result.d->stdErr;
+        results.push_back(result);
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+// Only a leading source or build directory is replaced, and only if it is followed by a
+// path separator, so that e.g. "/a/b" does not match "/a/bc".
+QString ArtifactCache::normalizedPath(const QString &path) const
+{
+    for (const auto &replacement : m_pathReplacements) {
+        const QString &dirPath = replacement.first;
+        if (!path.startsWith(dirPath))
+            continue;
+        if (path.size() == dirPath.size() || dirPath.endsWith(QLatin1Char('/'))
+                || path.at(dirPath.size()) == QLatin1Char('/')) {
+            return replacement.second + path.mid(dirPath.size());
+        }
+    }
+    return path;
+}
+
+std::vector<Artifact *> ArtifactCache::sortedOutputs(const Transformer *transformer) const
+{
+    std::vector<Artifact *> outputs(transformer->outputs.cbegin(), transformer->outputs.cend());
+    std::sort(outputs.begin(), outputs.end(), [this](const Artifact *a1, const Artifact *a2) {
+        return normalizedPath(a1->filePath()) < normalizedPath(a2->filePath());
+    });
+    return outputs;
+}
+
+QString ArtifactCache::entryDirPath(const QByteArray &key) const
+{
+    const QString hexKey = QString::fromLatin1(key.toHex());
+    return m_cacheDir + QLatin1Char('/') + hexKey.left(2) + QLatin1Char('/') + hexKey.mid(2);
+}
+
+} // namespace Internal
+} // namespace qbs
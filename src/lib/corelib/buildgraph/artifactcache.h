@@ -0,0 +1,107 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+#ifndef QBS_ARTIFACTCACHE_H
+#define QBS_ARTIFACTCACHE_H
+
+#include "forward_decls.h"
+
+#include <language/forward_decls.h>
+#include <logging/logger.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qthreadpool.h>
+
+#include <functional>
+#include <vector>
+
+namespace qbs {
+class ProcessResult;
+
+namespace Internal {
+class FileResourceBase;
+
+// A directory shared between build directories that stores transformer outputs
+// under a key derived from everything that can influence them.
+// Unless the cache is relocatable, the keys contain the absolute source and build directories,
+// because these paths can end up in the outputs.
+class ArtifactCache
+{
+public:
+    using ContentHashFunction = std::function<QByteArray(FileResourceBase *)>;
+
+    ArtifactCache(const QString &cacheDir, bool relocatable, const TopLevelProject *project,
+                  const Logger &logger);
+    ~ArtifactCache();
+
+    static bool isCacheable(const Transformer *transformer);
+
+    // Returns an empty array if no key can be computed, e.g. because an input is missing.
+    QByteArray key(const Transformer *transformer,
+                   const ContentHashFunction &contentHash) const;
+
+    // The results of the processes that created the outputs are returned as well, so the
+    // output of the tools, e.g. compiler warnings, can be shown again.
+    bool restore(const QByteArray &key, const Transformer *transformer,
+                 std::vector<ProcessResult> &processResults) const;
+
+    // The outputs are copied into the cache in the background. The destructor waits for
+    // all pending insertions.
+    void insert(const QByteArray &key, const Transformer *transformer,
+                const std::vector<ProcessResult> &processResults);
+
+private:
+    static QByteArray serializedProcessResults(const std::vector<ProcessResult> &results);
+    static bool deserializeProcessResults(const QByteArray &data,
+                                          std::vector<ProcessResult> &results);
+
+    QString normalizedPath(const QString &path) const;
+    std::vector<Artifact *> sortedOutputs(const Transformer *transformer) const;
+    QString entryDirPath(const QByteArray &key) const;
+
+    const QString m_cacheDir;
+    std::vector<std::pair<QString, QString>> m_pathReplacements;
+    Logger m_logger;
+    QThreadPool m_insertionPool;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_ARTIFACTCACHE_H
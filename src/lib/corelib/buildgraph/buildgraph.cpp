@@ -483,10 +483,9 @@ Artifact *lookupArtifact(const ResolvedProductConstPtr &product,
         const ProjectBuildData *projectBuildData, const QString &dirPath, const QString &fileName,
         bool compareByName)
 {
-    const QList<FileResourceBase *> lookupResults
+    const ProjectBuildData::FileResources lookupResults
             = projectBuildData->lookupFiles(dirPath, fileName);
-    for (QList<FileResourceBase *>::const_iterator it = lookupResults.constBegin();
-            it != lookupResults.constEnd(); ++it) {
+    for (auto it = lookupResults.constBegin(); it != lookupResults.constEnd(); ++it) {
         if ((*it)->fileType() != FileResourceBase::FileTypeArtifact)
             continue;
         Artifact *artifact = static_cast<Artifact *>(*it);
@@ -3,6 +3,7 @@ include(../../../install_prefix.pri)
 SOURCES += \
     $$PWD/abstractcommandexecutor.cpp \
     $$PWD/artifact.cpp \
+    $$PWD/artifactcache.cpp \
     $$PWD/artifactcleaner.cpp \
     $$PWD/artifactvisitor.cpp \
     $$PWD/buildgraph.cpp \
@@ -38,6 +39,7 @@ SOURCES += \
 HEADERS += \
     $$PWD/abstractcommandexecutor.h \
     $$PWD/artifact.h \
+    $$PWD/artifactcache.h \
     $$PWD/artifactcleaner.h \
     $$PWD/artifactvisitor.h \
     $$PWD/buildgraph.h \
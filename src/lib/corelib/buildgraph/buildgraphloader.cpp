@@ -165,6 +165,7 @@ TopLevelProjectConstPtr BuildGraphLoader::loadProject(const QString &bgFilePath)
 
 void BuildGraphLoader::loadBuildGraphFromDisk()
 {
+    const TraceEvent traceEvent("buildgraph", QStringLiteral("Loading build graph"));
     const QString projectId = TopLevelProject::deriveId(m_parameters.finalBuildConfigurationTree());
     const QString buildDir
             = TopLevelProject::deriveBuildDirectory(m_parameters.buildRoot(), projectId);
@@ -201,6 +202,8 @@ void BuildGraphLoader::loadBuildGraphFromDisk()
     project->buildData->evaluationContext = m_evalContext;
     project->setBuildConfiguration(pool.headData().projectConfig);
     project->buildDirectory = buildDir;
+    project->buildData->rawScanResults.setFilePath(
+                RawScanResults::deriveFilePath(buildGraphFilePath));
     if (!checkBuildGraphCompatibility(project))
         return;
     restoreBackPointers(project);
@@ -303,11 +306,17 @@ void BuildGraphLoader::trackProjectChanges()
     Set<QString> buildSystemFiles = restoredProject->buildSystemFiles;
     QList<ResolvedProductPtr> allRestoredProducts = restoredProject->allProducts();
     QList<ResolvedProductPtr> changedProducts;
+    Set<QString> changedBuildSystemFiles;
     bool reResolvingNecessary = false;
+    bool hasGlobalChanges = false;
     if (!checkConfigCompatibility())
-        reResolvingNecessary = true;
+        reResolvingNecessary = hasGlobalChanges = true;
     if (hasProductFileChanged(allRestoredProducts, restoredProject->lastResolveTime,
-                              buildSystemFiles, changedProducts)) {
+                              buildSystemFiles, changedProducts, changedBuildSystemFiles)) {
+        reResolvingNecessary = true;
+    }
+    if (hasBuildSystemFileChanged(buildSystemFiles, restoredProject->lastResolveTime,
+                                  changedBuildSystemFiles)) {
         reResolvingNecessary = true;
     }
 
@@ -316,13 +325,12 @@ void BuildGraphLoader::trackProjectChanges()
     // having been touched. In such a case, the build data for that product will have to be set up
     // anew.
     if (probeExecutionForced(restoredProject, allRestoredProducts)
-            || hasBuildSystemFileChanged(buildSystemFiles, restoredProject->lastResolveTime)
             || hasEnvironmentChanged(restoredProject)
             || hasCanonicalFilePathResultChanged(restoredProject)
             || hasFileExistsResultChanged(restoredProject)
             || hasDirectoryEntriesResultChanged(restoredProject)
             || hasFileLastModifiedResultChanged(restoredProject)) {
-        reResolvingNecessary = true;
+        reResolvingNecessary = hasGlobalChanges = true;
     }
 
     if (!reResolvingNecessary) {
@@ -332,6 +340,7 @@ void BuildGraphLoader::trackProjectChanges()
     }
 
     restoredProject->buildData->isDirty = true;
+
     if (!m_parameters.overrideBuildGraphData())
         m_parameters.setEnvironment(restoredProject->environment);
     Loader ldr(m_evalContext->engine(), m_logger);
@@ -353,8 +362,28 @@ void BuildGraphLoader::trackProjectChanges()
     for (const ResolvedProductPtr &cp : qAsConst(allNewlyResolvedProducts))
         freshProductsByName.insert(cp->uniqueName(), cp);
 
+    // If we know for each changed file which products were resolved from it, the other
+    // products cannot have changed and need not be compared in detail. The newly resolved
+    // products are used for this, because a file that a product no longer uses can only
+    // have dropped out due to a change in a file that the product still uses.
+    if (!hasGlobalChanges) {
+        Set<QString> filesOfAllProducts;
+        for (const ResolvedProductConstPtr &product : qAsConst(allNewlyResolvedProducts))
+            filesOfAllProducts.unite(product->buildSystemFiles);
+        for (const QString &file : qAsConst(changedBuildSystemFiles)) {
+            if (!filesOfAllProducts.contains(file)) {
+                qCDebug(lcBuildGraph) << "Changed file" << file << "is not associated "
+                                         "with a product, all products must be checked";
+                hasGlobalChanges = true;
+                break;
+            }
+        }
+    }
+
     m_envChange = restoredProject->environment != m_result.newlyResolvedProject->environment;
-    checkAllProductsForChanges(allRestoredProducts, freshProductsByName, changedProducts);
+    checkAllProductsForChanges(allRestoredProducts, freshProductsByName,
+                               hasGlobalChanges ? nullptr : &changedBuildSystemFiles,
+                               changedProducts);
 
     std::shared_ptr<ProjectBuildData> oldBuildData;
     ChildListHash childLists;
@@ -383,6 +412,13 @@ void BuildGraphLoader::trackProjectChanges()
         ResolvedProductPtr freshProduct = freshProductsByName.value(product->uniqueName());
         if (!freshProduct)
             continue;
+
+        // Stored commands are looked up via the product of a transformer's outputs,
+        // which are about to be detached from their transformers. The build data of
+        // unchanged products is moved to the new product as a whole, so their commands
+        // can stay serialized.
+        if (product->buildData)
+            product->buildData->loadAllCommands();
         onProductRemoved(product, product->topLevelProject()->buildData.get(), false);
         if (product->buildData) {
             rescuableArtifactData.insert(product->uniqueName(),
@@ -545,7 +581,7 @@ bool BuildGraphLoader::hasFileLastModifiedResultChanged(const TopLevelProjectCon
 
 bool BuildGraphLoader::hasProductFileChanged(const QList<ResolvedProductPtr> &restoredProducts,
         const FileTime &referenceTime, Set<QString> &remainingBuildSystemFiles,
-        QList<ResolvedProductPtr> &changedProducts)
+        QList<ResolvedProductPtr> &changedProducts, Set<QString> &changedBuildSystemFiles)
 {
     bool hasChanged = false;
     for (const ResolvedProductPtr &product : restoredProducts) {
@@ -555,9 +591,11 @@ bool BuildGraphLoader::hasProductFileChanged(const QList<ResolvedProductPtr> &re
         if (!pfi.exists()) {
             qCDebug(lcBuildGraph) << "A product was removed, must re-resolve project";
             hasChanged = true;
+            changedBuildSystemFiles.insert(filePath);
         } else if (referenceTime < pfi.lastModified()) {
             qCDebug(lcBuildGraph) << "A product was changed, must re-resolve project";
             hasChanged = true;
+            changedBuildSystemFiles.insert(filePath);
         } else if (!changedProducts.contains(product)) {
             bool foundMissingSourceFile = false;
             for (const QString &file : qAsConst(product->missingSourceFiles)) {
@@ -608,21 +646,25 @@ bool BuildGraphLoader::hasProductFileChanged(const QList<ResolvedProductPtr> &re
 }
 
 bool BuildGraphLoader::hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
-                                                 const FileTime &referenceTime)
+                                                 const FileTime &referenceTime,
+                                                 Set<QString> &changedBuildSystemFiles)
 {
+    bool hasChanged = false;
     for (const QString &file : buildSystemFiles) {
         const FileInfo fi(file);
         if (!fi.exists() || referenceTime < fi.lastModified()) {
-            qCDebug(lcBuildGraph) << "A qbs or js file changed, must re-resolve project.";
-            return true;
+            qCDebug(lcBuildGraph) << "A qbs or js file changed, must re-resolve project:"
+                                  << file;
+            changedBuildSystemFiles.insert(file);
+            hasChanged = true;
         }
     }
-    return false;
+    return hasChanged;
 }
 
 void BuildGraphLoader::checkAllProductsForChanges(const QList<ResolvedProductPtr> &restoredProducts,
         const QMap<QString, ResolvedProductPtr> &newlyResolvedProductsByName,
-        QList<ResolvedProductPtr> &changedProducts)
+        const Set<QString> *changedBuildSystemFiles, QList<ResolvedProductPtr> &changedProducts)
 {
     for (const ResolvedProductPtr &restoredProduct : restoredProducts) {
         const ResolvedProductPtr newlyResolvedProduct
@@ -637,6 +679,14 @@ void BuildGraphLoader::checkAllProductsForChanges(const QList<ResolvedProductPtr
             continue;
         }
 
+        if (changedBuildSystemFiles && !newlyResolvedProduct->buildSystemFiles.empty()
+                && !newlyResolvedProduct->buildSystemFiles.intersects(
+                    *changedBuildSystemFiles)) {
+            qCDebug(lcBuildGraph) << "Product" << restoredProduct->uniqueName()
+                                  << "is not affected by the changed build system files";
+            continue;
+        }
+
         if (checkProductForChanges(restoredProduct, newlyResolvedProduct)) {
             qCDebug(lcBuildGraph) << "Product" << restoredProduct->uniqueName()
                                   << "was changed, must set up build data from scratch";
@@ -834,7 +884,9 @@ static void invalidateTransformer(const TransformerPtr &transformer)
     const JavaScriptCommandPtr &pseudoCommand = JavaScriptCommand::create();
     pseudoCommand->setSourceCode(QStringLiteral("random stuff that will cause "
                                                 "commandsEqual() to fail"));
-    transformer->commands << pseudoCommand;
+    QList<AbstractCommandPtr> commands = transformer->commands();
+    commands << pseudoCommand;
+    transformer->setCommands(commands);
 }
 
 static bool checkForImportFileChange(const std::vector<QString> &importedFiles,
@@ -920,7 +972,7 @@ bool BuildGraphLoader::checkForEnvChanges(const TransformerPtr &restoredTrafo)
     if (!m_envChange)
         return false;
     // TODO: Also check results of getEnv() from commands here; we currently do not track them
-    for (const AbstractCommandPtr &c : qAsConst(restoredTrafo->commands)) {
+    for (const AbstractCommandPtr &c : restoredTrafo->commands()) {
         if (c->type() != AbstractCommand::ProcessCommandType)
             continue;
         for (const QString &var : std::static_pointer_cast<ProcessCommand>(c)->relevantEnvVars()) {
@@ -1051,7 +1103,7 @@ void BuildGraphLoader::rescueOldBuildData(const ResolvedProductConstPtr &restore
             rad.timeStamp = oldArtifact->timestamp();
             rad.fileTags = oldArtifact->fileTags();
             rad.properties = oldArtifact->properties;
-            rad.commands = oldArtifact->transformer->commands;
+            rad.commands = oldArtifact->transformer->commands();
             rad.propertiesRequestedInPrepareScript
                     = oldArtifact->transformer->propertiesRequestedInPrepareScript;
             rad.propertiesRequestedInCommands
@@ -93,11 +93,14 @@ private:
     bool hasProductFileChanged(const QList<ResolvedProductPtr> &restoredProducts,
                                const FileTime &referenceTime,
                                Set<QString> &remainingBuildSystemFiles,
-                               QList<ResolvedProductPtr> &productsWithChangedFiles);
+                               QList<ResolvedProductPtr> &productsWithChangedFiles,
+                               Set<QString> &changedBuildSystemFiles);
     bool hasBuildSystemFileChanged(const Set<QString> &buildSystemFiles,
-                                   const FileTime &referenceTime);
+                                   const FileTime &referenceTime,
+                                   Set<QString> &changedBuildSystemFiles);
     void checkAllProductsForChanges(const QList<ResolvedProductPtr> &restoredProducts,
             const QMap<QString, ResolvedProductPtr> &newlyResolvedProductsByName,
+            const Set<QString> *changedBuildSystemFiles,
             QList<ResolvedProductPtr> &changedProducts);
     bool checkProductForChanges(const ResolvedProductPtr &restoredProduct,
                                 const ResolvedProductPtr &newlyResolvedProduct);
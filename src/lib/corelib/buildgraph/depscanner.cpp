@@ -134,6 +134,11 @@ bool PluginDependencyScanner::recursive() const
     return m_plugin->flags & ScannerRecursiveDependencies;
 }
 
+bool PluginDependencyScanner::supportsConcurrentScanning() const
+{
+    return m_plugin->flags & ScannerSupportsConcurrentScanning;
+}
+
 const void *PluginDependencyScanner::key() const
 {
     return m_plugin;
@@ -185,6 +190,12 @@ bool UserDependencyScanner::recursive() const
     return m_scanner->recursive;
 }
 
+bool UserDependencyScanner::supportsConcurrentScanning() const
+{
+    // The scan script runs in the rules evaluation engine, which is bound to the executor thread.
+    return false;
+}
+
 const void *UserDependencyScanner::key() const
 {
     return m_scanner.get();
@@ -68,6 +68,9 @@ public:
     virtual QStringList collectSearchPaths(Artifact *artifact) = 0;
     virtual QStringList collectDependencies(FileResourceBase *file, const char *fileTags) = 0;
     virtual bool recursive() const = 0;
+
+    // If true, collectDependencies() may be called from several threads at the same time.
+    virtual bool supportsConcurrentScanning() const = 0;
     virtual const void *key() const = 0;
     virtual bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
                                                const PropertyMapConstPtr &m2) const = 0;
@@ -87,6 +90,7 @@ private:
     QStringList collectSearchPaths(Artifact *artifact);
     QStringList collectDependencies(FileResourceBase *file, const char *fileTags);
     bool recursive() const;
+    bool supportsConcurrentScanning() const;
     const void *key() const;
     QString createId() const;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
@@ -104,6 +108,7 @@ private:
     QStringList collectSearchPaths(Artifact *artifact);
     QStringList collectDependencies(FileResourceBase *file, const char *fileTags);
     bool recursive() const;
+    bool supportsConcurrentScanning() const;
     const void *key() const;
     QString createId() const;
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &m1,
@@ -184,11 +184,12 @@ void EnvironmentScriptRunner::setupEnvironment()
         }
         setupScriptEngineForFile(engine(), setupScript.fileContext(), m_evalContext->scope(),
                                  ObserveMode::Disabled);
-        // TODO: Cache evaluate result
-        QScriptValue fun = engine()->evaluate(setupScript.sourceCode(),
-                                              setupScript.location().filePath(),
-                                              setupScript.location().line());
-        QBS_CHECK(fun.isFunction());
+        QScriptValue &fun = setupScript.scriptFunction;
+        if (!fun.isValid() || fun.engine() != engine()) {
+            fun = engine()->evaluate(setupScript.sourceCode(), setupScript.location().filePath(),
+                                     setupScript.location().line());
+            QBS_CHECK(fun.isFunction());
+        }
         const QScriptValueList svArgs = ScriptEngine::argumentList(scriptFunctionArgs,
                                                                    m_evalContext->scope());
         const QScriptValue res = fun.call(QScriptValue(), svArgs);
@@ -38,6 +38,7 @@
 ****************************************************************************/
 #include "executor.h"
 
+#include "artifactcache.h"
 #include "buildgraph.h"
 #include "emptydirectoriesremover.h"
 #include "environmentscriptrunner.h"
@@ -66,6 +67,7 @@
 #include <tools/qttools.h>
 #include <tools/stringconstants.h>
 
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qtimer.h>
 
@@ -73,13 +75,19 @@
 #include <climits>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
 
-bool Executor::ComparePriority::operator() (const BuildGraphNode *x, const BuildGraphNode *y) const
+// Leaves on the longest remaining chain of work are started first, so that long serial chains,
+// such as a big generated source feeding a link, do not delay the end of the build.
+// The product build priority serves as the tie breaker.
+bool Executor::ComparePriority::operator() (const Leaf &x, const Leaf &y) const
 {
-    return x->product->buildData->buildPriority < y->product->buildData->buildPriority;
+    if (x.criticalPathLength != y.criticalPathLength)
+        return x.criticalPathLength < y.criticalPathLength;
+    return x.node->product->buildData->buildPriority < y.node->product->buildData->buildPriority;
 }
 
 
@@ -89,6 +97,7 @@ Executor::Executor(const Logger &logger, QObject *parent)
     , m_logger(logger)
     , m_progressObserver(nullptr)
     , m_state(ExecutorIdle)
+    , m_defaultDuration(1)
     , m_cancelationTimer(new QTimer(this))
 {
     m_inputArtifactScanContext = new InputArtifactScannerContext;
@@ -134,9 +143,9 @@ void Executor::retrieveSourceFileTimestamp(Artifact *artifact) const
 {
     QBS_CHECK(artifact->artifactType == Artifact::SourceFile);
 
-    if (m_buildOptions.changedFiles().empty())
+    if (m_changedFiles.empty())
         artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
-    else if (m_buildOptions.changedFiles().contains(artifact->filePath()))
+    else if (m_changedFiles.contains(artifact->filePath()))
         artifact->setTimestamp(FileTime::currentTime());
     else if (!artifact->timestamp().isValid())
         artifact->setTimestamp(recursiveFileTime(artifact->filePath()));
@@ -211,16 +220,30 @@ void Executor::doBuild()
         qCDebug(lcExec) << "max job count not explicitly set, using value of"
                         << m_buildOptions.maxJobCount();
     }
+    m_inputArtifactScanContext->setMaxScanThreadCount(m_buildOptions.maxJobCount());
     QBS_CHECK(m_state == ExecutorIdle);
     m_leaves = Leaves();
+    m_criticalPathLengths.clear();
+    m_jobCountPerPool.clear();
+    m_jobLimits = m_buildOptions.jobLimits();
     m_changedSourceArtifacts.clear();
     m_error.clear();
     m_explicitlyCanceled = false;
     m_activeFileTags = FileTags::fromStringList(m_buildOptions.activeFileTags());
+    m_changedFiles = Set<QString>::fromList(m_buildOptions.changedFiles());
     m_tagsOfFilesToConsider.clear();
     m_tagsNeededForFilesToConsider.clear();
     m_productsOfFilesToConsider.clear();
     m_artifactsRemovedFromDisk.clear();
+    m_artifactCacheKeys.clear();
+    m_processResultsForArtifactCache.clear();
+    if (!m_buildOptions.artifactCacheDirectory().isEmpty() && !m_buildOptions.dryRun()) {
+        m_artifactCache.reset(new ArtifactCache(m_buildOptions.artifactCacheDirectory(),
+                                                m_buildOptions.artifactCacheIsRelocatable(),
+                                                m_project.get(), m_logger));
+    } else {
+        m_artifactCache.reset();
+    }
 
     // TODO: The "filesToConsider" thing is badly designed; we should know exactly which artifact
     //       it is. Remove this from the BuildOptions class and introduce Project::buildSomeFiles()
@@ -228,7 +251,7 @@ void Executor::doBuild()
     const QStringList &filesToConsider = m_buildOptions.filesToConsider();
     if (!filesToConsider.empty()) {
         for (const QString &fileToConsider : filesToConsider) {
-            const QList<FileResourceBase *> &files
+            const ProjectBuildData::FileResources files
                     = m_project->buildData->lookupFiles(fileToConsider);
             for (const FileResourceBase * const file : files) {
                 if (file->fileType() != FileResourceBase::FileTypeArtifact)
@@ -255,6 +278,8 @@ void Executor::doBuild()
     m_project->buildData->evaluationContext
             = RulesEvaluationContextPtr(new RulesEvaluationContext(m_logger));
     m_evalContext = m_project->buildData->evaluationContext;
+    m_evalContext->setObserver(m_progressObserver);
+    m_evalContext->setMaxThreadCount(m_buildOptions.maxJobCount());
 
     m_elapsedTimeRules = m_elapsedTimeScanners = m_elapsedTimeInstalling = 0;
     m_evalContext->engine()->enableProfiling(m_buildOptions.logElapsedTime());
@@ -275,6 +300,7 @@ void Executor::doBuild()
     setupRootNodes();
     prepareReachableNodes();
     setupProgressObserver();
+    initDurationEstimate();
     initLeaves();
     if (!scheduleJobs()) {
         qCDebug(lcExec) << "Nothing to do at all, finishing.";
@@ -328,17 +354,70 @@ void Executor::updateLeaves(BuildGraphNode *node, NodeSet &seenNodes)
 
     if (isLeaf) {
         qCDebug(lcExec) << "adding leaf" << node->toString();
-        m_leaves.push(node);
+        addLeaf(node);
+    }
+}
+
+void Executor::addLeaf(BuildGraphNode *node)
+{
+    m_leaves.push(Leaf{node, criticalPathLength(node)});
+}
+
+// Transformers that have not run before are assumed to take as long as an average one.
+void Executor::initDurationEstimate()
+{
+    qint64 totalDuration = 0;
+    int transformerCount = 0;
+    for (const ResolvedProductPtr &product : qAsConst(m_productsToBuild)) {
+        for (const Artifact * const artifact : filterByType<Artifact>(product->buildData->nodes)) {
+            if (artifact->transformer && artifact->transformer->lastRunDuration >= 0) {
+                totalDuration += artifact->transformer->lastRunDuration;
+                ++transformerCount;
+            }
+        }
     }
+    m_defaultDuration = transformerCount > 0 ? std::max<qint64>(totalDuration / transformerCount, 1)
+                                             : 1;
+}
+
+qint64 Executor::estimatedDuration(const BuildGraphNode *node) const
+{
+    if (node->type() != BuildGraphNode::ArtifactNodeType)
+        return 0;
+    const Artifact * const artifact = static_cast<const Artifact *>(node);
+    if (!artifact->transformer)
+        return 0;
+    const qint64 duration = artifact->transformer->lastRunDuration;
+    return duration >= 0 ? duration : m_defaultDuration;
+}
+
+// The estimated time it takes to build the node and everything that depends on it.
+qint64 Executor::criticalPathLength(BuildGraphNode *node)
+{
+    const auto it = m_criticalPathLengths.constFind(node);
+    if (it != m_criticalPathLengths.constEnd())
+        return it.value();
+    qint64 maxParentLength = 0;
+    for (BuildGraphNode * const parent : qAsConst(node->parents))
+        maxParentLength = std::max(maxParentLength, criticalPathLength(parent));
+    const qint64 length = estimatedDuration(node) + maxParentLength;
+    m_criticalPathLengths.insert(node, length);
+    return length;
 }
 
 // Returns true if some artifacts are still waiting to be built or currently building.
 bool Executor::scheduleJobs()
 {
     QBS_CHECK(m_state == ExecutorRunning);
+    std::vector<Leaf> blockedLeaves;
     while (!m_leaves.empty() && !m_availableJobs.empty()) {
-        BuildGraphNode * const nodeToBuild = m_leaves.top();
+        const Leaf leaf = m_leaves.top();
+        BuildGraphNode * const nodeToBuild = leaf.node;
         m_leaves.pop();
+        if (isBlockedByJobLimit(nodeToBuild)) {
+            blockedLeaves.push_back(leaf);
+            continue;
+        }
 
         switch (nodeToBuild->buildState) {
         case BuildGraphNode::Untouched:
@@ -359,10 +438,41 @@ bool Executor::scheduleJobs()
             break;
         }
     }
+    for (const Leaf &leaf : blockedLeaves)
+        m_leaves.push(leaf);
     return !m_leaves.empty() || !m_processingJobs.empty();
 }
 
-bool Executor::isUpToDate(Artifact *artifact) const
+// A node whose commands would exceed the limit of one of their job pools stays in the
+// leaves until a job from that pool has finished.
+bool Executor::isBlockedByJobLimit(const BuildGraphNode *node) const
+{
+    if (m_jobLimits.empty() || node->type() != BuildGraphNode::ArtifactNodeType
+            || node->buildState != BuildGraphNode::Buildable) {
+        return false;
+    }
+    const Artifact * const artifact = static_cast<const Artifact *>(node);
+    if (!artifact->transformer)
+        return false;
+    for (const QString &pool : artifact->transformer->jobPools()) {
+        const int limit = m_jobLimits.value(pool);
+        if (limit > 0 && m_jobCountPerPool.value(pool) >= limit) {
+            qCDebug(lcExec) << "job limit of pool" << pool << "reached, deferring"
+                            << node->toString();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::updateJobCountPerPool(const Transformer *transformer, int delta)
+{
+    for (const QString &pool : transformer->jobPools())
+        m_jobCountPerPool[pool] += delta;
+}
+
+bool Executor::isUpToDate(Artifact *artifact,
+                          std::vector<Artifact *> &artifactsWithUnchangedInputs) const
 {
     QBS_CHECK(artifact->artifactType == Artifact::Generated);
 
@@ -380,13 +490,22 @@ bool Executor::isUpToDate(Artifact *artifact) const
         return false;
     }
 
+    // An input is newer than the artifact. It is still up to date if the content of
+    // the inputs is the same as when it was built.
+    const auto checkInputContents = [this, artifact, &artifactsWithUnchangedInputs]() -> bool {
+        if (!inputsHaveUnchangedContent(artifact))
+            return false;
+        artifactsWithUnchangedInputs.push_back(artifact);
+        return true;
+    };
+
     for (Artifact *childArtifact : filterByType<Artifact>(artifact->children)) {
         QBS_CHECK(childArtifact->timestamp().isValid());
         qCDebug(lcUpToDateCheck) << "child timestamp"
                                  << childArtifact->timestamp().toString()
                                  << childArtifact->filePath();
         if (artifact->timestamp() < childArtifact->timestamp())
-            return false;
+            return checkInputContents();
     }
 
     for (FileDependency *fileDependency : qAsConst(artifact->fileDependencies)) {
@@ -403,29 +522,116 @@ bool Executor::isUpToDate(Artifact *artifact) const
                                  << fileDependency->timestamp().toString()
                                  << fileDependency->filePath();
         if (artifact->timestamp() < fileDependency->timestamp())
-            return false;
+            return checkInputContents();
     }
 
     return true;
 }
 
-bool Executor::mustExecuteTransformer(const TransformerPtr &transformer) const
+bool Executor::inputsHaveUnchangedContent(Artifact *artifact) const
+{
+    if (!m_buildOptions.useContentHashes() || artifact->inputsHash.isEmpty())
+        return false;
+    if (computeInputsHash(artifact) != artifact->inputsHash) {
+        qCDebug(lcUpToDateCheck) << "content of inputs has changed. Out of date.";
+        return false;
+    }
+    qCDebug(lcUpToDateCheck) << "inputs are newer, but their content has not changed.";
+    return true;
+}
+
+// Brings the timestamp of an artifact whose inputs are newer but unchanged in content up to
+// date, so their content does not have to be checked again in the next build. The file is
+// touched as well, because the timestamps in the build graph and in the file system
+// must agree; otherwise the next build with --check-timestamps would consider the artifact
+// out of date again. If touching fails, the artifact is left alone and its inputs will be
+// checked again next time.
+void Executor::updateTimestampOfUnchangedArtifact(Artifact *artifact)
+{
+    if (m_buildOptions.dryRun())
+        return;
+    if (!touchFile(artifact->filePath())) {
+        qCDebug(lcUpToDateCheck) << "cannot update timestamp of" << artifact->filePath();
+        return;
+    }
+
+    // The artifact itself has not changed, so its content hash stays valid.
+    const QByteArray hash = artifact->contentHash();
+    artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
+    if (!hash.isEmpty())
+        artifact->setContentHash(hash);
+    m_project->buildData->isDirty = true;
+}
+
+// Returns an empty array if the content of at least one input could not be retrieved.
+QByteArray Executor::computeInputsHash(Artifact *artifact) const
+{
+    std::vector<std::pair<QString, QByteArray>> inputHashes;
+    const auto addInput = [this, &inputHashes](FileResourceBase *input) {
+        const QByteArray hash = contentHash(input);
+        if (hash.isEmpty()) {
+            qCDebug(lcUpToDateCheck) << "cannot get content hash of" << input->filePath();
+            return false;
+        }
+        inputHashes.push_back(std::make_pair(input->filePath(), hash));
+        return true;
+    };
+    for (Artifact * const child : filterByType<Artifact>(artifact->children)) {
+        if (!addInput(child))
+            return QByteArray();
+    }
+    for (FileDependency * const fileDependency : qAsConst(artifact->fileDependencies)) {
+        if (!addInput(fileDependency))
+            return QByteArray();
+    }
+    std::sort(inputHashes.begin(), inputHashes.end());
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(commandListHash(artifact->transformer->commands()));
+    for (const auto &input : inputHashes) {
+        hash.addData(input.first.toUtf8());
+        hash.addData(input.second);
+    }
+    return hash.result();
+}
+
+QByteArray Executor::contentHash(FileResourceBase *file) const
+{
+    if (!file->timestamp().isValid() && file->fileType() == FileResourceBase::FileTypeDependency)
+        file->setTimestamp(FileInfo(file->filePath()).lastModified());
+    if (!file->timestamp().isValid())
+        return QByteArray();
+    QByteArray hash = file->contentHash();
+    if (hash.isEmpty()) {
+        hash = fileContentHash(file->filePath());
+        file->setContentHash(hash);
+    }
+    return hash;
+}
+
+bool Executor::mustExecuteTransformer(const TransformerPtr &transformer)
 {
     if (transformer->alwaysRun)
         return true;
     bool hasAlwaysUpdatedArtifacts = false;
+    std::vector<Artifact *> artifactsWithUnchangedInputs;
     for (Artifact *artifact : qAsConst(transformer->outputs)) {
         if (artifact->alwaysUpdated)
             hasAlwaysUpdatedArtifacts = true;
         else if (!m_buildOptions.forceTimestampCheck())
             continue;
-        if (!isUpToDate(artifact))
+        if (!isUpToDate(artifact, artifactsWithUnchangedInputs))
             return true;
     }
 
     // If all artifacts in a transformer have "alwaysUpdated" set to false, that transformer
     // is always run.
-    return !hasAlwaysUpdatedArtifacts;
+    if (!hasAlwaysUpdatedArtifacts)
+        return true;
+
+    for (Artifact * const artifact : artifactsWithUnchangedInputs)
+        updateTimestampOfUnchangedArtifact(artifact);
+    return false;
 }
 
 void Executor::buildArtifact(Artifact *artifact)
@@ -496,6 +702,11 @@ void Executor::executeRuleNode(RuleNode *ruleNode)
         qCDebug(lcExec) << ruleNode->toString() << "is up to date. Skipping.";
     } else {
         qCDebug(lcExec) << ruleNode->toString();
+
+        // The memory of removed nodes can get reused for the created ones.
+        for (const BuildGraphNode * const node : qAsConst(result.removedNodes))
+            m_criticalPathLengths.remove(node);
+
         const WeakPointer<ResolvedProduct> &product = ruleNode->product;
         Set<RuleNode *> parentRules;
         if (!result.createdNodes.empty()) {
@@ -537,33 +748,21 @@ void Executor::finishJob(ExecutorJob *job, bool success)
     const TransformerPtr transformer = it.value();
     m_processingJobs.erase(it);
     m_availableJobs.push_back(job);
+    updateJobCountPerPool(transformer.get(), -1);
     if (success) {
-        m_project->buildData->isDirty = true;
-        for (Artifact * const artifact : qAsConst(transformer->outputs)) {
-            if (artifact->alwaysUpdated) {
-                artifact->setTimestamp(FileTime::currentTime());
-                if (m_buildOptions.forceOutputCheck()
-                        && !m_buildOptions.dryRun() && !FileInfo(artifact->filePath()).exists()) {
-                    if (transformer->rule) {
-                        if (!transformer->rule->name.isEmpty()) {
-                            throw ErrorInfo(tr("Rule '%1' declares artifact '%2', "
-                                               "but the artifact was not produced.")
-                                            .arg(transformer->rule->name, artifact->filePath()));
-                        }
-                        throw ErrorInfo(tr("Rule declares artifact '%1', "
-                                           "but the artifact was not produced.")
-                                        .arg(artifact->filePath()));
-                    }
-                    throw ErrorInfo(tr("Transformer declares artifact '%1', "
-                                       "but the artifact was not produced.")
-                                    .arg(artifact->filePath()));
-                }
-            } else {
-                artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
-            }
+        if (!m_buildOptions.dryRun())
+            transformer->lastRunDuration = job->elapsedTime();
+        updateOutputsAfterRun(transformer);
+        const QByteArray cacheKey = m_artifactCacheKeys.take(transformer.get());
+        if (!cacheKey.isEmpty()) {
+            m_artifactCache->insert(cacheKey, transformer.get(),
+                                    m_processResultsForArtifactCache.value(transformer.get()));
         }
         finishTransformer(transformer);
+    } else {
+        m_artifactCacheKeys.remove(transformer.get());
     }
+    m_processResultsForArtifactCache.remove(transformer.get());
 
     if (!success && !m_buildOptions.keepGoing())
         cancelJobs();
@@ -605,7 +804,7 @@ void Executor::finishNode(BuildGraphNode *leaf)
         }
 
         if (allChildrenBuilt(parent)) {
-            m_leaves.push(parent);
+            addLeaf(parent);
             qCDebug(lcExec) << "finishNode adds leaf"
                             << parent->toString() << toString(parent->buildState);
         } else {
@@ -718,12 +917,23 @@ void Executor::addExecutorJobs()
         m_availableJobs.push_back(job);
         connect(job, &ExecutorJob::reportCommandDescription,
                 this, &Executor::reportCommandDescription);
-        connect(job, &ExecutorJob::reportProcessResult, this, &Executor::reportProcessResult);
+        connect(job, &ExecutorJob::reportProcessResult, this,
+                [this, job](const ProcessResult &result) { handleProcessResult(job, result); });
         connect(job, &ExecutorJob::finished,
                 this, &Executor::onJobFinished, Qt::QueuedConnection);
     }
 }
 
+void Executor::handleProcessResult(ExecutorJob *job, const ProcessResult &result)
+{
+    // The output of the tools is stored in the artifact cache along with the outputs,
+    // so it can be shown again when they are restored.
+    const TransformerPtr transformer = m_processingJobs.value(job);
+    if (transformer && m_artifactCacheKeys.contains(transformer.get()))
+        m_processResultsForArtifactCache[transformer.get()].push_back(result);
+    emit reportProcessResult(result);
+}
+
 void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = 0)
 {
     if (childrenAdded)
@@ -743,7 +953,7 @@ void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = 0)
 
     typedef std::pair<Artifact *, bool> ChildArtifactData;
     QList<ChildArtifactData> childrenToConnect;
-    bool canRescue = commandListsAreEqual(artifact->transformer->commands, rad.commands);
+    bool canRescue = commandListsAreEqual(artifact->transformer->commands(), rad.commands);
     if (canRescue) {
         ResolvedProductPtr pseudoProduct = ResolvedProduct::create();
         for (const RescuableArtifactData::ChildData &cd : qAsConst(rad.children)) {
@@ -772,7 +982,8 @@ void Executor::rescueOldBuildData(Artifact *artifact, bool *childrenAdded = 0)
                 childrenToConnect.push_back({child, cd.addedByScanner});
         }
         for (const QString &depPath : rad.fileDependencies) {
-            const QList<FileResourceBase *> depList = m_project->buildData->lookupFiles(depPath);
+            const ProjectBuildData::FileResources depList
+                    = m_project->buildData->lookupFiles(depPath);
             if (depList.empty()) {
                 canRescue = false;
                 qCDebug(lcBuildGraph) << "File dependency" << depPath
@@ -932,14 +1143,79 @@ void Executor::runTransformer(const TransformerPtr &transformer)
         }
     }
 
+    if (m_artifactCache && ArtifactCache::isCacheable(transformer.get())) {
+        const QByteArray cacheKey = m_artifactCache->key(transformer.get(),
+                [this](FileResourceBase *file) { return contentHash(file); });
+        if (!cacheKey.isEmpty()) {
+            std::vector<ProcessResult> processResults;
+            if (m_artifactCache->restore(cacheKey, transformer.get(), processResults)) {
+                qCDebug(lcExec) << "outputs restored from artifact cache";
+                reportRestoredCommands(transformer);
+                for (const ProcessResult &result : processResults)
+                    emit reportProcessResult(result);
+                updateOutputsAfterRun(transformer);
+                finishTransformer(transformer);
+                return;
+            }
+            m_artifactCacheKeys.insert(transformer.get(), cacheKey);
+        }
+    }
+
     QBS_CHECK(!m_availableJobs.empty());
     ExecutorJob *job = m_availableJobs.takeFirst();
     for (Artifact * const artifact : qAsConst(transformer->outputs))
         artifact->buildState = BuildGraphNode::Building;
     m_processingJobs.insert(job, transformer);
+    updateJobCountPerPool(transformer.get(), 1);
     job->run(transformer.get());
 }
 
+void Executor::updateOutputsAfterRun(const TransformerPtr &transformer)
+{
+    m_project->buildData->isDirty = true;
+    for (Artifact * const artifact : qAsConst(transformer->outputs)) {
+        if (artifact->alwaysUpdated) {
+            artifact->setTimestamp(FileTime::currentTime());
+            if (m_buildOptions.forceOutputCheck()
+                    && !m_buildOptions.dryRun() && !FileInfo(artifact->filePath()).exists()) {
+                if (transformer->rule) {
+                    if (!transformer->rule->name.isEmpty()) {
+                        throw ErrorInfo(tr("Rule '%1' declares artifact '%2', "
+                                           "but the artifact was not produced.")
+                                        .arg(transformer->rule->name, artifact->filePath()));
+                    }
+                    throw ErrorInfo(tr("Rule declares artifact '%1', "
+                                       "but the artifact was not produced.")
+                                    .arg(artifact->filePath()));
+                }
+                throw ErrorInfo(tr("Transformer declares artifact '%1', "
+                                   "but the artifact was not produced.")
+                                .arg(artifact->filePath()));
+            }
+        } else {
+            artifact->setTimestamp(FileInfo(artifact->filePath()).lastModified());
+        }
+        if (m_buildOptions.useContentHashes() && !m_buildOptions.dryRun()) {
+            artifact->setContentHash(fileContentHash(artifact->filePath()));
+            artifact->inputsHash = computeInputsHash(artifact);
+        } else {
+            artifact->inputsHash.clear();
+        }
+    }
+}
+
+void Executor::reportRestoredCommands(const TransformerPtr &transformer)
+{
+    if (m_buildOptions.echoMode() == CommandEchoModeSilent)
+        return;
+    for (const AbstractCommandPtr &cmd : transformer->commands()) {
+        if (!cmd->isSilent() && !cmd->description().isEmpty()) {
+            emit reportCommandDescription(cmd->highlight(),
+                                          Tr::tr("%1 [cached]").arg(cmd->description()));
+        }
+    }
+}
+
 void Executor::finishTransformer(const TransformerPtr &transformer)
 {
     for (Artifact * const artifact : qAsConst(transformer->outputs)) {
@@ -1049,6 +1325,10 @@ void Executor::finish()
     QBS_ASSERT(!m_evalContext || !m_evalContext->engine()->isActive(), /* ignore */);
 
     checkForUnbuiltProducts();
+
+    // Waits for the outputs that are still being copied into the cache.
+    m_artifactCache.reset();
+
     if (m_explicitlyCanceled) {
         QString message = Tr::tr(m_buildOptions.executeRulesOnly()
                                  ? "Rule execution canceled" : "Build canceled");
@@ -1136,9 +1416,14 @@ void Executor::prepareArtifact(Artifact *artifact)
         possiblyInstallArtifact(artifact);
     }
 
-    // Timestamps of file dependencies must be invalid for every build.
-    for (FileDependency * const fileDependency : qAsConst(artifact->fileDependencies))
-        fileDependency->clearTimestamp();
+    // Timestamps of file dependencies must be invalid for every build, unless we were told
+    // which of them have changed.
+    const bool checkAllFileDependencies = m_changedFiles.empty()
+            || !m_buildOptions.changedFilesIncludeFileDependencies();
+    for (FileDependency * const fileDependency : qAsConst(artifact->fileDependencies)) {
+        if (checkAllFileDependencies || m_changedFiles.contains(fileDependency->filePath()))
+            fileDependency->clearTimestamp();
+    }
 }
 
 void Executor::setupForBuildingSelectedFiles(const BuildGraphNode *node)
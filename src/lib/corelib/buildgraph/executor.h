@@ -48,9 +48,15 @@
 #include <logging/logger.h>
 #include <tools/buildoptions.h>
 #include <tools/error.h>
+#include <tools/processresult.h>
+#include <tools/set.h>
 
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
+
+#include <memory>
 #include <queue>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QTimer;
@@ -60,6 +66,7 @@ namespace qbs {
 class ProcessResult;
 
 namespace Internal {
+class ArtifactCache;
 class ExecutorJob;
 class FileTime;
 class InputArtifactScannerContext;
@@ -101,13 +108,18 @@ private:
 
     enum ExecutorState { ExecutorIdle, ExecutorRunning, ExecutorCanceling };
 
+    struct Leaf
+    {
+        BuildGraphNode *node;
+        qint64 criticalPathLength;
+    };
+
     struct ComparePriority
     {
-        bool operator() (const BuildGraphNode *x, const BuildGraphNode *y) const;
+        bool operator() (const Leaf &x, const Leaf &y) const;
     };
 
-    typedef std::priority_queue<BuildGraphNode *, std::vector<BuildGraphNode *>,
-                                ComparePriority> Leaves;
+    typedef std::priority_queue<Leaf, std::vector<Leaf>, ComparePriority> Leaves;
 
     void doBuild();
     void prepareAllNodes();
@@ -118,9 +130,15 @@ private:
     void prepareProducts();
     void setupRootNodes();
     void initLeaves();
+    void addLeaf(BuildGraphNode *node);
+    void initDurationEstimate();
+    qint64 estimatedDuration(const BuildGraphNode *node) const;
+    qint64 criticalPathLength(BuildGraphNode *node);
     void updateLeaves(const NodeSet &nodes);
     void updateLeaves(BuildGraphNode *node, NodeSet &seenNodes);
     bool scheduleJobs();
+    bool isBlockedByJobLimit(const BuildGraphNode *node) const;
+    void updateJobCountPerPool(const Transformer *transformer, int delta);
     void buildArtifact(Artifact *artifact);
     void executeRuleNode(RuleNode *ruleNode);
     void finishJob(ExecutorJob *job, bool success);
@@ -136,13 +154,21 @@ private:
     bool checkForUnbuiltDependencies(Artifact *artifact);
     void potentiallyRunTransformer(const TransformerPtr &transformer);
     void runTransformer(const TransformerPtr &transformer);
+    void updateOutputsAfterRun(const TransformerPtr &transformer);
+    void handleProcessResult(ExecutorJob *job, const ProcessResult &result);
+    void reportRestoredCommands(const TransformerPtr &transformer);
     void finishTransformer(const TransformerPtr &transformer);
     void possiblyInstallArtifact(const Artifact *artifact);
     void checkForUnbuiltProducts();
     bool checkNodeProduct(BuildGraphNode *node);
 
-    bool mustExecuteTransformer(const TransformerPtr &transformer) const;
-    bool isUpToDate(Artifact *artifact) const;
+    bool mustExecuteTransformer(const TransformerPtr &transformer);
+    bool isUpToDate(Artifact *artifact,
+                    std::vector<Artifact *> &artifactsWithUnchangedInputs) const;
+    bool inputsHaveUnchangedContent(Artifact *artifact) const;
+    void updateTimestampOfUnchangedArtifact(Artifact *artifact);
+    QByteArray computeInputsHash(Artifact *artifact) const;
+    QByteArray contentHash(FileResourceBase *file) const;
     void retrieveSourceFileTimestamp(Artifact *artifact) const;
     FileTime recursiveFileTime(const QString &filePath) const;
     QString configString() const;
@@ -164,11 +190,19 @@ private:
     QList<ResolvedProductPtr> m_productsToBuild;
     NodeSet m_roots;
     Leaves m_leaves;
+    QHash<const BuildGraphNode *, qint64> m_criticalPathLengths;
+    QHash<QString, int> m_jobCountPerPool;
+    QHash<QString, int> m_jobLimits;
+    qint64 m_defaultDuration;
     QList<Artifact *> m_changedSourceArtifacts;
     InputArtifactScannerContext *m_inputArtifactScanContext;
+    std::unique_ptr<ArtifactCache> m_artifactCache;
+    QHash<const Transformer *, QByteArray> m_artifactCacheKeys;
+    QHash<const Transformer *, std::vector<ProcessResult>> m_processResultsForArtifactCache;
     ErrorInfo m_error;
     bool m_explicitlyCanceled;
     FileTags m_activeFileTags;
+    Set<QString> m_changedFiles;
     FileTags m_tagsOfFilesToConsider;
     FileTags m_tagsNeededForFilesToConsider;
     QList<ResolvedProductPtr> m_productsOfFilesToConsider;
@@ -46,6 +46,7 @@
 #include "transformer.h"
 #include <language/language.h>
 #include <tools/error.h>
+#include <tools/profiling.h>
 #include <tools/qbsassert.h>
 
 #include <QtCore/qthread.h>
@@ -97,7 +98,14 @@ void ExecutorJob::run(Transformer *t)
 {
     QBS_ASSERT(m_currentCommandIdx == -1, return);
 
-    if (t->commands.empty()) {
+    m_elapsedTimer.start();
+    const TraceRecorder &traceRecorder = TraceRecorder::instance();
+    if (traceRecorder.isRecording()) {
+        m_traceName = t->outputs.empty() ? t->rule->toString()
+                                         : (*t->outputs.cbegin())->fileName();
+        m_traceStartTime = traceRecorder.currentTime();
+    }
+    if (t->commands().empty()) {
         setFinished();
         return;
     }
@@ -122,14 +130,14 @@ void ExecutorJob::cancel()
 
 void ExecutorJob::runNextCommand()
 {
-    QBS_ASSERT(m_currentCommandIdx <= m_transformer->commands.size(), return);
+    QBS_ASSERT(m_currentCommandIdx <= m_transformer->commands().size(), return);
     ++m_currentCommandIdx;
-    if (m_currentCommandIdx >= m_transformer->commands.size()) {
+    if (m_currentCommandIdx >= m_transformer->commands().size()) {
         setFinished();
         return;
     }
 
-    const AbstractCommandPtr &command = m_transformer->commands.at(m_currentCommandIdx);
+    const AbstractCommandPtr &command = m_transformer->commands().at(m_currentCommandIdx);
     switch (command->type()) {
     case AbstractCommand::ProcessCommandType:
         m_currentCommandExecutor = m_processCommandExecutor;
@@ -159,6 +167,10 @@ void ExecutorJob::onCommandFinished(const ErrorInfo &err)
 
 void ExecutorJob::setFinished()
 {
+    if (m_traceStartTime != -1) {
+        TraceRecorder::instance().addEvent("job", m_traceName, m_traceStartTime, objectName());
+        m_traceStartTime = -1;
+    }
     const ErrorInfo err = m_error;
     reset();
     emit finished(err);
@@ -44,6 +44,7 @@
 #include <tools/commandechomode.h>
 #include <tools/error.h>
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qobject.h>
 
 namespace qbs {
@@ -71,6 +72,7 @@ public:
     void setEchoMode(CommandEchoMode echoMode);
     void run(Transformer *t);
     void cancel();
+    qint64 elapsedTime() const { return m_elapsedTimer.elapsed(); }
 
 signals:
     void reportCommandDescription(const QString &highlight, const QString &message);
@@ -90,6 +92,9 @@ private:
     Transformer *m_transformer;
     int m_currentCommandIdx;
     ErrorInfo m_error;
+    QElapsedTimer m_elapsedTimer;
+    QString m_traceName;
+    qint64 m_traceStartTime = -1;
 };
 
 } // namespace Internal
@@ -39,13 +39,12 @@
 
 #include "filedependency.h"
 
-#include <tools/fileinfo.h>
 #include <tools/persistence.h>
 
 namespace qbs {
 namespace Internal {
 
-FileResourceBase::FileResourceBase()
+FileResourceBase::FileResourceBase() : m_fileNameIndex(0)
 {
 }
 
@@ -64,10 +63,29 @@ const FileTime &FileResourceBase::timestamp() const
     return m_timestamp;
 }
 
+const QByteArray &FileResourceBase::contentHash() const
+{
+    static const QByteArray noHash;
+    return m_timestamp.isValid() && m_contentHashTimestamp == m_timestamp
+            ? m_contentHash : noHash;
+}
+
+void FileResourceBase::setContentHash(const QByteArray &hash)
+{
+    m_contentHash = hash;
+    m_contentHashTimestamp = m_timestamp;
+}
+
+void FileResourceBase::clearContentHash()
+{
+    m_contentHash.clear();
+    m_contentHashTimestamp.clear();
+}
+
 void FileResourceBase::setFilePath(const QString &filePath)
 {
     m_filePath = filePath;
-    FileInfo::splitIntoDirectoryAndFileName(m_filePath, &m_dirPath, &m_fileName);
+    m_fileNameIndex = m_filePath.lastIndexOf(QLatin1Char('/')) + 1;
 }
 
 const QString &FileResourceBase::filePath() const
@@ -79,12 +97,16 @@ void FileResourceBase::load(PersistentPool &pool)
 {
     setFilePath(pool.load<QString>());
     pool.load(m_timestamp);
+    pool.load(m_contentHashTimestamp);
+    pool.load(m_contentHash);
 }
 
 void FileResourceBase::store(PersistentPool &pool) const
 {
     pool.store(m_filePath);
     pool.store(m_timestamp);
+    pool.store(m_contentHashTimestamp);
+    pool.store(m_contentHash);
 }
 
 
@@ -42,6 +42,8 @@
 
 #include <tools/filetime.h>
 
+#include <QtCore/qbytearray.h>
+
 namespace qbs {
 namespace Internal {
 
@@ -60,19 +62,28 @@ public:
     const FileTime &timestamp() const;
     void clearTimestamp() { m_timestamp.clear(); }
 
+    // The content hash is only valid as long as the timestamp it was computed for is current.
+    const QByteArray &contentHash() const;
+    void setContentHash(const QByteArray &hash);
+    void clearContentHash();
+
     void setFilePath(const QString &filePath);
     const QString &filePath() const;
-    QString dirPath() const { return m_dirPath.toString(); }
-    QString fileName() const { return m_fileName.toString(); }
+    QString dirPath() const
+    {
+        return m_fileNameIndex > 0 ? m_filePath.left(m_fileNameIndex - 1) : QString();
+    }
+    QString fileName() const { return m_filePath.mid(m_fileNameIndex); }
 
     virtual void load(PersistentPool &pool);
     virtual void store(PersistentPool &pool) const;
 
 private:
     FileTime m_timestamp;
+    FileTime m_contentHashTimestamp;
+    QByteArray m_contentHash;
     QString m_filePath;
-    QStringRef m_dirPath;
-    QStringRef m_fileName;
+    int m_fileNameIndex; // Position of the file name in m_filePath.
 };
 
 class FileDependency : public FileResourceBase
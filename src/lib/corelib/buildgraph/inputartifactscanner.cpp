@@ -50,15 +50,21 @@
 #include <language/language.h>
 #include <logging/categories.h>
 #include <tools/fileinfo.h>
+#include <tools/profiling.h>
 #include <tools/scannerpluginmanager.h>
 #include <tools/qbsassert.h>
 #include <tools/error.h>
 #include <tools/qttools.h>
 
 #include <QtCore/qdir.h>
+#include <QtCore/qrunnable.h>
 #include <QtCore/qstringlist.h>
+#include <QtCore/qthreadpool.h>
 #include <QtCore/qvariant.h>
 
+#include <functional>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -163,13 +169,17 @@ void InputArtifactScanner::scanForFileDependencies(Artifact *inputArtifact)
     m_fileTagsForScanner
             = inputArtifact->fileTags().toStringList().join(QLatin1Char(',')).toLatin1();
     while (!filesToScan.empty()) {
-        FileResourceBase *fileToBeScanned = filesToScan.takeFirst();
-        const QString &filePathToBeScanned = fileToBeScanned->filePath();
-        if (!visitedFilePaths.insert(filePathToBeScanned).second)
-            continue;
+        // All files found in the previous round are handled together, so that the ones
+        // that need to be scanned can be processed concurrently.
+        QList<FileResourceBase *> filesToBeScanned;
+        for (FileResourceBase * const file : qAsConst(filesToScan)) {
+            if (visitedFilePaths.insert(file->filePath()).second)
+                filesToBeScanned.push_back(file);
+        }
+        filesToScan.clear();
 
         for (DependencyScanner * const scanner : scanners) {
-            scanForScannerFileDependencies(scanner, inputArtifact, fileToBeScanned,
+            scanForScannerFileDependencies(scanner, inputArtifact, filesToBeScanned,
                 scanner->recursive() ? &filesToScan : 0, cacheItem[scanner->key()]);
         }
     }
@@ -205,12 +215,10 @@ Set<DependencyScanner *> InputArtifactScanner::scannersForArtifact(const Artifac
 }
 
 void InputArtifactScanner::scanForScannerFileDependencies(DependencyScanner *scanner,
-        Artifact *inputArtifact, FileResourceBase *fileToBeScanned,
+        Artifact *inputArtifact, const QList<FileResourceBase *> &filesToBeScanned,
         QList<FileResourceBase *> *filesToScan,
         InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache)
 {
-    qCDebug(lcDepScan) << "file" << fileToBeScanned->filePath();
-
     const bool cacheHit = cache.valid;
     if (!cacheHit) {
         cache.valid = true;
@@ -220,21 +228,92 @@ void InputArtifactScanner::scanForScannerFileDependencies(DependencyScanner *sca
     for (const QString &s : qAsConst(cache.searchPaths))
         qCDebug(lcDepScan) << "    " << s;
 
-    const QString &filePathToBeScanned = fileToBeScanned->filePath();
-    RawScanResults::ScanData &scanData = m_rawScanResults.findScanData(fileToBeScanned, scanner,
-                                                                       m_artifact->properties);
-    if (scanData.lastScanTime < fileToBeScanned->timestamp()) {
+    updateScanData(scanner, filesToBeScanned);
+
+    for (FileResourceBase * const fileToBeScanned : filesToBeScanned) {
+        qCDebug(lcDepScan) << "file" << fileToBeScanned->filePath();
+        const RawScanResults::ScanData &scanData = m_rawScanResults.findScanData(
+                    fileToBeScanned, scanner, m_artifact->properties);
+        if (scanData.lastScanTime < fileToBeScanned->timestamp())
+            continue; // Scanning failed.
+        resolveScanResultDependencies(inputArtifact, scanData.rawScanResult, filesToScan, cache);
+    }
+}
+
+namespace {
+class ScanRunnable : public QRunnable
+{
+public:
+    ScanRunnable(const std::function<void()> &scan) : m_scan(scan) {}
+
+private:
+    void run() override { m_scan(); }
+
+    const std::function<void()> m_scan;
+};
+} // namespace
+
+std::vector<FileScanResult> scanFiles(DependencyScanner *scanner,
+        const std::vector<FileResourceBase *> &files, const QByteArray &fileTags,
+        QThreadPool *threadPool)
+{
+    std::vector<FileScanResult> results(files.size());
+    const auto scanFile = [scanner, &files, &fileTags, &results](size_t index) {
+        const TraceEvent traceEvent("scanner", files.at(index)->filePath());
         try {
-            qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(filePathToBeScanned);
-            scanWithScannerPlugin(scanner, fileToBeScanned, &scanData.rawScanResult);
-            scanData.lastScanTime = FileTime::currentTime();
+            results[index].dependencies = scanner->collectDependencies(files.at(index),
+                                                                       fileTags.constData());
         } catch (const ErrorInfo &error) {
-            m_logger.printWarning(error);
-            return;
+            results[index].error = error;
+        }
+    };
+    if (threadPool && files.size() > 1 && scanner->supportsConcurrentScanning()) {
+        qCDebug(lcDepScan) << "scanning" << files.size() << "files concurrently";
+        for (size_t i = 0; i < files.size(); ++i)
+            threadPool->start(new ScanRunnable([&scanFile, i] { scanFile(i); }));
+        threadPool->waitForDone();
+    } else {
+        for (size_t i = 0; i < files.size(); ++i) {
+            qCDebug(lcDepScan) << "scanning" << FileInfo::fileName(files.at(i)->filePath());
+            scanFile(i);
         }
     }
+    return results;
+}
+
+void InputArtifactScanner::updateScanData(DependencyScanner *scanner,
+                                          const QList<FileResourceBase *> &filesToBeScanned)
+{
+    std::vector<FileResourceBase *> outdatedFiles;
+    for (FileResourceBase * const file : filesToBeScanned) {
+        const RawScanResults::ScanData &scanData
+                = m_rawScanResults.findScanData(file, scanner, m_artifact->properties);
+        if (scanData.lastScanTime < file->timestamp())
+            outdatedFiles.push_back(file);
+    }
+    if (outdatedFiles.empty())
+        return;
 
-    resolveScanResultDependencies(inputArtifact, scanData.rawScanResult, filesToScan, cache);
+    // The scanner itself runs in worker threads if possible. Everything that touches
+    // the build graph or the scan results is done in this thread afterwards,
+    // so no further synchronization is needed.
+    const std::vector<FileScanResult> results = scanFiles(scanner, outdatedFiles,
+            m_fileTagsForScanner, m_context->threadPool.get());
+    const FileTime scanTime = FileTime::currentTime();
+    for (size_t i = 0; i < outdatedFiles.size(); ++i) {
+        if (results.at(i).error.hasError()) {
+            m_logger.printWarning(results.at(i).error);
+            continue;
+        }
+        RawScanResults::ScanData &scanData
+                = m_rawScanResults.findScanData(outdatedFiles.at(i), scanner,
+                                                m_artifact->properties);
+        scanData.rawScanResult.deps.clear();
+        for (const QString &s : results.at(i).dependencies)
+            scanData.rawScanResult.deps.push_back(RawScannedDependency(s));
+        scanData.lastScanTime = scanTime;
+        m_rawScanResults.setDirty();
+    }
 }
 
 void InputArtifactScanner::resolveScanResultDependencies(const Artifact *inputArtifact,
@@ -348,15 +427,23 @@ void InputArtifactScanner::handleDependency(ResolvedDependency &dependency)
     }
 }
 
-void InputArtifactScanner::scanWithScannerPlugin(DependencyScanner *scanner,
-                                                 FileResourceBase *fileToBeScanned,
-                                                 RawScanResult *scanResult)
+InputArtifactScannerContext::InputArtifactScannerContext()
 {
-    scanResult->deps.clear();
-    const QStringList &dependencies
-            = scanner->collectDependencies(fileToBeScanned, m_fileTagsForScanner.constData());
-    for (const QString &s : dependencies)
-        scanResult->deps.push_back(RawScannedDependency(s));
+}
+
+InputArtifactScannerContext::~InputArtifactScannerContext()
+{
+}
+
+void InputArtifactScannerContext::setMaxScanThreadCount(int count)
+{
+    if (count <= 1) {
+        threadPool.reset();
+        return;
+    }
+    if (!threadPool)
+        threadPool.reset(new QThreadPool);
+    threadPool->setMaxThreadCount(count);
 }
 
 InputArtifactScannerContext::DependencyScannerCacheItem::DependencyScannerCacheItem() : valid(false)
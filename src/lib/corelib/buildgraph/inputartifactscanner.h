@@ -43,11 +43,21 @@
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 #include <logging/logger.h>
+#include <tools/error.h>
+#include <tools/qbs_export.h>
 #include <tools/set.h>
 
 #include <QtCore/qhash.h>
+#include <QtCore/qlist.h>
 #include <QtCore/qstringlist.h>
 
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QThreadPool;
+QT_END_NAMESPACE
+
 class ScannerPlugin;
 
 namespace qbs {
@@ -73,6 +83,14 @@ public:
 
 class InputArtifactScannerContext
 {
+public:
+    InputArtifactScannerContext();
+    ~InputArtifactScannerContext();
+
+    // Files that do not have up-to-date scan results are scanned using up to this many threads.
+    void setMaxScanThreadCount(int count);
+
+private:
     struct ResolvedDependencyCacheItem
     {
         ResolvedDependencyCacheItem()
@@ -109,10 +127,24 @@ class InputArtifactScannerContext
 
     QHash<PropertyMapConstPtr, CacheItem> cache;
     QHash<ResolvedProduct*, QHash<FileTag, DependencyScannerCacheItem> > scannersCache;
+    std::unique_ptr<QThreadPool> threadPool;
 
     friend class InputArtifactScanner;
 };
 
+struct FileScanResult
+{
+    QStringList dependencies;
+    ErrorInfo error;
+};
+
+// Collects the dependencies of the given files. The files are scanned in the threads of
+// the given pool if there is one and the scanner supports concurrent scanning.
+// The results are in the same order as the files.
+std::vector<FileScanResult> QBS_AUTOTEST_EXPORT scanFiles(DependencyScanner *scanner,
+        const std::vector<FileResourceBase *> &files, const QByteArray &fileTags,
+        QThreadPool *threadPool);
+
 class InputArtifactScanner
 {
 public:
@@ -125,15 +157,15 @@ private:
     void scanForFileDependencies(Artifact *inputArtifact);
     Set<DependencyScanner *> scannersForArtifact(const Artifact *artifact) const;
     void scanForScannerFileDependencies(DependencyScanner *scanner,
-            Artifact *inputArtifact, FileResourceBase *fileToBeScanned,
+            Artifact *inputArtifact, const QList<FileResourceBase *> &filesToBeScanned,
             QList<FileResourceBase *> *filesToScan,
             InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache);
+    void updateScanData(DependencyScanner *scanner,
+                        const QList<FileResourceBase *> &filesToBeScanned);
     void resolveScanResultDependencies(const Artifact *inputArtifact,
             const RawScanResult &scanResult, QList<FileResourceBase *> *artifactsToScan,
             InputArtifactScannerContext::ScannerResolvedDependenciesCache &cache);
     void handleDependency(ResolvedDependency &dependency);
-    void scanWithScannerPlugin(DependencyScanner *scanner, FileResourceBase *fileToBeScanned,
-                               RawScanResult *scanResult);
 
     Artifact * const m_artifact;
     RawScanResults &m_rawScanResults;
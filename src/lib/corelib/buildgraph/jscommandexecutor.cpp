@@ -48,15 +48,27 @@
 #include <language/preparescriptobserver.h>
 #include <language/resolvedfilecontext.h>
 #include <language/scriptengine.h>
+#include <logging/categories.h>
 #include <logging/logger.h>
+#include <logging/translator.h>
 #include <tools/codelocation.h>
 #include <tools/error.h>
+#include <tools/fileinfo.h>
+#include <tools/hostosinfo.h>
 #include <tools/qbsassert.h>
+#include <tools/stringconstants.h>
 
 #include <QtCore/qeventloop.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qtextstream.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qtimer.h>
 
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -84,8 +96,8 @@ public:
 
     void cancel()
     {
-        QBS_ASSERT(m_scriptEngine, return);
-        m_scriptEngine->abortEvaluation();
+        if (m_scriptEngine) // Natively run commands cannot be canceled.
+            m_scriptEngine->abortEvaluation();
     }
 
 signals:
@@ -110,13 +122,13 @@ private:
     {
         m_result.success = true;
         m_result.errorMessage.clear();
+        if (runNatively(cmd, transformer))
+            return;
         ScriptEngine * const scriptEngine = provideScriptEngine();
+        const QScriptValue globalObject = scriptEngine->globalObject();
         QScriptValue scope = scriptEngine->newObject();
-        scope.setPrototype(scriptEngine->globalObject());
+        scope.setPrototype(provideFileScope(transformer->rule->prepareScript.fileContext()));
         PrepareScriptObserver observer(scriptEngine, UnobserveMode::Enabled);
-        setupScriptEngineForFile(scriptEngine,
-                                 transformer->rule->prepareScript.fileContext(), scope,
-                                 ObserveMode::Enabled);
 
         QScriptValue importScopeForSourceCode;
         if (!cmd->scopeName().isEmpty())
@@ -136,11 +148,11 @@ private:
         scriptEngine->setGlobalObject(scope);
         if (importScopeForSourceCode.isObject())
             scriptEngine->currentContext()->pushScope(importScopeForSourceCode);
-        scriptEngine->evaluate(cmd->sourceCode());
+        scriptEngine->evaluateCachedProgram(cmd->sourceCode());
         scriptEngine->releaseResourcesOfScriptObjects();
         if (importScopeForSourceCode.isObject())
             scriptEngine->currentContext()->popScope();
-        scriptEngine->setGlobalObject(scope.prototype());
+        scriptEngine->setGlobalObject(globalObject);
         transformer->propertiesRequestedInCommands
                 += scriptEngine->propertiesRequestedInScript();
         transformer->propertiesRequestedFromArtifactInCommands
@@ -157,6 +169,182 @@ private:
         }
     }
 
+    // Many commands in the modules do nothing but File.copy() and File.remove() on
+    // the input and output file paths or on string properties of the command, or they write
+    // such a string into a TextFile. These are run here directly, which saves setting up the
+    // script engine for them.
+    bool runNatively(const JavaScriptCommand *cmd, const Transformer *transformer)
+    {
+        const std::vector<NativeFileOperation> operations = nativeFileOperations(cmd,
+                                                                                  transformer);
+        if (operations.empty())
+            return false;
+        qCDebug(lcExec) << "running command natively:" << cmd->description();
+        for (const NativeFileOperation &op : operations) {
+            QString errorMessage;
+            bool success = false;
+            switch (op.type) {
+            case NativeFileOperation::Copy:
+                success = copyFileRecursion(op.filePath, op.argument, true, true,
+                                            &errorMessage);
+                break;
+            case NativeFileOperation::Remove:
+                success = removeFileRecursion(QFileInfo(op.filePath), &errorMessage);
+                break;
+            case NativeFileOperation::WriteText:
+                success = writeTextFile(op.filePath, op.argument, &errorMessage);
+                break;
+            }
+            if (!success) {
+                setError(errorMessage, cmd->codeLocation());
+                break;
+            }
+        }
+        return true;
+    }
+
+    // Does what TextFile does, including the use of the locale's codec.
+    static bool writeTextFile(const QString &filePath, const QString &text,
+                              QString *errorMessage)
+    {
+        QFile file(filePath);
+        if (!file.open(QIODevice::WriteOnly)) {
+            *errorMessage = Tr::tr("Unable to open file '%1': %2")
+                    .arg(filePath, file.errorString());
+            return false;
+        }
+        QTextStream stream(&file);
+        stream << text;
+        return true;
+    }
+
+    struct NativeFileOperation
+    {
+        enum Type { Copy, Remove, WriteText };
+
+        Type type;
+        QString filePath;
+        QString argument; // The target file path for Copy, the text for WriteText.
+    };
+
+    static std::vector<NativeFileOperation> nativeFileOperations(const JavaScriptCommand *cmd,
+                                                                 const Transformer *transformer)
+    {
+        static const QString fileExtension = QStringLiteral("File");
+        static const QString textFileExtension = QStringLiteral("TextFile");
+        const ResolvedFileContextConstPtr &fileContext
+                = transformer->rule->prepareScript.fileContext();
+        if (!cmd->scopeName().isEmpty())
+            return {};
+        const auto isAvailable = [cmd, &fileContext](const QString &extension) -> bool {
+            if (!fileContext->jsExtensions().contains(extension)
+                    || cmd->properties().contains(extension)) {
+                return false;
+            }
+            for (const JsImport &jsImport : fileContext->jsImports()) {
+                if (jsImport.scopeName == extension)
+                    return false;
+            }
+            return true;
+        };
+        const bool fileAvailable = isAvailable(fileExtension);
+        const bool textFileAvailable = isAvailable(textFileExtension);
+        if (!fileAvailable && !textFileAvailable)
+            return {};
+
+        static const QRegularExpression functionRegExp(
+                    QStringLiteral("^\\(function\\s*\\(\\s*\\)\\s*\\{(.*)\\}\\)\\(\\)$"),
+                    QRegularExpression::DotMatchesEverythingOption);
+        static const QRegularExpression callRegExp(QStringLiteral(
+                "^File\\.(copy|remove)\\(\\s*([\\w$.]+)\\s*(?:,\\s*([\\w$.]+)\\s*)?\\)$"));
+        static const QRegularExpression openRegExp(QStringLiteral(
+                "^var\\s+([\\w$]+)\\s*=\\s*new\\s+TextFile\\(\\s*([\\w$.]+)\\s*,"
+                "\\s*TextFile\\.WriteOnly\\s*\\)$"));
+        static const QRegularExpression writeRegExp(QStringLiteral(
+                "^([\\w$]+)\\.(write|writeLine)\\(\\s*([\\w$.]+)\\s*\\)$"));
+        static const QRegularExpression closeRegExp(QStringLiteral(
+                "^([\\w$]+)\\.close\\(\\s*\\)$"));
+        const QRegularExpressionMatch functionMatch = functionRegExp.match(cmd->sourceCode());
+        if (!functionMatch.hasMatch())
+            return {};
+        const auto stringArgument = [cmd, transformer](const QString &argument) -> QString {
+            const auto singleFilePath = [](const ArtifactSet &artifacts) {
+                return artifacts.size() == 1 ? (*artifacts.cbegin())->filePath() : QString();
+            };
+            if (argument == QStringLiteral("input.filePath")
+                    && !cmd->properties().contains(StringConstants::inputVar())) {
+                return singleFilePath(transformer->inputs);
+            }
+            if (argument == QStringLiteral("output.filePath")
+                    && !cmd->properties().contains(StringConstants::outputVar())) {
+                return singleFilePath(transformer->outputs);
+            }
+            const QVariant value = cmd->properties().value(argument);
+            return value.type() == QVariant::String ? value.toString() : QString();
+        };
+        std::vector<NativeFileOperation> operations;
+        QString textFileVariable; // Non-empty while a TextFile is open.
+        const QStringList statements = functionMatch.captured(1).split(QLatin1Char(';'));
+        for (const QString &statement : statements) {
+            const QString trimmedStatement = statement.trimmed();
+            if (trimmedStatement.isEmpty())
+                continue;
+            if (!textFileVariable.isEmpty()) {
+                const QRegularExpressionMatch writeMatch = writeRegExp.match(trimmedStatement);
+                if (writeMatch.hasMatch() && writeMatch.captured(1) == textFileVariable) {
+                    const QString text = stringArgument(writeMatch.captured(3));
+                    if (text.isNull())
+                        return {};
+                    QString &fileContent = operations.back().argument;
+                    fileContent += text;
+                    if (writeMatch.captured(2) == QStringLiteral("writeLine")) {
+                        if (HostOsInfo::isWindowsHost())
+                            fileContent += QLatin1Char('\r');
+                        fileContent += QLatin1Char('\n');
+                    }
+                    continue;
+                }
+                const QRegularExpressionMatch closeMatch = closeRegExp.match(trimmedStatement);
+                if (!closeMatch.hasMatch() || closeMatch.captured(1) != textFileVariable)
+                    return {};
+                textFileVariable.clear();
+                continue;
+            }
+            NativeFileOperation op;
+            const QRegularExpressionMatch openMatch = openRegExp.match(trimmedStatement);
+            if (openMatch.hasMatch()) {
+                if (!textFileAvailable)
+                    return {};
+                op.type = NativeFileOperation::WriteText;
+                op.filePath = stringArgument(openMatch.captured(2));
+                if (op.filePath.isEmpty())
+                    return {};
+                textFileVariable = openMatch.captured(1);
+                operations.push_back(op);
+                continue;
+            }
+            const QRegularExpressionMatch callMatch = callRegExp.match(trimmedStatement);
+            if (!callMatch.hasMatch() || !fileAvailable)
+                return {};
+            const bool isCopy = callMatch.captured(1) == QStringLiteral("copy");
+            if (isCopy == callMatch.captured(3).isEmpty())
+                return {};
+            op.type = isCopy ? NativeFileOperation::Copy : NativeFileOperation::Remove;
+            op.filePath = stringArgument(callMatch.captured(2));
+            if (op.filePath.isEmpty())
+                return {};
+            if (isCopy) {
+                op.argument = stringArgument(callMatch.captured(3));
+                if (op.argument.isEmpty())
+                    return {};
+            }
+            operations.push_back(op);
+        }
+        if (!textFileVariable.isEmpty()) // The file would stay open until garbage collection.
+            return {};
+        return operations;
+    }
+
     void setError(const QString &errorMessage, const CodeLocation &codeLocation)
     {
         m_result.success = false;
@@ -171,8 +359,31 @@ private:
         return m_scriptEngine;
     }
 
+    // The imports and extensions of a file context are set up only once per engine and
+    // then shared by all commands coming from that file, so that running a command does not
+    // have to rebuild them every time. The per-command scope has this object as prototype.
+    QScriptValue provideFileScope(const ResolvedFileContextConstPtr &fileContext)
+    {
+        auto it = m_fileScopes.find(fileContext.get());
+        if (it == m_fileScopes.end()) {
+            QScriptValue fileScope = m_scriptEngine->newObject();
+            fileScope.setPrototype(m_scriptEngine->globalObject());
+            setupScriptEngineForFile(m_scriptEngine, fileContext, fileScope,
+                                     ObserveMode::Enabled);
+            it = m_fileScopes.insert(fileContext.get(), FileScope{fileContext, fileScope});
+        }
+        return it->scope;
+    }
+
+    struct FileScope
+    {
+        ResolvedFileContextConstPtr fileContext; // Keeps the key alive.
+        QScriptValue scope;
+    };
+
     Logger m_logger;
     ScriptEngine *m_scriptEngine;
+    QHash<const ResolvedFileContext *, FileScope> m_fileScopes;
     JavaScriptCommandResult m_result;
     bool m_running = false;
 };
@@ -41,12 +41,15 @@
 #include "artifact.h"
 #include "projectbuilddata.h"
 #include "rulecommands.h"
+#include "transformer.h"
 #include <language/language.h>
 #include <logging/logger.h>
 #include <tools/error.h>
 #include <tools/persistence.h>
 #include <tools/qbsassert.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -60,8 +63,67 @@ const TypeFilter<Artifact> ProductBuildData::rootArtifacts() const
     return TypeFilter<Artifact>(roots);
 }
 
+static std::vector<Transformer *> transformersOf(const NodeSet &nodes)
+{
+    std::vector<Transformer *> transformers;
+    Set<Transformer *> seenTransformers;
+    for (const Artifact * const artifact : filterByType<Artifact>(nodes)) {
+        Transformer * const transformer = artifact->transformer.get();
+        if (transformer && seenTransformers.insert(transformer).second)
+            transformers.push_back(transformer);
+    }
+    return transformers;
+}
+
+void ProductBuildData::serializeCommands()
+{
+    const std::vector<Transformer *> transformers = transformersOf(nodes);
+    if (!m_serializedCommands.isEmpty()
+            && std::all_of(transformers.cbegin(), transformers.cend(),
+                           [](const Transformer *t) { return t->m_commandsPending; })) {
+        return;
+    }
+
+    loadAllCommands();
+    m_serializedCommands.clear();
+    m_storedCommands.clear();
+    Logger logger;
+    PersistentPool pool(logger);
+    pool.setupWriteStream(&m_serializedCommands);
+    pool.store(int(transformers.size()));
+    for (size_t i = 0; i < transformers.size(); ++i) {
+        storeCommandList(transformers.at(i)->commands(), pool);
+        transformers.at(i)->m_commandsIndex = int(i);
+    }
+}
+
+QList<AbstractCommandPtr> ProductBuildData::takeStoredCommands(int index)
+{
+    if (!m_serializedCommands.isEmpty()) {
+        Logger logger;
+        PersistentPool pool(logger);
+        pool.setupReadStream(m_serializedCommands);
+        m_storedCommands.resize(pool.load<int>());
+        for (QList<AbstractCommandPtr> &commands : m_storedCommands)
+            commands = loadCommandList(pool);
+        m_serializedCommands.clear();
+    }
+    QBS_CHECK(index >= 0 && size_t(index) < m_storedCommands.size());
+    QList<AbstractCommandPtr> commands;
+    commands.swap(m_storedCommands.at(index));
+    return commands;
+}
+
+void ProductBuildData::loadAllCommands()
+{
+    for (const Transformer * const transformer : transformersOf(nodes))
+        transformer->commands();
+}
+
 void ProductBuildData::load(PersistentPool &pool)
 {
+    pool.load(m_serializedCommands);
+    m_storedCommands.clear();
     nodes.load(pool);
     roots.load(pool);
     pool.load(rescuableArtifactData);
@@ -71,6 +133,7 @@ void ProductBuildData::load(PersistentPool &pool)
 
 void ProductBuildData::store(PersistentPool &pool) const
 {
+    pool.store(m_serializedCommands);
     nodes.store(pool);
     roots.store(pool);
     pool.store(rescuableArtifactData);
@@ -45,8 +45,11 @@
 #include <language/filetags.h>
 #include <language/forward_decls.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qlist.h>
 
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
@@ -76,8 +79,22 @@ public:
     typedef QHash<RuleConstPtr, ArtifactSet> ArtifactSetByRule;
     ArtifactSetByRule artifactsWithChangedInputsPerRule;
 
+    // The command lists of the product's transformers are serialized into a separate section
+    // of the build graph file, which is only deserialized when the first of them is accessed.
+    // serializeCommands() must be called before storing. It keeps the existing section if
+    // it was never deserialized and no transformers were added in the meantime.
+    // The rest of the build data cannot be split up like this, because artifacts, property
+    // maps and strings are shared between products via the pool's object and string ids.
+    void serializeCommands();
+    QList<AbstractCommandPtr> takeStoredCommands(int index);
+    void loadAllCommands();
+
     void load(PersistentPool &pool);
     void store(PersistentPool &pool) const;
+
+private:
+    QByteArray m_serializedCommands;
+    std::vector<QList<AbstractCommandPtr>> m_storedCommands;
 };
 
 void addArtifactToSet(Artifact *artifact, ProductBuildData::ArtifactSetByFileTag &container);
@@ -60,6 +60,8 @@
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -95,10 +97,38 @@ QString ProjectBuildData::deriveBuildGraphFilePath(const QString &buildDir, cons
     return buildDir + QLatin1Char('/') + projectId + QStringLiteral(".bg");
 }
 
+int ProjectBuildData::internedId(QHash<QString, int> &ids, const QString &str)
+{
+    auto it = ids.find(str);
+    if (it == ids.end())
+        it = ids.insert(str, ids.size());
+    return it.value();
+}
+
+ProjectBuildData::LookupKey ProjectBuildData::internedLookupKey(const FileResourceBase *fileres)
+{
+    return (LookupKey(internedId(m_dirPathIds, fileres->dirPath())) << 32)
+            | LookupKey(internedId(m_fileNameIds, fileres->fileName()));
+}
+
+bool ProjectBuildData::lookupKey(const QString &dirPath, const QString &fileName,
+                                 LookupKey *key) const
+{
+    // Most failing lookups come from the scanners, for file names that are not in the
+    // project at all, so the file name gets checked first.
+    const auto fileNameIt = m_fileNameIds.constFind(fileName);
+    if (fileNameIt == m_fileNameIds.constEnd())
+        return false;
+    const auto dirPathIt = m_dirPathIds.constFind(dirPath);
+    if (dirPathIt == m_dirPathIds.constEnd())
+        return false;
+    *key = (LookupKey(dirPathIt.value()) << 32) | LookupKey(fileNameIt.value());
+    return true;
+}
+
 void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
 {
-    QList<FileResourceBase *> &lst
-            = m_artifactLookupTable[fileres->fileName()][fileres->dirPath()];
+    FileResources &lst = m_artifactLookupTable[internedLookupKey(fileres)];
     const auto * const artifact = fileres->fileType() == FileResourceBase::FileTypeArtifact
             ? static_cast<Artifact *>(fileres) : nullptr;
     if (artifact && artifact->artifactType == Artifact::Generated) {
@@ -118,29 +148,43 @@ void ProjectBuildData::insertIntoLookupTable(FileResourceBase *fileres)
             throw error;
         }
     }
-    QBS_CHECK(!lst.contains(fileres));
-    lst.push_back(fileres);
+    QBS_CHECK(std::find(lst.cbegin(), lst.cend(), fileres) == lst.cend());
+    lst.append(fileres);
 }
 
 void ProjectBuildData::removeFromLookupTable(FileResourceBase *fileres)
 {
-    m_artifactLookupTable[fileres->fileName()][fileres->dirPath()].removeOne(fileres);
+    LookupKey key;
+    if (!lookupKey(fileres->dirPath(), fileres->fileName(), &key))
+        return;
+    const auto it = m_artifactLookupTable.find(key);
+    if (it == m_artifactLookupTable.end())
+        return;
+    FileResources &lst = it.value();
+    const auto resIt = std::find(lst.cbegin(), lst.cend(), fileres);
+    if (resIt != lst.cend())
+        lst.remove(int(resIt - lst.cbegin()));
+    if (lst.isEmpty())
+        m_artifactLookupTable.erase(it);
 }
 
-QList<FileResourceBase *> ProjectBuildData::lookupFiles(const QString &filePath) const
+ProjectBuildData::FileResources ProjectBuildData::lookupFiles(const QString &filePath) const
 {
     QString dirPath, fileName;
     FileInfo::splitIntoDirectoryAndFileName(filePath, &dirPath, &fileName);
     return lookupFiles(dirPath, fileName);
 }
 
-QList<FileResourceBase *> ProjectBuildData::lookupFiles(const QString &dirPath,
+ProjectBuildData::FileResources ProjectBuildData::lookupFiles(const QString &dirPath,
         const QString &fileName) const
 {
-    return m_artifactLookupTable.value(fileName).value(dirPath);
+    LookupKey key;
+    if (!lookupKey(dirPath, fileName, &key))
+        return FileResources();
+    return m_artifactLookupTable.value(key);
 }
 
-QList<FileResourceBase *> ProjectBuildData::lookupFiles(const Artifact *artifact) const
+ProjectBuildData::FileResources ProjectBuildData::lookupFiles(const Artifact *artifact) const
 {
     return lookupFiles(artifact->dirPath(), artifact->fileName());
 }
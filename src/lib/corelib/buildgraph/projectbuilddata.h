@@ -48,6 +48,7 @@
 #include <QtCore/qhash.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qstring.h>
+#include <QtCore/qvarlengtharray.h>
 
 #include <QtScript/qscriptvalue.h>
 
@@ -66,12 +67,15 @@ public:
 
     static QString deriveBuildGraphFilePath(const QString &buildDir, const QString &projectId);
 
+    // There is hardly ever more than one resource per file path.
+    typedef QVarLengthArray<FileResourceBase *, 2> FileResources;
+
     void insertIntoLookupTable(FileResourceBase *fileres);
     void removeFromLookupTable(FileResourceBase *fileres);
 
-    QList<FileResourceBase *> lookupFiles(const QString &filePath) const;
-    QList<FileResourceBase *> lookupFiles(const QString &dirPath, const QString &fileName) const;
-    QList<FileResourceBase *> lookupFiles(const Artifact *artifact) const;
+    FileResources lookupFiles(const QString &filePath) const;
+    FileResources lookupFiles(const QString &dirPath, const QString &fileName) const;
+    FileResources lookupFiles(const Artifact *artifact) const;
     void insertFileDependency(FileDependency *dependency);
     void removeArtifactAndExclusiveDependents(Artifact *artifact, const Logger &logger,
             bool removeFromProduct = true, ArtifactSet *removedArtifacts = 0);
@@ -90,9 +94,16 @@ public:
     void store(PersistentPool &pool) const;
 
 private:
-    typedef QHash<QString, QList<FileResourceBase *> > ResultsPerDirectory;
-    typedef QHash<QString, ResultsPerDirectory> ArtifactLookupTable;
-    ArtifactLookupTable m_artifactLookupTable;
+    typedef quint64 LookupKey;
+    static int internedId(QHash<QString, int> &ids, const QString &str);
+    LookupKey internedLookupKey(const FileResourceBase *fileres);
+    bool lookupKey(const QString &dirPath, const QString &fileName, LookupKey *key) const;
+
+    // The directory paths and file names are interned separately, so a directory path
+    // is stored only once, no matter how many files it contains.
+    QHash<QString, int> m_dirPathIds;
+    QHash<QString, int> m_fileNameIds;
+    QHash<LookupKey, FileResources> m_artifactLookupTable;
     bool m_doCleanupInDestructor;
 };
 
@@ -83,6 +83,7 @@ private:
     QStringList collectSearchPaths(Artifact *) override { return QStringList(); }
     QStringList collectDependencies(FileResourceBase *, const char *) override { return QStringList(); }
     bool recursive() const override { return false; }
+    bool supportsConcurrentScanning() const override { return false; }
     const void *key() const override { return nullptr; }
     QString createId() const override { return m_id; }
     bool areModulePropertiesCompatible(const PropertyMapConstPtr &,
@@ -169,6 +170,7 @@ static RawScanResult runScanner(ScannerPlugin *scanner, const Artifact *artifact
 
         scanner->close(opaq);
         scanData.lastScanTime = FileTime::currentTime();
+        rawScanResults.setDirty();
     }
     return scanData.rawScanResult;
 }
@@ -53,6 +53,12 @@ RawScannedDependency::RawScannedDependency(const QString &filePath)
     setClean();
 }
 
+RawScannedDependency::RawScannedDependency(const QString &dirPath, const QString &fileName)
+    : m_dirPath(dirPath), m_fileName(fileName)
+{
+    setClean();
+}
+
 QString RawScannedDependency::filePath() const
 {
     return m_dirPath.isEmpty() ? m_fileName : m_dirPath + QLatin1Char('/') + m_fileName;
@@ -51,6 +51,7 @@ class RawScannedDependency
 public:
     RawScannedDependency();
     RawScannedDependency(const QString &filePath);
+    RawScannedDependency(const QString &dirPath, const QString &fileName);
 
     QString filePath() const;
     const QString &dirPath() const { return m_dirPath; }
@@ -42,14 +42,287 @@
 #include "filedependency.h"
 #include "depscanner.h"
 
+#include <logging/categories.h>
+#include <logging/translator.h>
+#include <tools/error.h>
 #include <tools/persistence.h>
+#include <tools/qbsassert.h>
 #include <language/propertymapinternal.h>
 
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/quuid.h>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
 #include <utility>
 
 namespace qbs {
 namespace Internal {
 
+// Layout of the scan results file. All offsets are relative to the start of the file,
+// and all strings are stored once in UTF-16, so they can be used without decoding.
+//   FileHeader
+//   file table: (path string index, offset of file data) for each file, sorted by path
+//   string table: (offset, length) for each string
+//   string data
+//   file data: the ScanData entries of each file, with strings given as indices
+static const char scanResultsMagic[8] = { 'Q', 'B', 'S', 'S', 'C', 'A', 'N', '1' };
+static const quint32 scanResultsByteOrderMark = 0x01020304;
+static const quint32 noPropertyMap = 0xffffffff;
+
+struct ScanResultsFileHeader
+{
+    char magic[8];
+    quint32 byteOrderMark;
+    quint32 fileTimeSize;
+    char generation[16];
+    quint32 fileCount;
+    quint32 fileTableOffset;
+    quint32 stringCount;
+    quint32 stringTableOffset;
+};
+
+static_assert(std::is_trivially_copyable<FileTime>::value,
+              "FileTime is written to the scan results file as raw memory");
+static_assert(sizeof(FileTime) % sizeof(quint32) == 0,
+              "FileTime must not break the alignment of the scan results file");
+
+class ScanResultsWriter
+{
+public:
+    template<typename PropertyMapIndexFunction>
+    void addFile(const QString &filePath, const std::vector<RawScanResults::ScanData> &scanData,
+                 const PropertyMapIndexFunction &propertyMapIndex)
+    {
+        m_files.push_back(std::make_pair(filePath, quint32(m_fileData.size())));
+        append(quint32(scanData.size()));
+        for (const RawScanResults::ScanData &data : scanData) {
+            append(stringIndex(data.scannerId));
+            append(propertyMapIndex(data.moduleProperties));
+            m_fileData.append(reinterpret_cast<const char *>(&data.lastScanTime),
+                              sizeof data.lastScanTime);
+            append(quint32(data.rawScanResult.deps.size()));
+            for (const RawScannedDependency &dep : data.rawScanResult.deps) {
+                append(stringIndex(dep.dirPath()));
+                append(stringIndex(dep.fileName()));
+            }
+            append(quint32(data.rawScanResult.additionalFileTags.size()));
+            for (const FileTag &tag : data.rawScanResult.additionalFileTags)
+                append(stringIndex(QString::fromUtf8(tag.name())));
+        }
+    }
+
+    QByteArray contents(const QByteArray &generation)
+    {
+        std::sort(m_files.begin(), m_files.end());
+        std::vector<quint32> pathIndices;
+        pathIndices.reserve(m_files.size());
+        for (const auto &file : m_files)
+            pathIndices.push_back(stringIndex(file.first));
+
+        ScanResultsFileHeader header;
+        std::memcpy(header.magic, scanResultsMagic, sizeof header.magic);
+        header.byteOrderMark = scanResultsByteOrderMark;
+        header.fileTimeSize = sizeof(FileTime);
+        QBS_CHECK(generation.size() == sizeof header.generation);
+        std::memcpy(header.generation, generation.constData(), sizeof header.generation);
+        header.fileCount = quint32(m_files.size());
+        header.fileTableOffset = sizeof header;
+        header.stringCount = quint32(m_strings.size());
+        header.stringTableOffset = header.fileTableOffset + 2 * sizeof(quint32) * header.fileCount;
+
+        QByteArray stringTable;
+        QByteArray stringData;
+        const quint32 stringDataOffset
+                = header.stringTableOffset + 2 * sizeof(quint32) * header.stringCount;
+        for (const QString &str : m_strings) {
+            append(stringTable, stringDataOffset + quint32(stringData.size()));
+            append(stringTable, quint32(str.size()));
+            stringData.append(reinterpret_cast<const char *>(str.constData()),
+                              str.size() * int(sizeof(QChar)));
+            while (stringData.size() % sizeof(quint32) != 0)
+                stringData.append('\0');
+        }
+
+        const quint32 fileDataOffset = stringDataOffset + quint32(stringData.size());
+        QByteArray data(reinterpret_cast<const char *>(&header), sizeof header);
+        for (size_t i = 0; i < m_files.size(); ++i) {
+            append(data, pathIndices.at(i));
+            append(data, fileDataOffset + m_files.at(i).second);
+        }
+        return data.append(stringTable).append(stringData).append(m_fileData);
+    }
+
+private:
+    static void append(QByteArray &data, quint32 value)
+    {
+        data.append(reinterpret_cast<const char *>(&value), sizeof value);
+    }
+    void append(quint32 value) { append(m_fileData, value); }
+
+    quint32 stringIndex(const QString &str)
+    {
+        const auto it = m_stringIndices.constFind(str);
+        if (it != m_stringIndices.constEnd())
+            return it.value();
+        const quint32 index = quint32(m_strings.size());
+        m_strings.push_back(str);
+        m_stringIndices.insert(str, index);
+        return index;
+    }
+
+    QHash<QString, quint32> m_stringIndices;
+    std::vector<QString> m_strings;
+    std::vector<std::pair<QString, quint32>> m_files;
+    QByteArray m_fileData;
+};
+
+class RawScanResults::StoredScanResults
+{
+public:
+    static std::shared_ptr<const StoredScanResults> open(const QString &filePath,
+                                                         const QByteArray &generation)
+    {
+        const std::shared_ptr<StoredScanResults> results(new StoredScanResults(filePath));
+        if (!results->init(generation))
+            return std::shared_ptr<const StoredScanResults>();
+        return results;
+    }
+
+    quint32 fileCount() const { return m_header.fileCount; }
+    QString filePath(quint32 fileIndex) const { return string(pathIndex(fileIndex)); }
+
+    int indexOf(const QString &filePath) const
+    {
+        quint32 low = 0;
+        quint32 high = m_header.fileCount;
+        while (low < high) {
+            const quint32 mid = low + (high - low) / 2;
+            const int comparison = rawString(pathIndex(mid)).compare(filePath);
+            if (comparison == 0)
+                return int(mid);
+            if (comparison < 0)
+                low = mid + 1;
+            else
+                high = mid;
+        }
+        return -1;
+    }
+
+    std::vector<ScanData> scanData(quint32 fileIndex,
+                                   const std::vector<PropertyMapConstPtr> &propertyMaps) const
+    {
+        std::vector<ScanData> result;
+        quint32 offset = value(m_header.fileTableOffset + (2 * fileIndex + 1) * sizeof(quint32));
+        const quint32 count = value(offset);
+        offset += sizeof(quint32);
+        for (quint32 i = 0; i < count && offset < m_size; ++i) {
+            ScanData scanData;
+            scanData.scannerId = string(value(offset));
+            offset += sizeof(quint32);
+            const quint32 propertyMapIndex = value(offset);
+            offset += sizeof(quint32);
+            if (propertyMapIndex < propertyMaps.size())
+                scanData.moduleProperties = propertyMaps.at(propertyMapIndex);
+            if (quint64(offset) + sizeof(FileTime) <= m_size)
+                std::memcpy(&scanData.lastScanTime, m_data + offset, sizeof(FileTime));
+            offset += sizeof(FileTime);
+            const quint32 depCount = value(offset);
+            offset += sizeof(quint32);
+            for (quint32 j = 0; j < depCount && offset < m_size; ++j) {
+                scanData.rawScanResult.deps.push_back(
+                            RawScannedDependency(string(value(offset)),
+                                                 string(value(offset + sizeof(quint32)))));
+                offset += 2 * sizeof(quint32);
+            }
+            const quint32 tagCount = value(offset);
+            offset += sizeof(quint32);
+            for (quint32 j = 0; j < tagCount && offset < m_size; ++j) {
+                scanData.rawScanResult.additionalFileTags.insert(
+                            FileTag(string(value(offset)).toUtf8()));
+                offset += sizeof(quint32);
+            }
+            result.push_back(std::move(scanData));
+        }
+        return result;
+    }
+
+private:
+    StoredScanResults(const QString &filePath) : m_file(filePath) {}
+
+    bool init(const QByteArray &generation)
+    {
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            qCDebug(lcBuildGraph) << "cannot open scan results file" << m_file.fileName()
+                                  << m_file.errorString();
+            return false;
+        }
+        const qint64 size = m_file.size();
+        if (size < qint64(sizeof m_header) || size > qint64(std::numeric_limits<quint32>::max()))
+            return false;
+        m_size = quint32(size);
+        m_data = m_file.map(0, size);
+        if (!m_data) {
+            qCDebug(lcBuildGraph) << "cannot map scan results file" << m_file.fileName()
+                                  << m_file.errorString();
+            return false;
+        }
+        std::memcpy(&m_header, m_data, sizeof m_header);
+        if (std::memcmp(m_header.magic, scanResultsMagic, sizeof m_header.magic) != 0
+                || m_header.byteOrderMark != scanResultsByteOrderMark
+                || m_header.fileTimeSize != sizeof(FileTime)
+                || QByteArray(m_header.generation, sizeof m_header.generation) != generation) {
+            qCDebug(lcBuildGraph) << "scan results file" << m_file.fileName()
+                                  << "does not belong to the build graph, ignoring it";
+            return false;
+        }
+        return quint64(m_header.fileTableOffset) + 2 * sizeof(quint32) * m_header.fileCount
+                    <= m_size
+                && quint64(m_header.stringTableOffset)
+                    + 2 * sizeof(quint32) * m_header.stringCount <= m_size;
+    }
+
+    quint32 value(quint32 offset) const
+    {
+        quint32 v = 0;
+        if (quint64(offset) + sizeof v <= m_size)
+            std::memcpy(&v, m_data + offset, sizeof v);
+        return v;
+    }
+
+    quint32 pathIndex(quint32 fileIndex) const
+    {
+        return value(m_header.fileTableOffset + 2 * sizeof(quint32) * fileIndex);
+    }
+
+    // Refers to the mapped memory directly, so it must not outlive this object.
+    QString rawString(quint32 index) const
+    {
+        if (index >= m_header.stringCount)
+            return QString();
+        const quint32 entryOffset = m_header.stringTableOffset + 2 * sizeof(quint32) * index;
+        const quint32 offset = value(entryOffset);
+        const quint32 length = value(entryOffset + sizeof(quint32));
+        if (quint64(offset) + quint64(length) * sizeof(QChar) > m_size)
+            return QString();
+        return QString::fromRawData(reinterpret_cast<const QChar *>(m_data + offset), int(length));
+    }
+
+    QString string(quint32 index) const
+    {
+        const QString str = rawString(index);
+        return QString(str.constData(), str.size());
+    }
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    quint32 m_size = 0;
+    ScanResultsFileHeader m_header;
+};
+
 void RawScanResult::load(PersistentPool &pool)
 {
     pool.load(deps);
@@ -83,7 +356,16 @@ RawScanResults::ScanData &RawScanResults::findScanData(
         const DependencyScanner *scanner,
         const PropertyMapConstPtr &moduleProperties)
 {
-    std::vector<ScanData> &scanDataForFile = m_rawScanData[file->filePath()];
+    auto it = m_rawScanData.find(file->filePath());
+    if (it == m_rawScanData.end()) {
+        it = m_rawScanData.insert(file->filePath(), std::vector<ScanData>());
+        if (const StoredScanResults * const stored = storedScanResults()) {
+            const int fileIndex = stored->indexOf(file->filePath());
+            if (fileIndex != -1)
+                it.value() = stored->scanData(fileIndex, m_storedPropertyMaps);
+        }
+    }
+    std::vector<ScanData> &scanDataForFile = it.value();
     const QString &scannerId = scanner->id();
     for (auto &scanData : scanDataForFile) {
         if (scannerId != scanData.scannerId)
@@ -96,17 +378,115 @@ RawScanResults::ScanData &RawScanResults::findScanData(
     newScanData.scannerId = scannerId;
     newScanData.moduleProperties = moduleProperties;
     scanDataForFile.push_back(std::move(newScanData));
+    m_dirty = true;
     return scanDataForFile.back();
 }
 
+QString RawScanResults::deriveFilePath(const QString &buildGraphFilePath)
+{
+    return buildGraphFilePath + QStringLiteral(".scan");
+}
+
+void RawScanResults::prepareStore()
+{
+    m_pendingFileContents.clear();
+    if (!m_dirty || m_filePath.isEmpty()) {
+        // The build graph must not refer to a file that is gone or was replaced.
+        if (!storedScanResults()) {
+            m_generation.clear();
+            m_storedPropertyMaps.clear();
+        }
+        return;
+    }
+
+    m_pendingGeneration = QUuid::createUuid().toRfc4122();
+    m_pendingPropertyMaps.clear();
+    m_pendingFileContents = fileContents(m_pendingGeneration, m_pendingPropertyMaps);
+}
+
+void RawScanResults::writeFile()
+{
+    if (m_pendingFileContents.isEmpty())
+        return;
+    const QByteArray contents = m_pendingFileContents;
+    m_pendingFileContents.clear();
+
+    // The old file must not be mapped anymore when it gets replaced.
+    m_storedScanResults.reset();
+    m_storedScanResultsOpened = false;
+
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(contents) != contents.size()
+            || !file.commit()) {
+        throw ErrorInfo(Tr::tr("Failure storing scan results in '%1': %2")
+                        .arg(m_filePath, file.errorString()));
+    }
+    m_generation = m_pendingGeneration;
+    m_storedPropertyMaps = m_pendingPropertyMaps;
+    m_dirty = false;
+}
+
 void RawScanResults::load(PersistentPool &pool)
 {
-    pool.load(m_rawScanData);
+    pool.load(m_generation);
+    pool.load(m_storedPropertyMaps);
+    m_rawScanData.clear();
+    m_dirty = false;
+    m_storedScanResults.reset();
+    m_storedScanResultsOpened = false;
+    m_pendingFileContents.clear();
 }
 
 void RawScanResults::store(PersistentPool &pool) const
 {
-    pool.store(m_rawScanData);
+    if (!m_pendingFileContents.isEmpty()) {
+        pool.store(m_pendingGeneration);
+        pool.store(m_pendingPropertyMaps);
+    } else {
+        pool.store(m_generation);
+        pool.store(m_storedPropertyMaps);
+    }
+}
+
+const RawScanResults::StoredScanResults *RawScanResults::storedScanResults()
+{
+    if (!m_storedScanResultsOpened) {
+        m_storedScanResultsOpened = true;
+        if (!m_filePath.isEmpty() && !m_generation.isEmpty())
+            m_storedScanResults = StoredScanResults::open(m_filePath, m_generation);
+    }
+    return m_storedScanResults.get();
+}
+
+QByteArray RawScanResults::fileContents(const QByteArray &generation,
+                                        std::vector<PropertyMapConstPtr> &propertyMaps)
+{
+    QHash<const PropertyMapInternal *, quint32> propertyMapIndices;
+    const auto propertyMapIndex = [&propertyMaps, &propertyMapIndices](
+            const PropertyMapConstPtr &propertyMap) {
+        if (!propertyMap)
+            return noPropertyMap;
+        const auto it = propertyMapIndices.constFind(propertyMap.get());
+        if (it != propertyMapIndices.constEnd())
+            return it.value();
+        const quint32 index = quint32(propertyMaps.size());
+        propertyMaps.push_back(propertyMap);
+        propertyMapIndices.insert(propertyMap.get(), index);
+        return index;
+    };
+
+    ScanResultsWriter writer;
+    for (auto it = m_rawScanData.cbegin(); it != m_rawScanData.cend(); ++it)
+        writer.addFile(it.key(), it.value(), propertyMapIndex);
+    if (const StoredScanResults * const stored = storedScanResults()) {
+        for (quint32 i = 0; i < stored->fileCount(); ++i) {
+            const QString filePath = stored->filePath(i);
+            if (!m_rawScanData.contains(filePath))
+                writer.addFile(filePath, stored->scanData(i, m_storedPropertyMaps),
+                               propertyMapIndex);
+        }
+    }
+    return writer.contents(generation);
 }
 
 } // namespace Internal
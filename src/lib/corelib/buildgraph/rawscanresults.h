@@ -46,9 +46,11 @@
 #include <language/forward_decls.h>
 #include <tools/filetime.h>
 
+#include <QtCore/qbytearray.h>
 #include <QtCore/qhash.h>
 #include <QtCore/qstring.h>
 
+#include <memory>
 #include <vector>
 
 namespace qbs {
@@ -67,6 +69,11 @@ public:
     void store(PersistentPool &pool) const;
 };
 
+// The scan results are not part of the build graph file, but live in a separate file that
+// gets memory-mapped on first access. Results for a file are only deserialized when they are
+// looked up, so a build that does not need to scan anything does not pay for them.
+// Storing happens in two steps: prepareStore() assembles the new file if results have changed,
+// and writeFile() replaces the file once the build graph referring to it has been written.
 class RawScanResults
 {
 public:
@@ -86,11 +93,39 @@ public:
             const DependencyScanner *scanner,
             const PropertyMapConstPtr &moduleProperties);
 
+    // Must be called by everyone who modifies the data returned by findScanData().
+    void setDirty() { m_dirty = true; }
+
+    static QString deriveFilePath(const QString &buildGraphFilePath);
+    void setFilePath(const QString &filePath) { m_filePath = filePath; }
+
+    void prepareStore();
+    void writeFile();
+
     void load(PersistentPool &pool);
     void store(PersistentPool &pool) const;
 
 private:
+    class StoredScanResults;
+
+    const StoredScanResults *storedScanResults();
+    QByteArray fileContents(const QByteArray &generation,
+                            std::vector<PropertyMapConstPtr> &propertyMaps);
+
+    // Contains all results that were created or looked up since the file was loaded.
     QHash<QString, std::vector<ScanData>> m_rawScanData;
+    bool m_dirty = false;
+
+    QString m_filePath;
+    QByteArray m_generation;
+    std::vector<PropertyMapConstPtr> m_storedPropertyMaps;
+    std::shared_ptr<const StoredScanResults> m_storedScanResults;
+    bool m_storedScanResultsOpened = false;
+
+    // Set up by prepareStore() and consumed by writeFile().
+    QByteArray m_pendingGeneration;
+    std::vector<PropertyMapConstPtr> m_pendingPropertyMaps;
+    QByteArray m_pendingFileContents;
 };
 
 } // namespace Internal
@@ -46,11 +46,15 @@
 #include <tools/qbsassert.h>
 #include <tools/stringconstants.h>
 
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
 #include <QtCore/qfile.h>
 
 #include <QtScript/qscriptengine.h>
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -89,7 +93,8 @@ AbstractCommand::AbstractCommand()
       m_extendedDescription(defaultExtendedDescription()),
       m_highlight(defaultHighLight()),
       m_ignoreDryRun(defaultIgnoreDryRun()),
-      m_silent(defaultIsSilent())
+      m_silent(defaultIsSilent()),
+      m_jobPool(defaultJobPool())
 {
 }
 
@@ -99,6 +104,7 @@ AbstractCommand::~AbstractCommand()
 
 bool AbstractCommand::equals(const AbstractCommand *other) const
 {
+    // The job pool only affects scheduling, so it does not take part in the comparison.
     return type() == other->type()
             && m_description == other->m_description
             && m_extendedDescription == other->m_extendedDescription
@@ -115,6 +121,7 @@ void AbstractCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
     m_highlight = scriptValue->property(highlightProperty()).toString();
     m_ignoreDryRun = scriptValue->property(ignoreDryRunProperty()).toBool();
     m_silent = scriptValue->property(silentProperty()).toBool();
+    m_jobPool = scriptValue->property(StringConstants::jobPoolProperty()).toString();
     m_codeLocation = codeLocation;
 
     m_predefinedProperties
@@ -122,6 +129,7 @@ void AbstractCommand::fillFromScriptValue(const QScriptValue *scriptValue, const
             << extendedDescriptionProperty()
             << highlightProperty()
             << ignoreDryRunProperty()
+            << StringConstants::jobPoolProperty()
             << silentProperty();
 }
 
@@ -132,6 +140,7 @@ void AbstractCommand::load(PersistentPool &pool)
     pool.load(m_highlight);
     pool.load(m_ignoreDryRun);
     pool.load(m_silent);
+    pool.load(m_jobPool);
     pool.load(m_codeLocation);
     pool.load(m_properties);
 }
@@ -143,10 +152,57 @@ void AbstractCommand::store(PersistentPool &pool) const
     pool.store(m_highlight);
     pool.store(m_ignoreDryRun);
     pool.store(m_silent);
+    pool.store(m_jobPool);
     pool.store(m_codeLocation);
     pool.store(m_properties);
 }
 
+static QString filtered(const QString &str, const FingerprintStringFilter &filter)
+{
+    return filter ? filter(str) : str;
+}
+
+static QStringList filtered(QStringList list, const FingerprintStringFilter &filter)
+{
+    if (filter)
+        std::transform(list.begin(), list.end(), list.begin(), filter);
+    return list;
+}
+
+QVariant filteredForFingerprint(const QVariant &value, const FingerprintStringFilter &filter)
+{
+    if (!filter)
+        return value;
+    switch (static_cast<QMetaType::Type>(value.type())) {
+    case QMetaType::QString:
+        return filter(value.toString());
+    case QMetaType::QStringList:
+        return filtered(value.toStringList(), filter);
+    case QMetaType::QVariantList: {
+        QVariantList list = value.toList();
+        for (QVariant &v : list)
+            v = filteredForFingerprint(v, filter);
+        return list;
+    }
+    case QMetaType::QVariantMap: {
+        QVariantMap map = value.toMap();
+        for (auto it = map.begin(); it != map.end(); ++it)
+            it.value() = filteredForFingerprint(it.value(), filter);
+        return map;
+    }
+    default:
+        return value;
+    }
+}
+
+void AbstractCommand::addToFingerprint(QDataStream &stream,
+                                       const FingerprintStringFilter &filter) const
+{
+    stream << static_cast<quint8>(type()) << filtered(m_description, filter)
+           << filtered(m_extendedDescription, filter) << m_highlight << m_ignoreDryRun
+           << m_silent << filteredForFingerprint(m_properties, filter);
+}
+
 void AbstractCommand::applyCommandProperties(const QScriptValue *scriptValue)
 {
     QScriptValueIterator it(*scriptValue);
@@ -177,6 +233,8 @@ static QScriptValue js_CommandBase(QScriptContext *context, QScriptEngine *engin
                     engine->toScriptValue(AbstractCommand::defaultIgnoreDryRun()));
     cmd.setProperty(silentProperty(),
                     engine->toScriptValue(AbstractCommand::defaultIsSilent()));
+    cmd.setProperty(StringConstants::jobPoolProperty(),
+                    engine->toScriptValue(AbstractCommand::defaultJobPool()));
     return cmd;
 }
 
@@ -372,6 +430,19 @@ void ProcessCommand::store(PersistentPool &pool) const
     pool.store(m_stderrFilePath);
 }
 
+void ProcessCommand::addToFingerprint(QDataStream &stream,
+                                      const FingerprintStringFilter &filter) const
+{
+    AbstractCommand::addToFingerprint(stream, filter);
+    QStringList environment = filtered(m_environment.toStringList(), filter);
+    environment.sort();
+    stream << filtered(m_program, filter) << filtered(m_arguments, filter)
+           << filtered(m_workingDir, filter) << m_maxExitCode << m_stdoutFilterFunction
+           << m_stderrFilterFunction << m_responseFileThreshold << m_responseFileArgumentIndex
+           << m_responseFileUsagePrefix << filtered(m_stdoutFilePath, filter)
+           << filtered(m_stderrFilePath, filter) << m_relevantEnvVars << environment;
+}
+
 static QString currentImportScopeName(QScriptContext *context)
 {
     for (; context; context = context->parentContext()) {
@@ -455,6 +526,13 @@ void JavaScriptCommand::store(PersistentPool &pool) const
     pool.store(m_sourceCode);
 }
 
+void JavaScriptCommand::addToFingerprint(QDataStream &stream,
+                                         const FingerprintStringFilter &filter) const
+{
+    AbstractCommand::addToFingerprint(stream, filter);
+    stream << m_sourceCode;
+}
+
 QList<AbstractCommandPtr> loadCommandList(PersistentPool &pool)
 {
     QList<AbstractCommandPtr> commands;
@@ -497,5 +575,15 @@ bool commandListsAreEqual(const QList<AbstractCommandPtr> &l1, const QList<Abstr
     return true;
 }
 
+QByteArray commandListHash(const QList<AbstractCommandPtr> &commands,
+                           const FingerprintStringFilter &filter)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    for (const AbstractCommandPtr &cmd : commands)
+        cmd->addToFingerprint(stream, filter);
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
 } // namespace Internal
 } // namespace qbs
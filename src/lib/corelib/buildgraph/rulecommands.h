@@ -51,9 +51,21 @@
 
 #include <QtScript/qscriptvalue.h>
 
+#include <functional>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
 namespace qbs {
 namespace Internal {
 
+// Applied to all strings that go into a command fingerprint, e.g. to normalize file paths.
+using FingerprintStringFilter = std::function<QString(const QString &)>;
+
+// Applies the filter to all strings contained in the value, recursing into lists and maps.
+QVariant filteredForFingerprint(const QVariant &value, const FingerprintStringFilter &filter);
+
 class AbstractCommand
 {
 public:
@@ -69,6 +81,7 @@ public:
     static QString defaultHighLight() { return QString(); }
     static bool defaultIgnoreDryRun() { return false; }
     static bool defaultIsSilent() { return false; }
+    static QString defaultJobPool() { return QString(); }
 
     virtual CommandType type() const = 0;
     virtual bool equals(const AbstractCommand *other) const;
@@ -79,6 +92,7 @@ public:
     const QString highlight() const { return m_highlight; }
     bool ignoreDryRun() const { return m_ignoreDryRun; }
     bool isSilent() const { return m_silent; }
+    QString jobPool() const { return m_jobPool; }
     CodeLocation codeLocation() const { return m_codeLocation; }
 
     const QVariantMap &properties() const { return m_properties; }
@@ -86,6 +100,10 @@ public:
     virtual void load(PersistentPool &pool);
     virtual void store(PersistentPool &pool) const;
 
+    // Writes the data that is relevant for equals().
+    virtual void addToFingerprint(QDataStream &stream,
+                                  const FingerprintStringFilter &filter) const;
+
 protected:
     AbstractCommand();
     void applyCommandProperties(const QScriptValue *scriptValue);
@@ -98,6 +116,7 @@ private:
     QString m_highlight;
     bool m_ignoreDryRun;
     bool m_silent;
+    QString m_jobPool;
     CodeLocation m_codeLocation;
     QVariantMap m_properties;
 };
@@ -127,6 +146,8 @@ public:
 
     void load(PersistentPool &pool);
     void store(PersistentPool &pool) const;
+    void addToFingerprint(QDataStream &stream,
+                          const FingerprintStringFilter &filter) const override;
 
 private:
     ProcessCommand();
@@ -166,6 +187,8 @@ public:
 
     void load(PersistentPool &pool);
     void store(PersistentPool &pool) const;
+    void addToFingerprint(QDataStream &stream,
+                          const FingerprintStringFilter &filter) const override;
 
 private:
     JavaScriptCommand();
@@ -179,6 +202,10 @@ void storeCommandList(const QList<AbstractCommandPtr> &commands, PersistentPool
 
 bool commandListsAreEqual(const QList<AbstractCommandPtr> &l1, const QList<AbstractCommandPtr> &l2);
 
+// Command lists for which commandListsAreEqual() returns true have the same hash.
+QByteArray commandListHash(const QList<AbstractCommandPtr> &commands,
+                           const FingerprintStringFilter &filter = FingerprintStringFilter());
+
 } // namespace Internal
 } // namespace qbs
 
@@ -129,13 +129,15 @@ void RuleNode::apply(const Logger &logger, const ArtifactSet &changedInputs,
                 outputArtifactsToRemove += parent;
             }
         }
-        RulesApplicator::handleRemovedRuleOutputs(inputs, outputArtifactsToRemove, logger);
+        RulesApplicator::handleRemovedRuleOutputs(inputs, outputArtifactsToRemove, logger,
+                                                  &result->removedNodes);
     }
     if (!inputs.empty() || !m_rule->declaresInputs() || !m_rule->requiresInputs) {
         RulesApplicator applicator(product.lock(), logger);
         applicator.applyRule(m_rule, inputs);
         result->createdNodes = applicator.createdArtifacts();
         result->invalidatedNodes = applicator.invalidatedArtifacts();
+        result->removedNodes.unite(applicator.removedArtifacts());
         m_oldInputArtifacts.unite(inputs);
     }
 }
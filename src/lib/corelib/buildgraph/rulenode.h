@@ -69,6 +69,7 @@ public:
         bool upToDate;
         NodeSet createdNodes;
         NodeSet invalidatedNodes;
+        NodeSet removedNodes; // Already deleted, so only good for bookkeeping.
     };
 
     void apply(const Logger &logger, const ArtifactSet &changedInputs, ApplicationResult *result);
@@ -58,14 +58,19 @@
 #include <logging/translator.h>
 #include <tools/error.h>
 #include <tools/fileinfo.h>
+#include <tools/profiling.h>
 #include <tools/scripttools.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
 #include <tools/stringconstants.h>
 
 #include <QtCore/qdir.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
 #include <QtScript/qscriptvalueiterator.h>
 
+#include <algorithm>
+#include <functional>
 #include <memory>
 #include <vector>
 
@@ -89,8 +94,12 @@ void RulesApplicator::applyRule(const RuleConstPtr &rule, const ArtifactSet &inp
     if (inputArtifacts.empty() && rule->declaresInputs() && rule->requiresInputs)
         return;
 
+    const TraceEvent traceEvent("rule", TraceRecorder::instance().isRecording()
+                                ? m_product->name + QLatin1Char(' ') + rule->toString()
+                                : QString());
     m_createdArtifacts.clear();
     m_invalidatedArtifacts.clear();
+    m_removedArtifacts.clear();
     RulesEvaluationContext::Scope s(evalContext().get());
 
     m_rule = rule;
@@ -110,16 +119,25 @@ void RulesApplicator::applyRule(const RuleConstPtr &rule, const ArtifactSet &inp
     if (m_rule->multiplex) { // apply the rule once for a set of inputs
         doApply(inputArtifacts, prepareScriptContext);
     } else { // apply the rule once for each input
+        // The prepare scripts of the individual applications are independent of each other,
+        // so they get run on several threads once all the output artifacts exist.
+        const bool prepareConcurrently = !m_mocScanner && evalContext()->maxThreadCount() > 1
+                && inputArtifacts.size() >= 2 * minInputsPerPrepareThread;
+        std::vector<TransformerPtr> pendingTransformers;
         for (Artifact * const inputArtifact : inputArtifacts) {
             ArtifactSet lst;
             lst += inputArtifact;
-            doApply(lst, prepareScriptContext);
+            doApply(lst, prepareScriptContext,
+                    prepareConcurrently ? &pendingTransformers : nullptr);
         }
+        if (!pendingTransformers.empty())
+            createCommandsConcurrently(pendingTransformers);
     }
 }
 
 void RulesApplicator::handleRemovedRuleOutputs(const ArtifactSet &inputArtifacts,
-        const ArtifactSet &outputArtifactsToRemove, const Logger &logger)
+        const ArtifactSet &outputArtifactsToRemove, const Logger &logger,
+        NodeSet *removedArtifacts)
 {
     ArtifactSet artifactsToRemove;
     const TopLevelProject *project = nullptr;
@@ -139,10 +157,15 @@ void RulesApplicator::handleRemovedRuleOutputs(const ArtifactSet &inputArtifacts
     EmptyDirectoriesRemover(project, logger).removeEmptyParentDirectories(artifactsToRemove);
     for (Artifact * const artifact : qAsConst(artifactsToRemove)) {
         QBS_CHECK(!inputArtifacts.contains(artifact));
+        removedArtifacts->insert(artifact);
         delete artifact;
     }
 }
 
+// Every thread first has to set up its script engine for the rule's file and product,
+// which only pays off if it then runs the prepare script for a number of inputs.
+static const size_t minInputsPerPrepareThread = 8;
+
 static void copyProperty(const QString &name, const QScriptValue &src, QScriptValue dst)
 {
     dst.setProperty(name, src.property(name));
@@ -159,7 +182,8 @@ static QStringList toStringList(const ArtifactSet &artifacts)
     return lst;
 }
 
-void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &prepareScriptContext)
+void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &prepareScriptContext,
+                              std::vector<TransformerPtr> *pendingTransformers)
 {
     evalContext()->checkForCancelation();
 
@@ -188,7 +212,8 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
                     ScriptEngine::argumentList(Rule::argumentNamesForOutputArtifacts(), scope()));
         ArtifactSet newOutputs = ArtifactSet::fromList(outputArtifacts);
         const ArtifactSet oldOutputs = collectOldOutputArtifacts(inputArtifacts);
-        handleRemovedRuleOutputs(m_completeInputSet, oldOutputs - newOutputs, m_logger);
+        handleRemovedRuleOutputs(m_completeInputSet, oldOutputs - newOutputs, m_logger,
+                                 &m_removedArtifacts);
     } else {
         Set<QString> outputFilePaths;
         for (const RuleArtifactConstPtr &ruleArtifact : qAsConst(m_rule->artifacts)) {
@@ -226,7 +251,6 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
 
         // expose attributes of this artifact
         Artifact *outputArtifact = it->second;
-        outputArtifact->properties = outputArtifact->properties->clone();
 
         scope().setProperty(StringConstants::fileNameProperty(),
                             engine()->toScriptValue(outputArtifact->filePath()));
@@ -235,7 +259,7 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
 
         QVariantMap artifactModulesCfg = outputArtifact->properties->value();
         for (const auto &binding : ra->bindings) {
-            scriptValue = engine()->evaluate(binding.code);
+            scriptValue = engine()->evaluateCachedProgram(binding.code);
             if (Q_UNLIKELY(engine()->hasErrorOrException(scriptValue))) {
                 QString msg = QLatin1String("evaluating rule binding '%1': %2");
                 throw ErrorInfo(msg.arg(binding.name.join(QLatin1Char('.')),
@@ -244,19 +268,107 @@ void RulesApplicator::doApply(const ArtifactSet &inputArtifacts, QScriptValue &p
             }
             setConfigProperty(artifactModulesCfg, binding.name, scriptValue.toVariant());
         }
-        outputArtifact->properties->setValue(artifactModulesCfg);
+        outputArtifact->properties = PropertyMapInternal::create(artifactModulesCfg);
     }
     if (!ruleArtifactArtifactMap.empty())
         engine()->setGlobalObject(prepareScriptContext.prototype());
 
+    if (pendingTransformers) {
+        pendingTransformers->push_back(m_transformer);
+        return;
+    }
+
     m_transformer->setupOutputs(prepareScriptContext);
     m_transformer->createCommands(engine(), m_rule->prepareScript,
             ScriptEngine::argumentList(Rule::argumentNamesForPrepare(), prepareScriptContext));
-    if (Q_UNLIKELY(m_transformer->commands.empty()))
+    if (Q_UNLIKELY(m_transformer->commands().empty()))
         throw ErrorInfo(Tr::tr("There is a rule without commands: %1.")
                         .arg(m_rule->toString()), m_rule->prepareScript.location());
 }
 
+namespace {
+class PrepareScriptRunnable : public QRunnable
+{
+public:
+    PrepareScriptRunnable(const std::function<void()> &prepare) : m_prepare(prepare) {}
+
+private:
+    void run() override { m_prepare(); }
+
+    const std::function<void()> m_prepare;
+};
+} // namespace
+
+// The build graph is not touched while the threads are running; they only read from it and
+// fill in the commands of their respective transformers. Every thread uses the evaluation
+// context of its own and evaluates the prepare script once for all of its transformers.
+void RulesApplicator::createCommandsConcurrently(const std::vector<TransformerPtr> &transformers)
+{
+    RulesEvaluationContext * const mainContext = evalContext().get();
+    QThreadPool * const threadPool = mainContext->threadPool();
+    const size_t threadCount = std::max<size_t>(1, std::min<size_t>(
+            mainContext->maxThreadCount(), transformers.size() / minInputsPerPrepareThread));
+    const size_t chunkSize = (transformers.size() + threadCount - 1) / threadCount;
+    const QStringList argumentNames = Rule::argumentNamesForPrepare();
+    const PrivateScriptFunction &script = m_rule->prepareScript;
+    std::vector<ErrorInfo> errors(transformers.size());
+    const auto prepareChunk = [&](size_t begin, size_t end) {
+        RulesEvaluationContext * const context = mainContext->threadContext();
+        RulesEvaluationContext::Scope s(context);
+        ScriptEngine * const engine = context->engine();
+        QScriptValue prepareScriptContext = engine->newObject();
+        prepareScriptContext.setPrototype(engine->globalObject());
+        PrepareScriptObserver observer(engine, UnobserveMode::Enabled);
+        try {
+            setupScriptEngineForFile(engine, script.fileContext(), context->scope(),
+                                     ObserveMode::Enabled);
+            setupScriptEngineForProduct(engine, m_product.get(), m_rule->module.get(),
+                                        prepareScriptContext, &observer, true);
+            const QScriptValue function = engine->evaluate(script.sourceCode(),
+                                                           script.location().filePath(),
+                                                           script.location().line());
+            if (Q_UNLIKELY(!function.isFunction()))
+                throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
+            for (size_t i = begin; i < end; ++i) {
+                mainContext->checkForCancelation();
+                const TransformerPtr &transformer = transformers.at(i);
+                try {
+                    transformer->setupInputs(prepareScriptContext);
+                    transformer->setupOutputs(prepareScriptContext);
+                    transformer->setupExplicitlyDependsOn(prepareScriptContext);
+                    transformer->createCommands(engine, function, script.location(),
+                            ScriptEngine::argumentList(argumentNames, prepareScriptContext));
+                } catch (const ErrorInfo &e) {
+                    errors.at(i) = e;
+                }
+            }
+        } catch (const ErrorInfo &e) {
+            for (size_t i = begin; i < end; ++i)
+                errors.at(i) = e;
+        }
+    };
+
+    qCDebug(lcBuildGraph) << "running prepare scripts of rule" << m_rule->toString()
+                          << "for" << transformers.size() << "inputs in" << threadCount
+                          << "threads";
+    for (size_t begin = 0; begin < transformers.size(); begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, transformers.size());
+        threadPool->start(new PrepareScriptRunnable([&prepareChunk, begin, end] {
+            prepareChunk(begin, end);
+        }));
+    }
+    threadPool->waitForDone();
+    mainContext->checkForCancelation();
+
+    for (size_t i = 0; i < transformers.size(); ++i) {
+        if (Q_UNLIKELY(errors.at(i).hasError()))
+            throw errors.at(i);
+        if (Q_UNLIKELY(transformers.at(i)->commands().empty()))
+            throw ErrorInfo(Tr::tr("There is a rule without commands: %1.")
+                            .arg(m_rule->toString()), script.location());
+    }
+}
+
 ArtifactSet RulesApplicator::collectOldOutputArtifacts(const ArtifactSet &inputArtifacts) const
 {
     ArtifactSet result;
@@ -290,9 +402,9 @@ Artifact *RulesApplicator::createOutputArtifactFromRuleArtifact(
         const RuleArtifactConstPtr &ruleArtifact, const ArtifactSet &inputArtifacts,
         Set<QString> *outputFilePaths)
 {
-    QScriptValue scriptValue = engine()->evaluate(ruleArtifact->filePath,
-                                                  ruleArtifact->filePathLocation.filePath(),
-                                                  ruleArtifact->filePathLocation.line());
+    QScriptValue scriptValue = engine()->evaluateCachedProgram(
+                ruleArtifact->filePath, ruleArtifact->filePathLocation.filePath(),
+                ruleArtifact->filePathLocation.line());
     if (Q_UNLIKELY(engine()->hasErrorOrException(scriptValue)))
         throw engine()->lastError(scriptValue, ruleArtifact->filePathLocation);
     QString outputPath = FileInfo::resolvePath(m_product->buildDirectory(), scriptValue.toString());
@@ -404,12 +516,14 @@ QList<Artifact *> RulesApplicator::runOutputArtifactsScript(const ArtifactSet &i
         const QScriptValueList &args)
 {
     QList<Artifact *> lst;
-    QScriptValue fun = engine()->evaluate(m_rule->outputArtifactsScript.sourceCode(),
-                                          m_rule->outputArtifactsScript.location().filePath(),
-                                          m_rule->outputArtifactsScript.location().line());
-    if (!fun.isFunction())
-        throw ErrorInfo(QLatin1String("Function expected."),
-                        m_rule->outputArtifactsScript.location());
+    const PrivateScriptFunction &script = m_rule->outputArtifactsScript;
+    QScriptValue &fun = script.scriptFunction;
+    if (!fun.isValid() || fun.engine() != engine()) {
+        fun = engine()->evaluate(script.sourceCode(), script.location().filePath(),
+                                 script.location().line());
+        if (!fun.isFunction())
+            throw ErrorInfo(QLatin1String("Function expected."), script.location());
+    }
     QScriptValue res = fun.call(QScriptValue(), args);
     engine()->releaseResourcesOfScriptObjects();
     if (engine()->hasErrorOrException(res))
@@ -490,11 +604,10 @@ public:
         if (m_propertyValues.empty())
             return;
 
-        outputArtifact->properties = outputArtifact->properties->clone();
         QVariantMap artifactCfg = outputArtifact->properties->value();
         for (const auto &e : m_propertyValues)
             setConfigProperty(artifactCfg, {e.module, e.name}, e.value);
-        outputArtifact->properties->setValue(artifactCfg);
+        outputArtifact->properties = PropertyMapInternal::create(artifactCfg);
     }
 };
 
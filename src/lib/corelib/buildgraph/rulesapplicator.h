@@ -51,6 +51,8 @@
 
 #include <QtScript/qscriptvalue.h>
 
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 class BuildGraphNode;
@@ -65,13 +67,17 @@ public:
 
     const NodeSet &createdArtifacts() const { return m_createdArtifacts; }
     const NodeSet &invalidatedArtifacts() const { return m_invalidatedArtifacts; }
+    const NodeSet &removedArtifacts() const { return m_removedArtifacts; }
 
     void applyRule(const RuleConstPtr &rule, const ArtifactSet &inputArtifacts);
     static void handleRemovedRuleOutputs(const ArtifactSet &inputArtifacts,
-            const ArtifactSet &artifactsToRemove, const Logger &logger);
+            const ArtifactSet &artifactsToRemove, const Logger &logger,
+            NodeSet *removedArtifacts);
 
 private:
-    void doApply(const ArtifactSet &inputArtifacts, QScriptValue &prepareScriptContext);
+    void doApply(const ArtifactSet &inputArtifacts, QScriptValue &prepareScriptContext,
+                 std::vector<TransformerPtr> *pendingTransformers = nullptr);
+    void createCommandsConcurrently(const std::vector<TransformerPtr> &transformers);
     ArtifactSet collectOldOutputArtifacts(const ArtifactSet &inputArtifacts) const;
     ArtifactSet collectExplicitlyDependsOn();
     Artifact *createOutputArtifactFromRuleArtifact(const RuleArtifactConstPtr &ruleArtifact,
@@ -90,6 +96,7 @@ private:
     const ResolvedProductPtr m_product;
     NodeSet m_createdArtifacts;
     NodeSet m_invalidatedArtifacts;
+    NodeSet m_removedArtifacts;
     RuleConstPtr m_rule;
     ArtifactSet m_completeInputSet;
     TransformerPtr m_transformer;
@@ -48,8 +48,14 @@
 #include <tools/progressobserver.h>
 #include <tools/qbsassert.h>
 
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qthreadstorage.h>
+
 #include <QtCore/qvariant.h>
 
+#include <algorithm>
+
 namespace qbs {
 namespace Internal {
 
@@ -57,7 +63,8 @@ RulesEvaluationContext::RulesEvaluationContext(const Logger &logger)
     : m_logger(logger),
       m_engine(new ScriptEngine(m_logger, EvalContext::RuleExecution)),
       m_observer(nullptr),
-      m_initScopeCalls(0)
+      m_initScopeCalls(0),
+      m_maxThreadCount(QThread::idealThreadCount())
 {
     m_prepareScriptScope = m_engine->newObject();
     m_prepareScriptScope.setPrototype(m_engine->globalObject());
@@ -67,6 +74,7 @@ RulesEvaluationContext::RulesEvaluationContext(const Logger &logger)
 
 RulesEvaluationContext::~RulesEvaluationContext()
 {
+    m_threadPool.reset();
     delete m_engine;
 }
 
@@ -88,6 +96,44 @@ void RulesEvaluationContext::checkForCancelation()
         throw ErrorInfo(Tr::tr("Build canceled."));
 }
 
+// The contexts are deleted when their thread finishes, which happens when the pool goes away.
+static QThreadStorage<RulesEvaluationContext *> &threadContexts()
+{
+    static QThreadStorage<RulesEvaluationContext *> contexts;
+    return contexts;
+}
+
+void RulesEvaluationContext::setMaxThreadCount(int count)
+{
+    m_maxThreadCount = std::max(count, 1);
+    if (m_threadPool)
+        m_threadPool->setMaxThreadCount(m_maxThreadCount);
+}
+
+QThreadPool *RulesEvaluationContext::threadPool()
+{
+    if (!m_threadPool) {
+        m_threadPool.reset(new QThreadPool);
+        m_threadPool->setMaxThreadCount(m_maxThreadCount);
+        m_threadPool->setExpiryTimeout(-1);
+    }
+    return m_threadPool.get();
+}
+
+RulesEvaluationContext *RulesEvaluationContext::threadContext() const
+{
+    QThreadStorage<RulesEvaluationContext *> &contexts = threadContexts();
+    if (!contexts.hasLocalData())
+        contexts.setLocalData(new RulesEvaluationContext(m_logger));
+    return contexts.localData();
+}
+
+// Only the threads of the pool ever get a thread context.
+bool RulesEvaluationContext::isPoolThread()
+{
+    return threadContexts().hasLocalData();
+}
+
 void RulesEvaluationContext::initScope()
 {
     if (m_initScopeCalls++ > 0)
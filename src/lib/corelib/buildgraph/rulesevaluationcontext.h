@@ -48,6 +48,12 @@
 #include <QtScript/qscriptprogram.h>
 #include <QtScript/qscriptvalue.h>
 
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+class QThreadPool;
+QT_END_NAMESPACE
+
 namespace qbs {
 namespace Internal {
 class ProgressObserver;
@@ -78,6 +84,14 @@ public:
     void incrementProgressValue();
     void checkForCancelation();
 
+    // For evaluating scripts on several threads. Every thread of the pool has an evaluation
+    // context of its own, which it can get via threadContext().
+    void setMaxThreadCount(int count);
+    int maxThreadCount() const { return m_maxThreadCount; }
+    QThreadPool *threadPool();
+    RulesEvaluationContext *threadContext() const;
+    static bool isPoolThread();
+
 private:
     friend class Scope;
 
@@ -90,6 +104,8 @@ private:
     unsigned int m_initScopeCalls;
     QScriptValue m_scope;
     QScriptValue m_prepareScriptScope;
+    int m_maxThreadCount;
+    std::unique_ptr<QThreadPool> m_threadPool;
 };
 
 } // namespace Internal
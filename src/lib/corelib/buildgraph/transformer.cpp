@@ -39,7 +39,9 @@
 #include "transformer.h"
 
 #include "artifact.h"
+#include "productbuilddata.h"
 #include "rulecommands.h"
+#include "rulesevaluationcontext.h"
 #include <jsextensions/moduleproperties.h>
 #include <language/language.h>
 #include <language/scriptengine.h>
@@ -58,7 +60,8 @@
 namespace qbs {
 namespace Internal {
 
-Transformer::Transformer() : alwaysRun(false)
+Transformer::Transformer()
+    : alwaysRun(false), lastRunDuration(-1), m_commandsIndex(-1), m_commandsPending(false)
 {
 }
 
@@ -164,6 +167,38 @@ ResolvedProductPtr Transformer::product() const
     return (*outputs.cbegin())->product.lock();
 }
 
+const QList<AbstractCommandPtr> &Transformer::commands() const
+{
+    if (m_commandsPending) {
+        QBS_CHECK(!RulesEvaluationContext::isPoolThread());
+        m_commandsPending = false;
+        const ResolvedProductPtr p = product();
+        QBS_CHECK(p && p->buildData);
+        m_commands = p->buildData->takeStoredCommands(m_commandsIndex);
+    }
+    return m_commands;
+}
+
+void Transformer::setCommands(const QList<AbstractCommandPtr> &commands)
+{
+    m_commands = commands;
+    m_commandsPending = false;
+    updateJobPools();
+}
+
+void Transformer::updateJobPools()
+{
+    m_jobPools.clear();
+    for (const AbstractCommandPtr &command : qAsConst(m_commands)) {
+        const QString jobPool = !command->jobPool().isEmpty() || !rule
+                ? command->jobPool() : rule->jobPool;
+        if (!jobPool.isEmpty() && std::find(m_jobPools.cbegin(), m_jobPools.cend(),
+                                            jobPool) == m_jobPools.cend()) {
+            m_jobPools.push_back(jobPool);
+        }
+    }
+}
+
 void Transformer::setupInputs(QScriptValue targetScriptValue, const ArtifactSet &inputs,
         const QString &defaultModuleName)
 {
@@ -237,33 +272,40 @@ void Transformer::createCommands(ScriptEngine *engine, const PrivateScriptFuncti
         if (Q_UNLIKELY(!script.scriptFunction.isFunction()))
             throw ErrorInfo(Tr::tr("Invalid prepare script."), script.location());
     }
+    createCommands(engine, script.scriptFunction, script.location(), args);
+}
 
-    QScriptValue scriptValue = script.scriptFunction.call(QScriptValue(), args);
+void Transformer::createCommands(ScriptEngine *engine, const QScriptValue &prepareFunction,
+                                 const CodeLocation &location, const QScriptValueList &args)
+{
+    QScriptValue scriptValue = prepareFunction.call(QScriptValue(), args);
     engine->releaseResourcesOfScriptObjects();
     propertiesRequestedInPrepareScript = engine->propertiesRequestedInScript();
     propertiesRequestedFromArtifactInPrepareScript = engine->propertiesRequestedFromArtifact();
     importedFilesUsedInPrepareScript = engine->importedFilesUsedInScript();
     engine->clearRequestedProperties();
     if (Q_UNLIKELY(engine->hasErrorOrException(scriptValue)))
-        throw engine->lastError(scriptValue, script.location());
-    commands.clear();
+        throw engine->lastError(scriptValue, location);
+    m_commands.clear();
+    m_commandsPending = false;
     if (scriptValue.isArray()) {
         const int count = scriptValue.property(StringConstants::lengthProperty()).toInt32();
         for (qint32 i = 0; i < count; ++i) {
             QScriptValue item = scriptValue.property(i);
             if (item.isValid() && !item.isUndefined()) {
                 const AbstractCommandPtr cmd
-                        = createCommandFromScriptValue(item, script.location());
+                        = createCommandFromScriptValue(item, location);
                 if (cmd)
-                    commands.push_back(cmd);
+                    m_commands.push_back(cmd);
             }
         }
     } else {
         const AbstractCommandPtr cmd = createCommandFromScriptValue(scriptValue,
-                                                                    script.location());
+                                                                    location);
         if (cmd)
-            commands.push_back(cmd);
+            m_commands.push_back(cmd);
     }
+    updateJobPools();
 }
 
 void Transformer::rescueChangeTrackingData(const TransformerConstPtr &other)
@@ -291,8 +333,12 @@ void Transformer::load(PersistentPool &pool)
     pool.load(propertiesRequestedFromArtifactInCommands);
     pool.load(importedFilesUsedInPrepareScript);
     pool.load(importedFilesUsedInCommands);
-    commands = loadCommandList(pool);
+    pool.load(m_commandsIndex);
+    m_commands.clear();
+    m_commandsPending = m_commandsIndex != -1;
+    pool.load(m_jobPools);
     pool.load(alwaysRun);
+    pool.load(lastRunDuration);
 }
 
 void Transformer::store(PersistentPool &pool) const
@@ -307,8 +353,10 @@ void Transformer::store(PersistentPool &pool) const
     pool.store(propertiesRequestedFromArtifactInCommands);
     pool.store(importedFilesUsedInPrepareScript);
     pool.store(importedFilesUsedInCommands);
-    storeCommandList(commands, pool);
+    pool.store(m_commandsIndex);
+    pool.store(m_jobPools);
     pool.store(alwaysRun);
+    pool.store(lastRunDuration);
 }
 
 } // namespace Internal
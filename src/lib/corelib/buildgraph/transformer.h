@@ -65,7 +65,6 @@ public:
     ArtifactSet outputs;
     ArtifactSet explicitlyDependsOn;
     RuleConstPtr rule;
-    QList<AbstractCommandPtr> commands;
     PropertySet propertiesRequestedInPrepareScript;
     PropertySet propertiesRequestedInCommands;
     QHash<QString, PropertySet> propertiesRequestedFromArtifactInPrepareScript;
@@ -73,16 +72,30 @@ public:
     std::vector<QString> importedFilesUsedInPrepareScript;
     std::vector<QString> importedFilesUsedInCommands;
     bool alwaysRun;
+    qint64 lastRunDuration; // In milliseconds. Used by the executor for scheduling.
 
     static QScriptValue translateFileConfig(ScriptEngine *scriptEngine,
                                             const Artifact *artifact,
                                             const QString &defaultModuleName);
     ResolvedProductPtr product() const;
+
+    // For transformers restored from disk, the commands get deserialized on first access.
+    // As this modifies the product's build data, it must not happen concurrently, so the
+    // prepare script threads are only allowed to access their own transformers' commands,
+    // which they set up from scratch anyway.
+    const QList<AbstractCommandPtr> &commands() const;
+    void setCommands(const QList<AbstractCommandPtr> &commands);
+
+    // The job pools of the commands, which the executor needs for scheduling. They are
+    // kept separately, so that looking them up does not require deserializing the commands.
+    const std::vector<QString> &jobPools() const { return m_jobPools; }
     void setupInputs(QScriptValue targetScriptValue);
     void setupOutputs(QScriptValue targetScriptValue);
     void setupExplicitlyDependsOn(QScriptValue targetScriptValue);
     void createCommands(ScriptEngine *engine, const PrivateScriptFunction &script,
                         const QScriptValueList &args);
+    void createCommands(ScriptEngine *engine, const QScriptValue &prepareFunction,
+                        const CodeLocation &location, const QScriptValueList &args);
     void rescueChangeTrackingData(const TransformerConstPtr &other);
 
     void load(PersistentPool &pool);
@@ -96,6 +109,15 @@ private:
     static QScriptValue translateInOutputs(ScriptEngine *scriptEngine,
                                            const ArtifactSet &artifacts,
                                            const QString &defaultModuleName);
+
+    void updateJobPools();
+
+    friend class ProductBuildData;
+
+    mutable QList<AbstractCommandPtr> m_commands;
+    int m_commandsIndex; // Position in the product's serialized command lists.
+    mutable bool m_commandsPending;
+    std::vector<QString> m_jobPools;
 };
 
 } // namespace Internal
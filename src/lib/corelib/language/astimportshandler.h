@@ -40,8 +40,8 @@
 #define QBS_ASTIMPORTSHANDLER_H
 
 #include "forward_decls.h"
+#include "parsedfile.h"
 
-#include <parser/qmljsastfwd_p.h>
 #include <tools/set.h>
 
 #include <QtCore/qhash.h>
@@ -62,7 +62,7 @@ public:
     ASTImportsHandler(ItemReaderVisitorState &visitorState, Logger &logger,
                       const FileContextPtr &file);
 
-    void handleImports(const QbsQmlJS::AST::UiImportList *uiImportList);
+    void handleImports(const std::vector<ParsedFile::Import> &imports);
 
     QHash<QStringList, QString> typeNameFileMap() const { return m_typeNameToFile; }
 
@@ -71,11 +71,11 @@ private:
 
     bool addPrototype(const QString &fileName, const QString &filePath, const QString &as,
                       bool needsCheck);
-    void checkImportVersion(const QbsQmlJS::AST::SourceLocation &versionToken) const;
+    void checkImportVersion(const ParsedFile::SourceLocation &versionToken) const;
     void collectPrototypes(const QString &path, const QString &as);
     void collectPrototypesAndJsCollections(const QString &path, const QString &as,
                                            const CodeLocation &location);
-    void handleImport(const QbsQmlJS::AST::UiImport *import);
+    void handleImport(const ParsedFile::Import &import);
 
     ItemReaderVisitorState &m_visitorState;
     Logger &m_logger;
@@ -475,6 +475,7 @@ void BuiltinDeclarations::addRuleItem()
                                 StringConstants::falseValue());
     item << PropertyDeclaration(StringConstants::requiresInputsProperty(),
                                 PropertyDeclaration::Boolean);
+    item << PropertyDeclaration(StringConstants::jobPoolProperty(), PropertyDeclaration::String);
     item << nameProperty();
     item << PropertyDeclaration(StringConstants::inputsProperty(), PropertyDeclaration::StringList);
     item << PropertyDeclaration(StringConstants::outputFileTagsProperty(),
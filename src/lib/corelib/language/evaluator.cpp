@@ -225,6 +225,21 @@ void Evaluator::clearPathPropertiesBaseDir()
     m_scriptClass->clearPathPropertiesBaseDir();
 }
 
+void Evaluator::setPendingItemHandler(const std::function<void(const Item *)> &handler)
+{
+    m_scriptClass->setPendingItemHandler(handler);
+}
+
+void Evaluator::addPendingItem(const Item *item)
+{
+    m_scriptClass->addPendingItem(item);
+}
+
+void Evaluator::clearPendingItems()
+{
+    m_scriptClass->clearPendingItems();
+}
+
 bool Evaluator::evaluateProperty(QScriptValue *result, const Item *item, const QString &name,
         bool *propertyWasSet)
 {
@@ -48,6 +48,8 @@
 
 #include <QtScript/qscriptvalue.h>
 
+#include <functional>
+
 namespace qbs {
 namespace Internal {
 class EvaluatorScriptClass;
@@ -101,6 +103,13 @@ public:
     void setPathPropertiesBaseDir(const QString &dirPath);
     void clearPathPropertiesBaseDir();
 
+    // Pending items are items whose property values are still being computed elsewhere.
+    // The handler is called before the first property lookup on such an item; it must
+    // set the final values.
+    void setPendingItemHandler(const std::function<void(const Item *)> &handler);
+    void addPendingItem(const Item *item);
+    void clearPendingItems();
+
 private:
     void onItemPropertyChanged(Item *item);
     bool evaluateProperty(QScriptValue *result, const Item *item, const QString &name,
@@ -367,6 +367,10 @@ QScriptClass::QueryFlags EvaluatorScriptClass::queryProperty(const QScriptValue
         return QScriptClass::QueryFlags();
     }
 
+    // The values of a pending item must be filled in before we can look at them.
+    if (!m_pendingItems.empty() && m_pendingItems.remove(data->item))
+        m_pendingItemHandler(data->item);
+
     return queryItemProperty(data, nameString);
 }
 
@@ -571,12 +575,63 @@ void EvaluatorScriptClass::convertToPropertyType(const Item *item, const Propert
     convertToPropertyType_impl(m_pathPropertiesBaseDir, item, decl, value->location(), v);
 }
 
+// Only values that are defined in the module prototype itself and that do not depend on
+// values from other places are candidates for memoization.
+static bool isProductIndependentCandidate(const Item *itemOfProperty, const Value *value,
+                                          bool foundInParent)
+{
+    if (foundInParent || itemOfProperty->type() != ItemType::Module
+            || value->type() != Value::JSSourceValueType || value->next()
+            || value->definingItem()) {
+        return false;
+    }
+    const auto sourceValue = static_cast<const JSSourceValue *>(value);
+    return !sourceValue->sourceUsesBase() && !sourceValue->sourceUsesOuter()
+            && !sourceValue->sourceUsesOriginal() && sourceValue->alternatives().empty();
+}
+
+static const Value *lookupValue(const Item *item, const QString &name)
+{
+    for (; item; item = item->prototype()) {
+        const ValuePtr value = item->ownProperty(name);
+        if (value)
+            return value.get();
+    }
+    return nullptr;
+}
+
+// Memoized values are handed out to several products, so they must not be objects
+// that could be modified by the receiver. Arrays of primitive values are copied.
+static bool isMemoizableResult(const QScriptValue &value)
+{
+    if (!value.isArray())
+        return !value.isObject() && value.isValid();
+    const quint32 length = value.property(StringConstants::lengthProperty()).toUInt32();
+    for (quint32 i = 0; i < length; ++i) {
+        if (value.property(i).isObject())
+            return false;
+    }
+    return true;
+}
+
+static QScriptValue copiedValue(QScriptEngine *engine, const QScriptValue &value)
+{
+    if (!value.isArray())
+        return value;
+    const quint32 length = value.property(StringConstants::lengthProperty()).toUInt32();
+    QScriptValue copy = engine->newArray(length);
+    for (quint32 i = 0; i < length; ++i)
+        copy.setProperty(i, value.property(i));
+    return copy;
+}
+
 class PropertyStackManager
 {
 public:
     PropertyStackManager(const Item *itemOfProperty, const QScriptString &name, const Value *value,
                          std::stack<QualifiedId> &requestedProperties,
-                         PropertyDependencies &propertyDependencies)
+                         PropertyDependencies &propertyDependencies,
+                         std::vector<std::pair<QualifiedId, QualifiedId>> *recordedDependencies)
         : m_requestedProperties(requestedProperties)
     {
         if (value->type() == Value::JSSourceValueType
@@ -589,8 +644,11 @@ public:
             m_stackUpdate = true;
             const QualifiedId fullPropName
                     = QualifiedId::fromString(varValue->value().toString()) << name.toString();
-            if (!requestedProperties.empty())
+            if (!requestedProperties.empty()) {
                 propertyDependencies[fullPropName].insert(requestedProperties.top());
+                if (recordedDependencies)
+                    recordedDependencies->emplace_back(fullPropName, requestedProperties.top());
+            }
             m_requestedProperties.push(fullPropName);
         }
     }
@@ -606,6 +664,35 @@ private:
     bool m_stackUpdate = false;
 };
 
+// Makes sure the frame is removed again if the evaluation throws.
+class EvaluatorScriptClass::MemoizationFrameGuard
+{
+public:
+    MemoizationFrameGuard(std::vector<MemoizationFrame> &frames, const Item *item)
+        : m_frames(frames)
+    {
+        m_frames.emplace_back(item);
+    }
+
+    ~MemoizationFrameGuard()
+    {
+        if (m_active)
+            m_frames.pop_back();
+    }
+
+    MemoizationFrame take()
+    {
+        MemoizationFrame frame = std::move(m_frames.back());
+        m_frames.pop_back();
+        m_active = false;
+        return frame;
+    }
+
+private:
+    std::vector<MemoizationFrame> &m_frames;
+    bool m_active = true;
+};
+
 QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QScriptString &name,
                                             uint id)
 {
@@ -619,6 +706,7 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
 
     const auto qpt = static_cast<QueryPropertyType>(id);
     if (qpt == QPTParentProperty) {
+        markProductDependent();
         return data->item->parent()
                 ? data->evaluator->scriptValue(data->item->parent())
                 : engine()->undefinedValue();
@@ -633,7 +721,19 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
         qDebug() << "[SC] property " << name;
 
     PropertyStackManager propStackmanager(itemOfProperty, name, value.get(),
-                                          m_requestedProperties, m_propertyDependencies);
+            m_requestedProperties, m_propertyDependencies,
+            m_memoizationFrames.empty() ? nullptr : &m_memoizationFrames.back().dependencies);
+
+    // Module property values are memoized across products if their evaluation reads nothing
+    // but other such values of the same module instance. The reads are tracked in a stack
+    // of frames, one for each evaluation of a candidate value that is in progress.
+    const bool isMemoizationCandidate = m_valueCacheEnabled
+            && isProductIndependentCandidate(itemOfProperty, value.get(), foundInParent)
+            && (m_memoizationFrames.empty() || m_memoizationFrames.back().item == data->item);
+    const MemoizedValue * const memoized = isMemoizationCandidate
+            ? memoizedValue(data->item, value.get()) : nullptr;
+    if (memoized)
+        addMemoizedRead(name, *memoized);
 
     QScriptValue result;
     if (m_valueCacheEnabled) {
@@ -641,19 +741,44 @@ QScriptValue EvaluatorScriptClass::property(const QScriptValue &object, const QS
         if (result.isValid()) {
             if (debugProperties)
                 qDebug() << "[SC] cache hit " << name << ": " << resultToString(result);
+            if (!memoized)
+                markProductDependent();
             return result;
         }
     }
 
     if (value->next() && !m_currentNextChain.contains(value.get())) {
+        markProductDependent();
         collectValuesFromNextChain(data, &result, name.toString(), value);
     } else {
-        QScriptValue parentObject;
-        if (foundInParent)
-            parentObject = data->evaluator->scriptValue(data->item->parent());
-        SVConverter converter(this, foundInParent ? &parentObject : &object, value, itemOfProperty,
-                              &name, data, &result);
-        converter.start();
+        if (memoized) {
+            result = copiedValue(engine(), memoized->result);
+        } else if (isMemoizationCandidate) {
+            MemoizationFrameGuard frameGuard(m_memoizationFrames, data->item);
+            SVConverter converter(this, &object, value, itemOfProperty, &name, data, &result);
+            converter.start();
+            MemoizationFrame frame = frameGuard.take();
+            if (frame.productIndependent && isMemoizableResult(result)
+                    && !static_cast<ScriptEngine *>(engine())->hasErrorOrException(result)) {
+                MemoizedValue &newEntry = m_memoizedValues[value.get()];
+                newEntry.value = value;
+                newEntry.result = result;
+                newEntry.reads = std::move(frame.reads);
+                newEntry.dependencies = std::move(frame.dependencies);
+                addMemoizedRead(name, newEntry);
+                result = copiedValue(engine(), result);
+            } else {
+                markProductDependent();
+            }
+        } else {
+            markProductDependent();
+            QScriptValue parentObject;
+            if (foundInParent)
+                parentObject = data->evaluator->scriptValue(data->item->parent());
+            SVConverter converter(this, foundInParent ? &parentObject : &object, value,
+                                  itemOfProperty, &name, data, &result);
+            converter.start();
+        }
 
         const PropertyDeclaration decl = data->item->propertyDeclaration(name.toString());
         convertToPropertyType(data->item, decl, value.get(), result);
@@ -724,5 +849,39 @@ void EvaluatorScriptClass::setValueCacheEnabled(bool enabled)
     m_valueCacheEnabled = enabled;
 }
 
+const EvaluatorScriptClass::MemoizedValue *EvaluatorScriptClass::memoizedValue(
+        const Item *item, const Value *value) const
+{
+    const auto it = m_memoizedValues.constFind(value);
+    if (it == m_memoizedValues.constEnd())
+        return nullptr;
+    for (const PropertyRead &read : it.value().reads) {
+        if (lookupValue(item, read.first) != read.second)
+            return nullptr;
+    }
+    return &it.value();
+}
+
+void EvaluatorScriptClass::addMemoizedRead(const QScriptString &name,
+                                           const MemoizedValue &memoizedValue)
+{
+    for (const PropertyDependency &dependency : memoizedValue.dependencies)
+        m_propertyDependencies[dependency.first].insert(dependency.second);
+    if (m_memoizationFrames.empty())
+        return;
+    MemoizationFrame &frame = m_memoizationFrames.back();
+    frame.reads.insert(frame.reads.end(), memoizedValue.reads.cbegin(),
+                       memoizedValue.reads.cend());
+    frame.reads.emplace_back(name.toString(), memoizedValue.value.get());
+    frame.dependencies.insert(frame.dependencies.end(), memoizedValue.dependencies.cbegin(),
+                              memoizedValue.dependencies.cend());
+}
+
+void EvaluatorScriptClass::markProductDependent()
+{
+    if (!m_memoizationFrames.empty())
+        m_memoizationFrames.back().productIndependent = false;
+}
+
 } // namespace Internal
 } // namespace qbs
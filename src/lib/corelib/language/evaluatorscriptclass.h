@@ -45,9 +45,14 @@
 
 #include <tools/set.h>
 
+#include <QtCore/qhash.h>
+
 #include <QtScript/qscriptclass.h>
 
+#include <functional>
 #include <stack>
+#include <utility>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 class QScriptContext;
@@ -83,6 +88,13 @@ public:
     void setPathPropertiesBaseDir(const QString &dirPath) { m_pathPropertiesBaseDir = dirPath; }
     void clearPathPropertiesBaseDir() { m_pathPropertiesBaseDir.clear(); }
 
+    void setPendingItemHandler(const std::function<void(const Item *)> &handler)
+    {
+        m_pendingItemHandler = handler;
+    }
+    void addPendingItem(const Item *item) { m_pendingItems.insert(item); }
+    void clearPendingItems() { m_pendingItems.clear(); }
+
 private:
     QueryFlags queryItemProperty(const EvaluationData *data,
                                  const QString &name,
@@ -119,12 +131,46 @@ private:
         const Item *itemOfProperty;     // The item that owns the property.
         ValuePtr value;
     };
+    using PropertyRead = std::pair<QString, const Value *>;
+    using PropertyDependency = std::pair<QualifiedId, QualifiedId>;
+
+    // A module property value whose evaluation did not involve anything product-specific.
+    // It is valid for all instances of the module in which the properties that were
+    // read during the evaluation still have the same values.
+    struct MemoizedValue
+    {
+        ValuePtr value;
+        QScriptValue result;
+        std::vector<PropertyRead> reads;
+        std::vector<PropertyDependency> dependencies;
+    };
+
+    struct MemoizationFrame
+    {
+        MemoizationFrame(const Item *item) : item(item) {}
+
+        const Item *item;
+        bool productIndependent = true;
+        std::vector<PropertyRead> reads;
+        std::vector<PropertyDependency> dependencies;
+    };
+
+    class MemoizationFrameGuard;
+
+    const MemoizedValue *memoizedValue(const Item *item, const Value *value) const;
+    void addMemoizedRead(const QScriptString &name, const MemoizedValue &memoizedValue);
+    void markProductDependent();
+
     QueryResult m_queryResult;
     bool m_valueCacheEnabled;
+    QHash<const Value *, MemoizedValue> m_memoizedValues;
+    std::vector<MemoizationFrame> m_memoizationFrames;
     Set<Value *> m_currentNextChain;
     PropertyDependencies m_propertyDependencies;
     std::stack<QualifiedId> m_requestedProperties;
     QString m_pathPropertiesBaseDir;
+    Set<const Item *> m_pendingItems;
+    std::function<void(const Item *)> m_pendingItemHandler;
 };
 
 } // namespace Internal
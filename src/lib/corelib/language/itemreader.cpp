@@ -65,6 +65,11 @@ ItemReader::~ItemReader()
     delete m_visitorState;
 }
 
+void ItemReader::setParseCache(ParseCache *parseCache)
+{
+    m_visitorState->setParseCache(parseCache);
+}
+
 void ItemReader::setSearchPaths(const QStringList &searchPaths)
 {
     m_searchPaths = searchPaths;
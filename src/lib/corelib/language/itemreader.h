@@ -54,6 +54,7 @@ namespace Internal {
 class Item;
 class ItemPool;
 class ItemReaderVisitorState;
+class ParseCache;
 
 /*
  * Reads a qbs file and creates a tree of Item objects.
@@ -71,6 +72,7 @@ public:
     ~ItemReader();
 
     void setPool(ItemPool *pool) { m_pool = pool; }
+    void setParseCache(ParseCache *parseCache);
     void setSearchPaths(const QStringList &searchPaths);
     void pushExtraSearchPaths(const QStringList &extraSearchPaths);
     void popExtraSearchPaths();
@@ -41,26 +41,20 @@
 
 #include "astimportshandler.h"
 #include "astpropertiesitemhandler.h"
-#include "asttools.h"
 #include "builtindeclarations.h"
 #include "filecontext.h"
-#include "identifiersearch.h"
 #include "item.h"
 #include "itemreadervisitorstate.h"
 #include "value.h"
 
 #include <api/languageinfo.h>
 #include <jsextensions/jsextensions.h>
-#include <parser/qmljsast_p.h>
 #include <tools/codelocation.h>
 #include <tools/error.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
-#include <tools/stringconstants.h>
 #include <logging/translator.h>
 
-using namespace QbsQmlJS;
-
 namespace qbs {
 namespace Internal {
 
@@ -73,23 +67,47 @@ ItemReaderASTVisitor::ItemReaderASTVisitor(ItemReaderVisitorState &visitorState,
 {
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiImportList *uiImportList)
+void ItemReaderASTVisitor::visit(const ParsedFile &parsedFile)
 {
     ASTImportsHandler importsHandler(m_visitorState, m_logger, m_file);
-    importsHandler.handleImports(uiImportList);
+    importsHandler.handleImports(parsedFile.imports);
     m_typeNameToFile = importsHandler.typeNameFileMap();
-    return false;
+
+    m_members = &parsedFile.members;
+    m_nextMember = 0;
+    visitMembers();
+}
+
+// Visits the members of the current object, including nested objects.
+void ItemReaderASTVisitor::visitMembers()
+{
+    while (m_nextMember < m_members->size()) {
+        const ParsedFile::Member &member = m_members->at(m_nextMember++);
+        switch (member.type) {
+        case ParsedFile::MemberType::ObjectBegin:
+            visitObjectDefinition(member);
+            break;
+        case ParsedFile::MemberType::ObjectEnd:
+            return;
+        case ParsedFile::MemberType::PublicMember:
+            visitPublicMember(member);
+            break;
+        case ParsedFile::MemberType::ScriptBinding:
+            visitScriptBinding(member);
+            break;
+        }
+    }
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
+void ItemReaderASTVisitor::visitObjectDefinition(const ParsedFile::Member &member)
 {
-    const QString typeName = ast->qualifiedTypeNameId->name.toString();
-    const CodeLocation itemLocation = toCodeLocation(ast->qualifiedTypeNameId->identifierToken);
+    const QString typeName = member.name.front();
+    const CodeLocation itemLocation = toCodeLocation(member.location);
     const Item *inheritorItem = nullptr;
 
     // Inheritance resolving, part 1: Find out our actual type name (needed for setting
     // up children and alternatives).
-    const QStringList fullTypeName = toStringList(ast->qualifiedTypeNameId);
+    const QStringList &fullTypeName = member.name;
     const QString baseTypeFileName = m_typeNameToFile.value(fullTypeName);
     ItemType itemType;
     if (!baseTypeFileName.isEmpty()) {
@@ -117,11 +135,9 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
     else
         m_item = item; // This is the root item.
 
-    if (ast->initializer) {
-        qSwap(m_item, item);
-        ast->initializer->accept(this);
-        qSwap(m_item, item);
-    }
+    qSwap(m_item, item);
+    visitMembers();
+    qSwap(m_item, item);
 
     ASTPropertiesItemHandler(item).handlePropertiesItems();
 
@@ -140,12 +156,10 @@ bool ItemReaderASTVisitor::visit(AST::UiObjectDefinition *ast)
         // bindings.
         item->setupForBuiltinType(m_logger);
     }
-
-    return false;
 }
 
 void ItemReaderASTVisitor::checkDuplicateBinding(Item *item, const QStringList &bindingName,
-                                                 const AST::SourceLocation &sourceLocation)
+                                                 const ParsedFile::SourceLocation &sourceLocation)
 {
     if (Q_UNLIKELY(item->hasOwnProperty(bindingName.last()))) {
         QString msg = Tr::tr("Duplicate binding for '%1'");
@@ -154,57 +168,48 @@ void ItemReaderASTVisitor::checkDuplicateBinding(Item *item, const QStringList &
     }
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiPublicMember *ast)
+void ItemReaderASTVisitor::visitPublicMember(const ParsedFile::Member &member)
 {
     PropertyDeclaration p;
-    if (Q_UNLIKELY(ast->name.isEmpty()))
+    if (Q_UNLIKELY(member.name.front().isEmpty()))
         throw ErrorInfo(Tr::tr("public member without name"));
-    if (Q_UNLIKELY(ast->memberType.isEmpty()))
+    if (Q_UNLIKELY(member.memberType.isEmpty()))
         throw ErrorInfo(Tr::tr("public member without type"));
-    if (Q_UNLIKELY(ast->type == AST::UiPublicMember::Signal))
+    if (Q_UNLIKELY(member.isSignal))
         throw ErrorInfo(Tr::tr("public member with signal type not supported"));
-    p.setName(ast->name.toString());
-    p.setType(PropertyDeclaration::propertyTypeFromString(ast->memberType.toString()));
+    p.setName(member.name.front());
+    p.setType(PropertyDeclaration::propertyTypeFromString(member.memberType));
     if (p.type() == PropertyDeclaration::UnknownType) {
         throw ErrorInfo(Tr::tr("Unknown type '%1' in property declaration.")
-                        .arg(ast->memberType.toString()), toCodeLocation(ast->typeToken));
+                        .arg(member.memberType), toCodeLocation(member.typeToken));
     }
-    if (Q_UNLIKELY(!ast->typeModifier.isEmpty())) {
+    if (Q_UNLIKELY(!member.typeModifier.isEmpty())) {
         throw ErrorInfo(Tr::tr("public member with type modifier '%1' not supported").arg(
-                        ast->typeModifier.toString()));
+                        member.typeModifier));
     }
-    if (ast->isReadonlyMember)
+    if (member.isReadOnly)
         p.setFlags(PropertyDeclaration::ReadOnlyFlag);
 
     m_item->m_propertyDeclarations.insert(p.name(), p);
 
     const JSSourceValuePtr value = JSSourceValue::create();
     value->setFile(m_file);
-    if (ast->statement) {
-        handleBindingRhs(ast->statement, value);
-        const QStringList bindingName(p.name());
-        checkDuplicateBinding(m_item, bindingName, ast->colonToken);
+    if (member.hasValue) {
+        handleBindingRhs(member, value);
+        checkDuplicateBinding(m_item, member.name, member.location);
     }
 
     m_item->setProperty(p.name(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::visit(AST::UiScriptBinding *ast)
+void ItemReaderASTVisitor::visitScriptBinding(const ParsedFile::Member &member)
 {
-    QBS_CHECK(ast->qualifiedId);
-    QBS_CHECK(!ast->qualifiedId->name.isEmpty());
-
-    const QStringList bindingName = toStringList(ast->qualifiedId);
+    const QStringList &bindingName = member.name;
 
     if (bindingName.length() == 1 && bindingName.front() == QStringLiteral("id")) {
-        const auto * const expStmt = AST::cast<AST::ExpressionStatement *>(ast->statement);
-        if (Q_UNLIKELY(!expStmt))
-            throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
-        const auto * const idExp = AST::cast<AST::IdentifierExpression *>(expStmt->expression);
-        if (Q_UNLIKELY(!idExp || idExp->name.isEmpty()))
+        if (Q_UNLIKELY(member.idValue.isEmpty()))
             throw ErrorInfo(Tr::tr("id: must be followed by identifier"));
-        m_item->m_id = idExp->name.toString();
+        m_item->m_id = member.idValue;
         m_file->ensureIdScope(m_itemPool);
         ItemValueConstPtr existingId = m_file->idScope()->itemProperty(m_item->id());
         if (existingId) {
@@ -214,48 +219,31 @@ bool ItemReaderASTVisitor::visit(AST::UiScriptBinding *ast)
             throw e;
         }
         m_file->idScope()->setProperty(m_item->id(), ItemValue::create(m_item));
-        return false;
+        return;
     }
 
     const JSSourceValuePtr value = JSSourceValue::create();
-    handleBindingRhs(ast->statement, value);
+    handleBindingRhs(member, value);
 
     Item * const targetItem = targetItemForBinding(bindingName, value);
-    checkDuplicateBinding(targetItem, bindingName, ast->qualifiedId->identifierToken);
+    checkDuplicateBinding(targetItem, bindingName, member.location);
     targetItem->setProperty(bindingName.last(), value);
-    return false;
 }
 
-bool ItemReaderASTVisitor::handleBindingRhs(AST::Statement *statement,
+void ItemReaderASTVisitor::handleBindingRhs(const ParsedFile::Member &member,
                                             const JSSourceValuePtr &value)
 {
-    QBS_CHECK(statement);
+    QBS_CHECK(member.hasValue);
     QBS_CHECK(value);
 
-    if (AST::cast<AST::Block *>(statement))
-        value->m_flags |= JSSourceValue::HasFunctionForm;
-
+    value->m_flags |= JSSourceValue::Flags(member.valueFlags);
     value->setFile(m_file);
-    value->setSourceCode(textRefOf(m_file->content(), statement));
-    value->setLocation(statement->firstSourceLocation().startLine,
-                       statement->firstSourceLocation().startColumn);
-
-    bool usesBase, usesOuter, usesOriginal;
-    IdentifierSearch idsearch;
-    idsearch.add(StringConstants::baseVar(), &usesBase);
-    idsearch.add(StringConstants::outerVar(), &usesOuter);
-    idsearch.add(StringConstants::originalVar(), &usesOriginal);
-    idsearch.start(statement);
-    if (usesBase)
-        value->m_flags |= JSSourceValue::SourceUsesBase;
-    if (usesOuter)
-        value->m_flags |= JSSourceValue::SourceUsesOuter;
-    if (usesOriginal)
-        value->m_flags |= JSSourceValue::SourceUsesOriginal;
-    return false;
+    value->setSourceCode(m_file->content().midRef(member.valueLocation.offset,
+                                                   member.valueLocation.length));
+    value->setLocation(member.valueLocation.startLine, member.valueLocation.startColumn);
 }
 
-CodeLocation ItemReaderASTVisitor::toCodeLocation(const AST::SourceLocation &location) const
+CodeLocation ItemReaderASTVisitor::toCodeLocation(const ParsedFile::SourceLocation &location) const
 {
     return CodeLocation(m_file->filePath(), location.startLine, location.startColumn);
 }
@@ -42,9 +42,9 @@
 
 #include "forward_decls.h"
 #include "itemtype.h"
+#include "parsedfile.h"
 
 #include <logging/logger.h>
-#include <parser/qmljsastvisitor_p.h>
 
 #include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
@@ -57,25 +57,26 @@ class Item;
 class ItemPool;
 class ItemReaderVisitorState;
 
-class ItemReaderASTVisitor : public QbsQmlJS::AST::Visitor
+class ItemReaderASTVisitor
 {
 public:
     ItemReaderASTVisitor(ItemReaderVisitorState &visitorState, const FileContextPtr &file,
                          ItemPool *itemPool, Logger &logger);
+    void visit(const ParsedFile &parsedFile);
     void checkItemTypes() { doCheckItemTypes(rootItem()); }
 
     Item *rootItem() const { return m_item; }
 
 private:
-    bool visit(QbsQmlJS::AST::UiImportList *uiImportList) override;
-    bool visit(QbsQmlJS::AST::UiObjectDefinition *ast) override;
-    bool visit(QbsQmlJS::AST::UiPublicMember *ast) override;
-    bool visit(QbsQmlJS::AST::UiScriptBinding *ast) override;
+    void visitMembers();
+    void visitObjectDefinition(const ParsedFile::Member &member);
+    void visitPublicMember(const ParsedFile::Member &member);
+    void visitScriptBinding(const ParsedFile::Member &member);
 
-    bool handleBindingRhs(QbsQmlJS::AST::Statement *statement, const JSSourceValuePtr &value);
-    CodeLocation toCodeLocation(const QbsQmlJS::AST::SourceLocation &location) const;
+    void handleBindingRhs(const ParsedFile::Member &member, const JSSourceValuePtr &value);
+    CodeLocation toCodeLocation(const ParsedFile::SourceLocation &location) const;
     void checkDuplicateBinding(Item *item, const QStringList &bindingName,
-            const QbsQmlJS::AST::SourceLocation &sourceLocation);
+            const ParsedFile::SourceLocation &sourceLocation);
     Item *targetItemForBinding(const QStringList &binding, const JSSourceValueConstPtr &value);
     static void inheritItem(Item *dst, const Item *src);
     void checkDeprecationStatus(ItemType itemType, const QString &itemName,
@@ -87,6 +88,8 @@ private:
     ItemPool * const m_itemPool;
     Logger &m_logger;
     QHash<QStringList, QString> m_typeNameToFile;
+    const std::vector<ParsedFile::Member> *m_members = nullptr;
+    size_t m_nextMember = 0;
     Item *m_item = nullptr;
 };
 
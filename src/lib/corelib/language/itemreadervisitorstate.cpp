@@ -41,14 +41,17 @@
 #include "asttools.h"
 #include "filecontext.h"
 #include "itemreaderastvisitor.h"
+#include "parsecache.h"
+#include "parsedfile.h"
 
+#include <logging/categories.h>
 #include <logging/translator.h>
 #include <parser/qmljsengine_p.h>
 #include <parser/qmljslexer_p.h>
 #include <parser/qmljsparser_p.h>
 #include <tools/error.h>
 
-#include <QtCore/qshareddata.h>
+#include <QtCore/qdatastream.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
 #include <QtCore/qshareddata.h>
@@ -62,14 +65,14 @@ class ASTCacheValueData : public QSharedData
     Q_DISABLE_COPY(ASTCacheValueData)
 public:
     ASTCacheValueData()
-        : ast(nullptr)
+        : valid(false)
         , processing(false)
     {
     }
 
     QString code;
-    QbsQmlJS::Engine engine;
-    QbsQmlJS::AST::UiProgram *ast;
+    ParsedFile parsedFile;
+    bool valid;
     bool processing;
 };
 
@@ -92,11 +95,13 @@ public:
     void setCode(const QString &code) { d->code = code; }
     QString code() const { return d->code; }
 
-    QbsQmlJS::Engine *engine() const { return &d->engine; }
-
-    void setAst(QbsQmlJS::AST::UiProgram *ast) { d->ast = ast; }
-    QbsQmlJS::AST::UiProgram *ast() const { return d->ast; }
-    bool isValid() const { return d->ast; }
+    void setParsedFile(const ParsedFile &parsedFile)
+    {
+        d->parsedFile = parsedFile;
+        d->valid = true;
+    }
+    const ParsedFile &parsedFile() const { return d->parsedFile; }
+    bool isValid() const { return d->valid; }
 
 private:
     QExplicitlySharedDataPointer<ASTCacheValueData> d;
@@ -130,26 +135,48 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
             throw ErrorInfo(Tr::tr("Cannot open '%1'.").arg(filePath));
 
         m_filesRead.insert(filePath);
-        QTextStream stream(&file);
+        const QByteArray content = file.readAll();
+        file.close();
+        QTextStream stream(content);
         stream.setCodec("UTF-8");
         const QString &code = stream.readAll();
-        QbsQmlJS::Lexer lexer(cacheValue.engine());
-        lexer.setCode(code, 1);
-        QbsQmlJS::Parser parser(cacheValue.engine());
+        cacheValue.setCode(code);
 
-        file.close();
-        if (!parser.parse()) {
-            const QList<QbsQmlJS::DiagnosticMessage> &parserMessages = parser.diagnosticMessages();
-            if (Q_UNLIKELY(!parserMessages.empty())) {
-                ErrorInfo err;
-                for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
-                    err.append(msg.message, toCodeLocation(filePath, msg.loc));
-                throw err;
+        const QByteArray cacheKey = m_parseCache
+                ? ParseCache::key(ParseCache::Kind::QbsFile, content) : QByteArray();
+        QByteArray cachedData;
+        ParsedFile parsedFile;
+        bool isCached = false;
+        if (m_parseCache && m_parseCache->find(cacheKey, &cachedData)) {
+            QDataStream cacheStream(cachedData);
+            isCached = parsedFile.load(cacheStream);
+            if (!isCached)
+                qCDebug(lcModuleLoader) << "ignoring corrupt parse cache entry for" << filePath;
+        }
+        if (!isCached) {
+            QbsQmlJS::Engine engine;
+            QbsQmlJS::Lexer lexer(&engine);
+            lexer.setCode(code, 1);
+            QbsQmlJS::Parser parser(&engine);
+            if (!parser.parse()) {
+                const QList<QbsQmlJS::DiagnosticMessage> &parserMessages
+                        = parser.diagnosticMessages();
+                if (Q_UNLIKELY(!parserMessages.empty())) {
+                    ErrorInfo err;
+                    for (const QbsQmlJS::DiagnosticMessage &msg : parserMessages)
+                        err.append(msg.message, toCodeLocation(filePath, msg.loc));
+                    throw err;
+                }
+            }
+            parsedFile = ParsedFile::create(parser.ast());
+            if (m_parseCache) {
+                QByteArray data;
+                QDataStream cacheStream(&data, QIODevice::WriteOnly);
+                parsedFile.store(cacheStream);
+                m_parseCache->insert(cacheKey, data);
             }
         }
-
-        cacheValue.setCode(code);
-        cacheValue.setAst(parser.ast());
+        cacheValue.setParsedFile(parsedFile);
     }
 
     const FileContextPtr file = FileContext::create();
@@ -166,7 +193,7 @@ Item *ItemReaderVisitorState::readFile(const QString &filePath, const QStringLis
         private:
             ASTCacheValue &m_cacheValue;
         } processingFlagManager(cacheValue);
-        cacheValue.ast()->accept(&astVisitor);
+        astVisitor.visit(cacheValue.parsedFile());
     }
     astVisitor.checkItemTypes();
     return astVisitor.rootItem();
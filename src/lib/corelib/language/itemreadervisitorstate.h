@@ -50,6 +50,7 @@ namespace qbs {
 namespace Internal {
 class Item;
 class ItemPool;
+class ParseCache;
 
 class ItemReaderVisitorState
 {
@@ -59,6 +60,8 @@ public:
 
     Set<QString> filesRead() const { return m_filesRead; }
 
+    void setParseCache(ParseCache *parseCache) { m_parseCache = parseCache; }
+
     Item *readFile(const QString &filePath, const QStringList &searchPaths, ItemPool *itemPool);
 
     void cacheDirectoryEntries(const QString &dirPath, const QStringList &entries);
@@ -68,6 +71,7 @@ private:
     Logger &m_logger;
     Set<QString> m_filesRead;
     QHash<QString, QStringList> m_directoryEntries;
+    ParseCache *m_parseCache = nullptr;
 
     class ASTCache;
     ASTCache * const m_astCache;
@@ -59,6 +59,7 @@
 #include <tools/error.h>
 #include <tools/fileinfo.h>
 #include <tools/persistence.h>
+#include <tools/profiling.h>
 #include <tools/scripttools.h>
 #include <tools/qbsassert.h>
 #include <tools/qttools.h>
@@ -483,6 +484,7 @@ void Rule::load(PersistentPool &pool)
     pool.load(multiplex);
     pool.load(requiresInputs);
     pool.load(alwaysRun);
+    pool.load(jobPool);
     pool.load(artifacts);
 }
 
@@ -501,6 +503,7 @@ void Rule::store(PersistentPool &pool) const
     pool.store(multiplex);
     pool.store(requiresInputs);
     pool.store(alwaysRun);
+    pool.store(jobPool);
     pool.store(artifacts);
 }
 
@@ -912,8 +915,11 @@ void TopLevelProject::store(Logger logger) const
         qCDebug(lcBuildGraph) << "build graph is unchanged in project" << id();
         return;
     }
+    const TraceEvent traceEvent("buildgraph", QStringLiteral("Storing build graph"));
     const QString fileName = buildGraphFilePath();
     qCDebug(lcBuildGraph) << "storing:" << fileName;
+    buildData->rawScanResults.setFilePath(RawScanResults::deriveFilePath(fileName));
+    buildData->rawScanResults.prepareStore();
     PersistentPool pool(logger);
     PersistentPool::HeadData headData;
     headData.projectConfig = buildConfiguration();
@@ -921,6 +927,15 @@ void TopLevelProject::store(Logger logger) const
     pool.setupWriteStream(fileName);
     store(pool);
     pool.finalizeWriteStream();
+
+    // If this fails, the scan results file does not match the new build graph anymore
+    // and gets ignored when loading it, which just means that files will be rescanned.
+    // So there is no reason to fail the whole operation.
+    try {
+        buildData->rawScanResults.writeFile();
+    } catch (const ErrorInfo &error) {
+        logger.printWarning(error);
+    }
     buildData->isDirty = false;
 }
 
@@ -946,6 +961,10 @@ void TopLevelProject::load(PersistentPool &pool)
 
 void TopLevelProject::store(PersistentPool &pool) const
 {
+    for (const ResolvedProductPtr &product : allProducts()) {
+        if (product->buildData)
+            product->buildData->serializeCommands();
+    }
     ResolvedProject::store(pool);
     pool.store(m_id);
     pool.store(canonicalFilePathResults);
@@ -1167,7 +1186,8 @@ bool operator==(const Rule &r1, const Rule &r2)
             && r1.explicitlyDependsOn == r2.explicitlyDependsOn
             && r1.multiplex == r2.multiplex
             && r1.requiresInputs == r2.requiresInputs
-            && r1.alwaysRun == r2.alwaysRun;
+            && r1.alwaysRun == r2.alwaysRun
+            && r1.jobPool == r2.jobPool;
 }
 
 bool ruleListsAreEqual(const QList<RulePtr> &l1, const QList<RulePtr> &l2)
@@ -385,6 +385,7 @@ public:
     bool requiresInputs;
     QList<RuleArtifactPtr> artifacts;           // unused, if outputFileTags/outputArtifactsScript is non-empty
     bool alwaysRun;
+    QString jobPool;                            // for commands that do not set one
 
     // members that we don't need to save
     int ruleGraphId;
@@ -461,6 +462,9 @@ public:
     QList<ProbeConstPtr> probes;
     QList<ArtifactPropertiesPtr> artifactProperties;
     QStringList missingSourceFiles;
+    // The qbs and js files this product was resolved from. Only needed for change tracking
+    // right after resolving, so it is not stored in the build graph.
+    Set<QString> buildSystemFiles;
     std::unique_ptr<ProductBuildData> buildData;
 
     QProcessEnvironment buildEnvironment; // must not be saved
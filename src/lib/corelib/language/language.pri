@@ -28,7 +28,10 @@ HEADERS += \
     $$PWD/loader.h \
     $$PWD/moduleloader.h \
     $$PWD/modulemerger.h \
+    $$PWD/parsecache.h \
+    $$PWD/parsedfile.h \
     $$PWD/preparescriptobserver.h \
+    $$PWD/probecache.h \
     $$PWD/projectresolver.h \
     $$PWD/property.h \
     $$PWD/propertydeclaration.h \
@@ -62,7 +65,10 @@ SOURCES += \
     $$PWD/loader.cpp \
     $$PWD/moduleloader.cpp \
     $$PWD/modulemerger.cpp \
+    $$PWD/parsecache.cpp \
+    $$PWD/parsedfile.cpp \
     $$PWD/preparescriptobserver.cpp \
+    $$PWD/probecache.cpp \
     $$PWD/scriptpropertyobserver.cpp \
     $$PWD/projectresolver.cpp \
     $$PWD/property.cpp \
@@ -42,6 +42,7 @@
 #include "evaluator.h"
 #include "language.h"
 #include "moduleloader.h"
+#include "parsecache.h"
 #include "projectresolver.h"
 #include "scriptengine.h"
 
@@ -152,8 +153,24 @@ TopLevelProjectPtr Loader::loadProject(const SetupProjectParameters &_parameters
     }
 
     const FileTime resolveTime = FileTime::currentTime();
+    ParseCache parseCache(parameters.buildRoot().isEmpty()
+                          ? QString() : ParseCache::deriveFilePath(parameters.buildRoot()));
+    parseCache.load();
+    const ParseCacheSetter parseCacheSetter(m_engine, &parseCache);
+
+    // The files that were parsed are worth keeping even if resolving fails later.
+    class ParseCacheStorer {
+    public:
+        ParseCacheStorer(ParseCache &cache, bool dryRun) : m_cache(cache), m_dryRun(dryRun) {}
+        ~ParseCacheStorer() { if (!m_dryRun) m_cache.store(); }
+    private:
+        ParseCache &m_cache;
+        const bool m_dryRun;
+    } parseCacheStorer(parseCache, parameters.dryRun());
+
     Evaluator evaluator(m_engine);
     ModuleLoader moduleLoader(&evaluator, m_logger);
+    moduleLoader.setParseCache(&parseCache);
     moduleLoader.setProgressObserver(m_progressObserver);
     moduleLoader.setSearchPaths(m_searchPaths);
     moduleLoader.setOldProjectProbes(m_oldProjectProbes);
@@ -46,11 +46,14 @@
 #include "itemreader.h"
 #include "language.h"
 #include "modulemerger.h"
+#include "probecache.h"
+#include "propertydeclaration.h"
 #include "qualifiedid.h"
 #include "scriptengine.h"
 #include "value.h"
 
 #include <api/languageinfo.h>
+#include <buildgraph/buildgraph.h>
 #include <language/language.h>
 #include <logging/categories.h>
 #include <logging/logger.h>
@@ -73,9 +76,13 @@
 #include <QtCore/qdiriterator.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
+#include <QtCore/qregularexpression.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qthreadpool.h>
 #include <QtScript/qscriptvalueiterator.h>
 
 #include <algorithm>
+#include <future>
 #include <utility>
 
 namespace qbs {
@@ -272,6 +279,11 @@ void ModuleLoader::setStoredProfiles(const QVariantMap &profiles)
     m_storedProfiles = profiles;
 }
 
+void ModuleLoader::setParseCache(ParseCache *parseCache)
+{
+    m_reader->setParseCache(parseCache);
+}
+
 ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
 {
     TimedActivityLogger moduleLoaderTimer(m_logger, Tr::tr("ModuleLoader"),
@@ -285,6 +297,8 @@ ModuleLoaderResult ModuleLoader::load(const SetupProjectParameters &parameters)
     m_reader->setEnableTiming(parameters.logElapsedTime());
     m_elapsedTimeProbes = 0;
     m_settings.reset(new Settings(parameters.settingsDirectory()));
+    m_probeCache.reset(new ProbeCache(Preferences(m_settings.get(), parameters.topLevelProfile())
+                                      .probeCacheDirectory()));
 
     for (const QString &key : m_parameters.overriddenValues().keys()) {
         static const QStringList prefixes({ StringConstants::projectPrefix(),
@@ -2642,6 +2656,17 @@ static Item *findDeepestModuleInstance(Item *instance)
     return instance;
 }
 
+// A module file can influence a product even if its condition is false for that product,
+// as a change might make it the preferred candidate.
+static void addModuleFile(ModuleLoaderResult::ProductInfo &productInfo, const Item *module)
+{
+    if (!module->file())
+        return;
+    productInfo.moduleFiles.insert(module->file()->filePath());
+    for (const JsImport &jsImport : module->file()->jsImports())
+        productInfo.moduleFiles.unite(Set<QString>::fromList(jsImport.filePaths));
+}
+
 Item *ModuleLoader::loadModuleFile(ProductContext *productContext, const QString &fullModuleName,
         bool isBaseModule, const QString &filePath, bool *triedToLoad, Item *moduleInstance)
 {
@@ -2655,9 +2680,11 @@ Item *ModuleLoader::loadModuleFile(ProductContext *productContext, const QString
     const ItemCacheValue cacheValue = m_modulePrototypeItemCache.value(cacheKey);
     if (cacheValue.module) {
         qCDebug(lcModuleLoader) << "loadModuleFile cache hit";
+        addModuleFile(productContext->info, cacheValue.module);
         return cacheValue.enabled ? cacheValue.module : 0;
     }
     Item * const module = loadItemFromFile(filePath);
+    addModuleFile(productContext->info, module);
     if (module->type() != ItemType::Module) {
         qCDebug(lcModuleLoader).nospace()
                             << "Alleged module " << fullModuleName << " has type '"
@@ -2927,16 +2954,244 @@ void ModuleLoader::createChildInstances(Item *instance, Item *prototype,
     }
 }
 
+// A probe whose configure script runs on a thread pool, using a script engine of its own.
+// The results are applied to the probe item in the main thread.
+struct ModuleLoader::PendingProbe
+{
+    struct Binding
+    {
+        QString name;
+        QVariant value;
+        PropertyDeclaration declaration;
+    };
+
+    void runConfigureScript();
+
+    Item *item = nullptr;
+    QString id;
+    CodeLocation location;
+    FileContextConstPtr file;
+    CodeLocation configureScriptLocation;
+    QString sourceCode;
+    QString sourceCodeForEvaluation;
+    QVariantMap initialProperties;
+    std::vector<Binding> bindings;
+    QProcessEnvironment environment;
+    Logger logger;
+    QByteArray probeCacheKey;
+    std::future<void> finished;
+    bool applied = false;
+
+    QVariantMap properties;
+    std::vector<QString> importedFilesUsed;
+    FileSystemResults fileSystemResults;
+    ErrorInfo error;
+    ProbeConstPtr resolvedProbe;
+};
+
+void ModuleLoader::PendingProbe::runConfigureScript()
+{
+    const TraceEvent traceEvent("probe", id);
+    ScriptEngine engine(logger, EvalContext::ProbeExecution);
+    engine.setEnvironment(environment);
+    QScriptValue fileScope = engine.newObject();
+    fileScope.setProperty(StringConstants::filePathGlobalVar(), file->filePath());
+    fileScope.setProperty(StringConstants::pathGlobalVar(), file->dirPath());
+    QScriptValue importScope = engine.newObject();
+    try {
+        setupScriptEngineForFile(&engine, file, importScope, ObserveMode::Enabled);
+    } catch (const ErrorInfo &e) {
+        error = ErrorInfo(e.toString(), configureScriptLocation);
+        return;
+    }
+    QScriptValue configureScope = engine.newObject();
+    for (const Binding &b : bindings)
+        configureScope.setProperty(b.name, engine.toScriptValue(b.value));
+    engine.startRecordingFileSystemResults();
+    engine.currentContext()->pushScope(fileScope);
+    engine.currentContext()->pushScope(importScope);
+    engine.currentContext()->pushScope(configureScope);
+    const QScriptValue sv = engine.evaluate(sourceCodeForEvaluation);
+    engine.currentContext()->popScope();
+    engine.currentContext()->popScope();
+    engine.currentContext()->popScope();
+    fileSystemResults = engine.stopRecordingFileSystemResults();
+    if (Q_UNLIKELY(engine.hasErrorOrException(sv))) {
+        error = ErrorInfo(engine.lastErrorString(sv), configureScriptLocation);
+    } else {
+        Evaluator evaluator(&engine);
+        for (const Binding &b : bindings) {
+            QScriptValue v = configureScope.property(b.name);
+            evaluator.convertToPropertyType(b.declaration, location, v);
+            if (Q_UNLIKELY(engine.hasErrorOrException(v))) {
+                error = engine.lastError(v);
+                break;
+            }
+            properties.insert(b.name, v.toVariant());
+        }
+        importedFilesUsed = engine.importedFilesUsedInScript();
+    }
+    engine.releaseResourcesOfScriptObjects();
+}
+
+namespace {
+class ProbeRunnable : public QRunnable
+{
+public:
+    ProbeRunnable(std::packaged_task<void()> &&task) : m_task(std::move(task)) {}
+
+private:
+    void run() override { m_task(); }
+
+    std::packaged_task<void()> m_task;
+};
+} // namespace
+
+// Values that can be transferred to another script engine via QVariant.
+// Cyclic structures cannot be converted, so they do not count as plain values.
+static bool isPlainValue(const QScriptValue &value, std::vector<QScriptValue> &parents)
+{
+    if (value.isFunction() || value.isQObject() || value.isQMetaObject() || value.isVariant())
+        return false;
+    if (!value.isObject() || value.isDate() || value.isRegExp())
+        return true;
+    const auto isValue = [&value](const QScriptValue &parent) {
+        return parent.strictlyEquals(value);
+    };
+    if (std::any_of(parents.cbegin(), parents.cend(), isValue))
+        return false;
+    parents.push_back(value);
+    bool isPlain = true;
+    QScriptValueIterator it(value);
+    while (isPlain && it.hasNext()) {
+        it.next();
+        isPlain = isPlainValue(it.value(), parents);
+    }
+    parents.pop_back();
+    return isPlain;
+}
+
+static bool isPlainValue(const QScriptValue &value)
+{
+    std::vector<QScriptValue> parents;
+    return isPlainValue(value, parents);
+}
+
+// The configure script sees the ids of its file, which we cannot provide in another engine.
+static bool refersToIds(const QString &sourceCode, const FileContextConstPtr &file)
+{
+    const Item * const idScope = file->idScope();
+    if (!idScope || idScope->properties().empty())
+        return false;
+    QStringList escapedIds;
+    for (auto it = idScope->properties().cbegin(); it != idScope->properties().cend(); ++it)
+        escapedIds << QRegularExpression::escape(it.key());
+    const QRegularExpression idRegExp(QStringLiteral("\\b(?:%1)\\b")
+                                      .arg(escapedIds.join(QLatin1Char('|'))));
+    return sourceCode.contains(idRegExp);
+}
+
 void ModuleLoader::resolveProbes(ProductContext *productContext, Item *item)
 {
     AccumulatingTimer probesTimer(m_parameters.logElapsedTime() ? &m_elapsedTimeProbes : nullptr);
     EvalContextSwitcher evalContextSwitcher(m_evaluator->engine(), EvalContext::ProbeExecution);
+    std::vector<Item *> probeItems;
     for (Item * const child : item->children())
         if (child->type() == ItemType::Probe)
-            resolveProbe(productContext, item, child);
+            probeItems.push_back(child);
+
+    // Configure scripts typically spend most of their time waiting for external processes,
+    // so if there is more than one of them, they run concurrently where possible.
+    // A pending probe's results are applied once another evaluation accesses the probe item,
+    // and at the latest when all probes are done. Either way, the probes are committed in
+    // their original order.
+    const bool runConcurrently = probeItems.size() > 1;
+    std::vector<std::pair<ProbeConstPtr, std::unique_ptr<PendingProbe>>> results;
+    QThreadPool threadPool;
+    class PendingItemsReset
+    {
+    public:
+        PendingItemsReset(Evaluator *evaluator) : m_evaluator(evaluator) {}
+        ~PendingItemsReset()
+        {
+            m_evaluator->clearPendingItems();
+            m_evaluator->setPendingItemHandler(std::function<void(const Item *)>());
+        }
+    private:
+        Evaluator * const m_evaluator;
+    } pendingItemsReset(m_evaluator);
+    Q_UNUSED(pendingItemsReset);
+    if (runConcurrently) {
+        m_evaluator->setPendingItemHandler([this, &results](const Item *probeItem) {
+            for (const auto &result : results) {
+                if (result.second && result.second->item == probeItem) {
+                    applyPendingProbeResult(*result.second);
+                    return;
+                }
+            }
+        });
+    }
+    const auto commitResults = [this, productContext, &results] {
+        for (auto &result : results) {
+            if (result.second) {
+                applyPendingProbeResult(*result.second);
+                if (Q_UNLIKELY(result.second->error.hasError()))
+                    throw result.second->error;
+                result.first = result.second->resolvedProbe;
+            }
+            productContext->info.probes << result.first;
+        }
+    };
+
+    try {
+        for (Item * const probeItem : probeItems) {
+            std::unique_ptr<PendingProbe> pendingProbe;
+            const ProbeConstPtr resolvedProbe = resolveProbe(productContext, item, probeItem,
+                    runConcurrently ? &pendingProbe : nullptr);
+            if (pendingProbe) {
+                PendingProbe * const p = pendingProbe.get();
+                std::packaged_task<void()> task([p] { p->runConfigureScript(); });
+                p->finished = task.get_future();
+                threadPool.start(new ProbeRunnable(std::move(task)));
+                m_evaluator->addPendingItem(probeItem);
+            }
+            results.emplace_back(resolvedProbe, std::move(pendingProbe));
+        }
+    } catch (const ErrorInfo &) {
+        commitResults();
+        throw;
+    }
+    commitResults();
 }
 
-void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, Item *probe)
+void ModuleLoader::applyPendingProbeResult(PendingProbe &pendingProbe)
+{
+    if (pendingProbe.applied)
+        return;
+    pendingProbe.applied = true;
+    pendingProbe.finished.get();
+    m_evaluator->engine()->addFileSystemResults(pendingProbe.fileSystemResults);
+    if (pendingProbe.error.hasError())
+        return;
+    for (const PendingProbe::Binding &b : pendingProbe.bindings) {
+        const QVariant newValue = pendingProbe.properties.value(b.name);
+        if (newValue != b.value)
+            pendingProbe.item->setProperty(b.name, VariantValue::create(newValue));
+    }
+    pendingProbe.resolvedProbe = Probe::create(pendingProbe.id, pendingProbe.location, true,
+                                               pendingProbe.sourceCode, pendingProbe.properties,
+                                               pendingProbe.initialProperties,
+                                               pendingProbe.importedFilesUsed);
+    m_currentProbes[pendingProbe.location] << pendingProbe.resolvedProbe;
+    if (!pendingProbe.probeCacheKey.isEmpty() && !m_parameters.dryRun()) {
+        m_probeCache->insert(pendingProbe.probeCacheKey, ProbeCache::Entry{
+                                 pendingProbe.properties, pendingProbe.importedFilesUsed,
+                                 pendingProbe.fileSystemResults});
+    }
+}
+
+ProbeConstPtr ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent,
+                                         Item *probe, std::unique_ptr<PendingProbe> *pendingProbe)
 {
     qCDebug(lcModuleLoader) << "Resolving Probe at " << probe->location().toString();
     const QString &probeId = probeGlobalId(probe);
@@ -2976,10 +3231,50 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
     }
     if (!resolvedProbe)
         resolvedProbe = findCurrentProbe(probe->location(), condition, initialProperties);
+    QByteArray probeCacheKey;
+    if (!resolvedProbe && condition && m_probeCache->isEnabled()) {
+        probeCacheKey = ProbeCache::key(configureScript->file()->filePath(), sourceCode,
+                                        initialProperties, engine->environment());
+        ProbeCache::Entry entry;
+        if (!m_parameters.forceProbeExecution() && m_probeCache->find(probeCacheKey, &entry)) {
+            qCDebug(lcModuleLoader) << "Using result of probe" << probeId
+                                    << "from the probe cache";
+            engine->addFileSystemResults(entry.fileSystemResults);
+            resolvedProbe = Probe::create(probeId, probe->location(), condition, sourceCode,
+                                          entry.properties, initialProperties,
+                                          entry.importedFilesUsed);
+            m_currentProbes[probe->location()] << resolvedProbe;
+        }
+    }
     std::vector<QString> importedFilesUsedInConfigure;
+    FileSystemResults fileSystemResults;
     if (!condition) {
         qCDebug(lcModuleLoader) << "Probe disabled; skipping";
+    } else if (!resolvedProbe && pendingProbe
+               && std::all_of(probeBindings.cbegin(), probeBindings.cend(),
+                              [](const ProbeProperty &b) { return isPlainValue(b.second); })
+               && !refersToIds(sourceCode, configureScript->file())) {
+        qCDebug(lcModuleLoader) << "Running probe" << probeId << "concurrently";
+        pendingProbe->reset(new PendingProbe);
+        PendingProbe &p = **pendingProbe;
+        p.item = probe;
+        p.id = probeId;
+        p.location = probe->location();
+        p.file = configureScript->file();
+        p.configureScriptLocation = configureScript->location();
+        p.sourceCode = sourceCode;
+        p.sourceCodeForEvaluation = configureScript->sourceCodeForEvaluation();
+        p.initialProperties = initialProperties;
+        for (const ProbeProperty &b : qAsConst(probeBindings)) {
+            p.bindings.push_back(PendingProbe::Binding{b.first, b.second.toVariant(),
+                                                       probe->propertyDeclaration(b.first)});
+        }
+        p.environment = engine->environment();
+        p.logger = m_logger;
+        p.probeCacheKey = probeCacheKey;
+        return ProbeConstPtr();
     } else if (!resolvedProbe) {
+        const TraceEvent traceEvent("probe", probeId);
         const Evaluator::FileContextScopes fileCtxScopes
                 = m_evaluator->fileContextScopes(configureScript->file());
         engine->currentContext()->pushScope(fileCtxScopes.fileScope);
@@ -2989,7 +3284,11 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
             configureScope.setProperty(b.first, b.second);
         engine->currentContext()->pushScope(configureScope);
         engine->clearRequestedProperties();
+        if (!probeCacheKey.isEmpty())
+            engine->startRecordingFileSystemResults();
         QScriptValue sv = engine->evaluate(configureScript->sourceCodeForEvaluation());
+        if (!probeCacheKey.isEmpty())
+            fileSystemResults = engine->stopRecordingFileSystemResults();
         engine->currentContext()->popScope();
         engine->currentContext()->popScope();
         engine->currentContext()->popScope();
@@ -3027,8 +3326,12 @@ void ModuleLoader::resolveProbe(ProductContext *productContext, Item *parent, It
                                       sourceCode, properties, initialProperties,
                                       importedFilesUsedInConfigure);
         m_currentProbes[probe->location()] << resolvedProbe;
+        if (!probeCacheKey.isEmpty() && !m_parameters.dryRun()) {
+            m_probeCache->insert(probeCacheKey, ProbeCache::Entry{properties,
+                                 importedFilesUsedInConfigure, fileSystemResults});
+        }
     }
-    productContext->info.probes << resolvedProbe;
+    return resolvedProbe;
 }
 
 void ModuleLoader::checkCancelation() const
@@ -70,6 +70,8 @@ namespace Internal {
 class Evaluator;
 class Item;
 class ItemReader;
+class ParseCache;
+class ProbeCache;
 class ProgressObserver;
 class QualifiedId;
 
@@ -100,6 +102,10 @@ struct ModuleLoaderResult
         std::vector<Dependency> usedProducts;
         ModulePropertiesPerGroup modulePropertiesSetInGroups;
         ErrorInfo delayedError;
+
+        // All module files looked at for this product, including the candidates that were
+        // rejected because of their condition, and the JavaScript files they import.
+        Set<QString> moduleFiles;
     };
 
     std::shared_ptr<ItemPool> itemPool;
@@ -128,6 +134,7 @@ public:
     void setOldProductProbes(const QHash<QString, QList<ProbeConstPtr>> &oldProbes);
     void setLastResolveTime(const FileTime &time) { m_lastResolveTime = time; }
     void setStoredProfiles(const QVariantMap &profiles);
+    void setParseCache(ParseCache *parseCache);
     Evaluator *evaluator() const { return m_evaluator; }
 
     ModuleLoaderResult load(const SetupProjectParameters &parameters);
@@ -295,8 +302,11 @@ private:
             const QualifiedId &moduleName, ProductModuleInfo *productModuleInfo);
     void createChildInstances(Item *instance, Item *prototype,
                               QHash<Item *, Item *> *prototypeInstanceMap) const;
+    struct PendingProbe;
     void resolveProbes(ProductContext *productContext, Item *item);
-    void resolveProbe(ProductContext *productContext, Item *parent, Item *probe);
+    ProbeConstPtr resolveProbe(ProductContext *productContext, Item *parent, Item *probe,
+                               std::unique_ptr<PendingProbe> *pendingProbe);
+    void applyPendingProbeResult(PendingProbe &pendingProbe);
     void checkCancelation() const;
     bool checkItemCondition(Item *item, Item *itemToDisable = nullptr);
     QStringList readExtraSearchPaths(Item *item, bool *wasSet = 0);
@@ -375,6 +385,7 @@ private:
     std::multimap<QString, const ProductContext *> m_productsByName;
     SetupProjectParameters m_parameters;
     std::unique_ptr<Settings> m_settings;
+    std::unique_ptr<ProbeCache> m_probeCache;
     Version m_qbsVersion;
     Item *m_tempScopeItem = nullptr;
     qint64 m_elapsedTimeProbes;
@@ -0,0 +1,150 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "parsecache.h"
+
+#include <api/languageinfo.h>
+#include <logging/categories.h>
+#include <tools/version.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+namespace qbs {
+namespace Internal {
+
+static QByteArray magicString()
+{
+    return QByteArrayLiteral("QBSPARSECACHE_1_") + LanguageInfo::qbsVersion().toString().toLatin1();
+}
+
+ParseCache::ParseCache(const QString &filePath) : m_filePath(filePath)
+{
+}
+
+QString ParseCache::deriveFilePath(const QString &buildRoot)
+{
+    return buildRoot + QLatin1String("/.qbs-parse-cache");
+}
+
+QByteArray ParseCache::key(Kind kind, const QByteArray &content)
+{
+    return char(kind) + QCryptographicHash::hash(content, QCryptographicHash::Sha1);
+}
+
+void ParseCache::load()
+{
+    if (m_filePath.isEmpty())
+        return;
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QDataStream stream(&file);
+    QByteArray magic;
+    stream >> magic;
+    if (magic != magicString()) {
+        qCDebug(lcModuleLoader) << "ignoring parse cache" << m_filePath
+                                << "from different qbs version";
+        return;
+    }
+    QHash<QByteArray, QByteArray> entries;
+    stream >> entries;
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(lcModuleLoader) << "ignoring corrupt parse cache" << m_filePath;
+        return;
+    }
+    for (auto it = entries.cbegin(); it != entries.cend(); ++it)
+        m_entries[it.key()].data = it.value();
+}
+
+// Writes the cache if files were parsed. Entries not used in this session are stale
+// or belong to other configurations; they are kept unless they take over the cache.
+void ParseCache::store()
+{
+    if (m_filePath.isEmpty() || !m_hasNewEntries)
+        return;
+    int usedCount = 0;
+    for (const Entry &entry : qAsConst(m_entries)) {
+        if (entry.used)
+            ++usedCount;
+    }
+    const bool keepUnused = m_entries.size() - usedCount <= usedCount;
+    QHash<QByteArray, QByteArray> entries;
+    for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it) {
+        if (it.value().used || keepUnused)
+            entries.insert(it.key(), it.value().data);
+    }
+
+    QDir().mkpath(QFileInfo(m_filePath).path());
+    QSaveFile file(m_filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(lcModuleLoader) << "cannot write parse cache" << m_filePath << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    stream << magicString() << entries;
+    if (!file.commit())
+        qCDebug(lcModuleLoader) << "cannot write parse cache" << m_filePath << file.errorString();
+    m_hasNewEntries = false;
+}
+
+bool ParseCache::find(const QByteArray &key, QByteArray *data)
+{
+    const auto it = m_entries.find(key);
+    if (it == m_entries.end())
+        return false;
+    it.value().used = true;
+    *data = it.value().data;
+    return true;
+}
+
+void ParseCache::insert(const QByteArray &key, const QByteArray &data)
+{
+    Entry &entry = m_entries[key];
+    entry.data = data;
+    entry.used = true;
+    m_hasNewEntries = true;
+}
+
+} // namespace Internal
+} // namespace qbs
@@ -0,0 +1,88 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PARSECACHE_H
+#define QBS_PARSECACHE_H
+
+#include <tools/qbs_export.h>
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+namespace qbs {
+namespace Internal {
+
+/*
+ * Keeps the results of parsing qbs and JavaScript files on disk, so that unchanged files,
+ * in particular those of the module library, do not have to be parsed again on every resolve.
+ * Entries are looked up by the hash of the file contents, so no timestamps are involved.
+ */
+class QBS_AUTOTEST_EXPORT ParseCache
+{
+public:
+    enum class Kind { QbsFile, JsFile };
+
+    ParseCache(const QString &filePath);
+
+    static QString deriveFilePath(const QString &buildRoot);
+    static QByteArray key(Kind kind, const QByteArray &content);
+
+    void load();
+    void store();
+
+    bool find(const QByteArray &key, QByteArray *data);
+    void insert(const QByteArray &key, const QByteArray &data);
+
+private:
+    struct Entry
+    {
+        QByteArray data;
+        bool used = false;
+    };
+
+    const QString m_filePath;
+    QHash<QByteArray, Entry> m_entries;
+    bool m_hasNewEntries = false;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PARSECACHE_H
@@ -0,0 +1,258 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "parsedfile.h"
+
+#include "asttools.h"
+#include "identifiersearch.h"
+#include "value.h"
+
+#include <parser/qmljsast_p.h>
+#include <parser/qmljsastvisitor_p.h>
+#include <tools/qbsassert.h>
+#include <tools/stringconstants.h>
+
+#include <QtCore/qdatastream.h>
+
+using namespace QbsQmlJS;
+
+namespace qbs {
+namespace Internal {
+
+// Records the nodes in the same order in which the item reader used to visit the syntax tree.
+class ParsedFileBuilder : public AST::Visitor
+{
+public:
+    ParsedFileBuilder(ParsedFile &parsedFile) : m_parsedFile(parsedFile) { }
+
+private:
+    bool visit(AST::UiImportList *uiImportList) override
+    {
+        for (const auto *it = uiImportList; it; it = it->next) {
+            const AST::UiImport * const import = it->import;
+            ParsedFile::Import i;
+            if (import->importUri)
+                i.uri = toStringList(import->importUri);
+            i.fileName = import->fileName.toString();
+            i.importId = import->importId.toString();
+            i.importToken = import->importToken;
+            i.fileNameToken = import->fileNameToken;
+            i.versionToken = import->versionToken;
+            i.asToken = import->asToken;
+            i.importIdToken = import->importIdToken;
+            m_parsedFile.imports.push_back(i);
+        }
+        return false;
+    }
+
+    bool visit(AST::UiObjectDefinition *ast) override
+    {
+        ParsedFile::Member begin;
+        begin.type = ParsedFile::MemberType::ObjectBegin;
+        begin.name = toStringList(ast->qualifiedTypeNameId);
+        begin.location = ast->qualifiedTypeNameId->identifierToken;
+        m_parsedFile.members.push_back(begin);
+        if (ast->initializer)
+            ast->initializer->accept(this);
+        m_parsedFile.members.push_back(ParsedFile::Member());
+        return false;
+    }
+
+    bool visit(AST::UiPublicMember *ast) override
+    {
+        ParsedFile::Member m;
+        m.type = ParsedFile::MemberType::PublicMember;
+        m.name = QStringList(ast->name.toString());
+        m.location = ast->colonToken;
+        m.memberType = ast->memberType.toString();
+        m.typeModifier = ast->typeModifier.toString();
+        m.typeToken = ast->typeToken;
+        m.isSignal = ast->type == AST::UiPublicMember::Signal;
+        m.isReadOnly = ast->isReadonlyMember;
+        if (ast->statement)
+            recordValue(ast->statement, m);
+        m_parsedFile.members.push_back(m);
+        return false;
+    }
+
+    bool visit(AST::UiScriptBinding *ast) override
+    {
+        QBS_CHECK(ast->qualifiedId);
+        QBS_CHECK(!ast->qualifiedId->name.isEmpty());
+
+        ParsedFile::Member m;
+        m.type = ParsedFile::MemberType::ScriptBinding;
+        m.name = toStringList(ast->qualifiedId);
+        m.location = ast->qualifiedId->identifierToken;
+        if (m.name.size() == 1 && m.name.front() == QStringLiteral("id")) {
+            const auto * const expStmt = AST::cast<AST::ExpressionStatement *>(ast->statement);
+            const auto * const idExp = expStmt
+                    ? AST::cast<AST::IdentifierExpression *>(expStmt->expression) : nullptr;
+            if (idExp)
+                m.idValue = idExp->name.toString();
+        } else {
+            recordValue(ast->statement, m);
+        }
+        m_parsedFile.members.push_back(m);
+        return false;
+    }
+
+    static void recordValue(AST::Statement *statement, ParsedFile::Member &m)
+    {
+        QBS_CHECK(statement);
+        m.hasValue = true;
+        const AST::SourceLocation first = statement->firstSourceLocation();
+        m.valueLocation = AST::SourceLocation(first.begin(),
+                                              statement->lastSourceLocation().end() - first.begin(),
+                                              first.startLine, first.startColumn);
+        JSSourceValue::Flags flags;
+        if (AST::cast<AST::Block *>(statement))
+            flags |= JSSourceValue::HasFunctionForm;
+
+        bool usesBase, usesOuter, usesOriginal;
+        IdentifierSearch idsearch;
+        idsearch.add(StringConstants::baseVar(), &usesBase);
+        idsearch.add(StringConstants::outerVar(), &usesOuter);
+        idsearch.add(StringConstants::originalVar(), &usesOriginal);
+        idsearch.start(statement);
+        if (usesBase)
+            flags |= JSSourceValue::SourceUsesBase;
+        if (usesOuter)
+            flags |= JSSourceValue::SourceUsesOuter;
+        if (usesOriginal)
+            flags |= JSSourceValue::SourceUsesOriginal;
+        m.valueFlags = flags;
+    }
+
+    ParsedFile &m_parsedFile;
+};
+
+ParsedFile ParsedFile::create(AST::UiProgram *ast)
+{
+    ParsedFile parsedFile;
+    ParsedFileBuilder builder(parsedFile);
+    ast->accept(&builder);
+    return parsedFile;
+}
+
+static QDataStream &operator<<(QDataStream &s, const ParsedFile::SourceLocation &l)
+{
+    return s << l.offset << l.length << l.startLine << l.startColumn;
+}
+
+static QDataStream &operator>>(QDataStream &s, ParsedFile::SourceLocation &l)
+{
+    return s >> l.offset >> l.length >> l.startLine >> l.startColumn;
+}
+
+// Every entry takes up more than one byte, so larger counts can only come from corrupt data.
+static bool loadCount(QDataStream &stream, quint32 *count)
+{
+    stream >> *count;
+    return stream.status() == QDataStream::Ok && *count <= stream.device()->bytesAvailable();
+}
+
+bool ParsedFile::load(QDataStream &stream)
+{
+    quint32 count;
+    if (!loadCount(stream, &count))
+        return false;
+    imports.resize(count);
+    for (Import &i : imports) {
+        stream >> i.uri >> i.fileName >> i.importId >> i.importToken >> i.fileNameToken
+               >> i.versionToken >> i.asToken >> i.importIdToken;
+    }
+    if (!loadCount(stream, &count))
+        return false;
+    members.resize(count);
+    int depth = 0;
+    for (Member &m : members) {
+        quint8 type;
+        stream >> type;
+        if (type > quint8(MemberType::ScriptBinding))
+            return false;
+        m.type = static_cast<MemberType>(type);
+        if (m.type == MemberType::ObjectEnd) {
+            if (--depth < 0)
+                return false;
+            continue;
+        }
+        if (m.type == MemberType::ObjectBegin)
+            ++depth;
+        else if (depth == 0)
+            return false;
+        stream >> m.name >> m.location;
+        if (m.type == MemberType::PublicMember) {
+            stream >> m.memberType >> m.typeModifier >> m.typeToken >> m.isSignal
+                   >> m.isReadOnly;
+        }
+        stream >> m.hasValue;
+        if (m.hasValue)
+            stream >> m.valueLocation >> m.valueFlags;
+        stream >> m.idValue;
+    }
+    return stream.status() == QDataStream::Ok && depth == 0 && !members.empty();
+}
+
+void ParsedFile::store(QDataStream &stream) const
+{
+    stream << quint32(imports.size());
+    for (const Import &i : imports) {
+        stream << i.uri << i.fileName << i.importId << i.importToken << i.fileNameToken
+               << i.versionToken << i.asToken << i.importIdToken;
+    }
+    stream << quint32(members.size());
+    for (const Member &m : members) {
+        stream << static_cast<quint8>(m.type);
+        if (m.type == MemberType::ObjectEnd)
+            continue;
+        stream << m.name << m.location;
+        if (m.type == MemberType::PublicMember) {
+            stream << m.memberType << m.typeModifier << m.typeToken << m.isSignal
+                   << m.isReadOnly;
+        }
+        stream << m.hasValue;
+        if (m.hasValue)
+            stream << m.valueLocation << m.valueFlags;
+        stream << m.idValue;
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
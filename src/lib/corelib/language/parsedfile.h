@@ -0,0 +1,117 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PARSEDFILE_H
+#define QBS_PARSEDFILE_H
+
+#include <parser/qmljsastfwd_p.h>
+
+#include <QtCore/qstringlist.h>
+
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+class QDataStream;
+QT_END_NAMESPACE
+
+namespace qbs {
+namespace Internal {
+
+/*
+ * A compact form of the syntax tree of a qbs file. It contains just the information
+ * ItemReaderASTVisitor needs to create items, which, unlike the full syntax tree,
+ * makes it cheap to store in the ParseCache.
+ */
+class ParsedFile
+{
+public:
+    using SourceLocation = QbsQmlJS::AST::SourceLocation;
+
+    struct Import
+    {
+        QStringList uri; // Empty for file imports.
+        QString fileName;
+        QString importId;
+        SourceLocation importToken;
+        SourceLocation fileNameToken;
+        SourceLocation versionToken;
+        SourceLocation asToken;
+        SourceLocation importIdToken;
+    };
+
+    // Object members appear in the order of the source code, with the members
+    // of an object enclosed in its ObjectBegin and ObjectEnd entries.
+    enum class MemberType : quint8 { ObjectBegin, ObjectEnd, PublicMember, ScriptBinding };
+
+    struct Member
+    {
+        MemberType type = MemberType::ObjectEnd;
+
+        // Type name of objects, qualified id of bindings, name of public members.
+        QStringList name;
+        SourceLocation location;
+
+        // Public members only.
+        QString memberType;
+        QString typeModifier;
+        SourceLocation typeToken;
+        bool isSignal = false;
+        bool isReadOnly = false;
+
+        // The right-hand side of bindings and of public members with an initializer.
+        bool hasValue = false;
+        SourceLocation valueLocation;
+        int valueFlags = 0; // JSSourceValue::Flags
+        QString idValue;    // Only for "id" bindings. Empty if not an identifier.
+    };
+
+    static ParsedFile create(QbsQmlJS::AST::UiProgram *ast);
+
+    // Returns false if the data is not a well-formed ParsedFile.
+    bool load(QDataStream &stream);
+    void store(QDataStream &stream) const;
+
+    std::vector<Import> imports;
+    std::vector<Member> members;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PARSEDFILE_H
@@ -0,0 +1,187 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include "probecache.h"
+
+#include <api/languageinfo.h>
+#include <logging/categories.h>
+#include <tools/fileinfo.h>
+#include <tools/version.h>
+
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qfileinfo.h>
+#include <QtCore/qsavefile.h>
+
+#include <algorithm>
+
+namespace qbs {
+namespace Internal {
+
+static QByteArray magicString()
+{
+    return QByteArrayLiteral("QBSPROBECACHE_1_") + LanguageInfo::qbsVersion().toString().toLatin1();
+}
+
+ProbeCache::ProbeCache(const QString &dirPath) : m_dirPath(dirPath)
+{
+}
+
+QByteArray ProbeCache::key(const QString &filePath, const QString &configureScript,
+                           const QVariantMap &initialProperties,
+                           const QProcessEnvironment &environment)
+{
+    QStringList environmentEntries = environment.toStringList();
+    std::sort(environmentEntries.begin(), environmentEntries.end());
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream << magicString() << filePath << configureScript << initialProperties
+           << environmentEntries;
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+QString ProbeCache::entryFilePath(const QByteArray &key) const
+{
+    return m_dirPath + QLatin1Char('/') + QString::fromLatin1(key);
+}
+
+static bool fileSystemResultsAreValid(const FileSystemResults &results)
+{
+    for (auto it = results.canonicalFilePaths.cbegin(); it != results.canonicalFilePaths.cend();
+         ++it) {
+        if (QFileInfo(it.key()).canonicalFilePath() != it.value())
+            return false;
+    }
+    for (auto it = results.fileExists.cbegin(); it != results.fileExists.cend(); ++it) {
+        if (FileInfo(it.key()).exists() != it.value())
+            return false;
+    }
+    for (auto it = results.directoryEntries.cbegin(); it != results.directoryEntries.cend();
+         ++it) {
+        if (QDir(it.key().first).entryList(static_cast<QDir::Filters>(it.key().second),
+                                           QDir::Name) != it.value()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool ProbeCache::find(const QByteArray &key, Entry *entry) const
+{
+    QFile file(entryFilePath(key));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    QByteArray magic;
+    stream >> magic;
+    if (magic != magicString())
+        return false;
+    Entry newEntry;
+    QStringList importedFilesUsed;
+    QHash<QString, double> fileLastModified;
+    int directoryEntriesCount;
+    stream >> newEntry.properties >> importedFilesUsed
+           >> newEntry.fileSystemResults.canonicalFilePaths
+           >> newEntry.fileSystemResults.fileExists >> fileLastModified >> directoryEntriesCount;
+    for (int i = 0; i < directoryEntriesCount && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        quint32 filters;
+        QStringList entries;
+        stream >> path >> filters >> entries;
+        newEntry.fileSystemResults.directoryEntries.insert(std::make_pair(path, filters),
+                                                           entries);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qCDebug(lcModuleLoader) << "ignoring corrupt probe cache entry" << file.fileName();
+        return false;
+    }
+
+    // The timestamps of the imported files are stored along with the ones the script asked for.
+    for (auto it = fileLastModified.cbegin(); it != fileLastModified.cend(); ++it) {
+        const FileTime lastModified = FileInfo(it.key()).lastModified();
+        if (lastModified.asDouble() != it.value())
+            return false;
+        newEntry.fileSystemResults.fileLastModified.insert(it.key(), lastModified);
+    }
+    if (!fileSystemResultsAreValid(newEntry.fileSystemResults))
+        return false;
+    newEntry.importedFilesUsed = importedFilesUsed.toVector().toStdVector();
+    *entry = newEntry;
+    return true;
+}
+
+void ProbeCache::insert(const QByteArray &key, const Entry &entry) const
+{
+    QHash<QString, double> fileLastModified;
+    for (auto it = entry.fileSystemResults.fileLastModified.cbegin();
+         it != entry.fileSystemResults.fileLastModified.cend(); ++it) {
+        fileLastModified.insert(it.key(), it.value().asDouble());
+    }
+    QStringList importedFilesUsed;
+    for (const QString &filePath : entry.importedFilesUsed) {
+        importedFilesUsed << filePath;
+        fileLastModified.insert(filePath, FileInfo(filePath).lastModified().asDouble());
+    }
+
+    QDir().mkpath(m_dirPath);
+    QSaveFile file(entryFilePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCDebug(lcModuleLoader) << "cannot write probe cache entry" << file.fileName()
+                                << file.errorString();
+        return;
+    }
+    QDataStream stream(&file);
+    const FileSystemResults &results = entry.fileSystemResults;
+    stream << magicString() << entry.properties << importedFilesUsed
+           << results.canonicalFilePaths << results.fileExists << fileLastModified
+           << results.directoryEntries.size();
+    for (auto it = results.directoryEntries.cbegin(); it != results.directoryEntries.cend();
+         ++it) {
+        stream << it.key().first << it.key().second << it.value();
+    }
+    if (!file.commit()) {
+        qCDebug(lcModuleLoader) << "cannot write probe cache entry" << file.fileName()
+                                << file.errorString();
+    }
+}
+
+} // namespace Internal
+} // namespace qbs
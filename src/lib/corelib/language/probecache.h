@@ -0,0 +1,91 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#ifndef QBS_PROBECACHE_H
+#define QBS_PROBECACHE_H
+
+#include "scriptengine.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qprocess.h>
+#include <QtCore/qstring.h>
+#include <QtCore/qvariant.h>
+
+#include <vector>
+
+namespace qbs {
+namespace Internal {
+
+/*
+ * Keeps the results of Probe.configure scripts in a directory that is shared between build
+ * directories and profiles. An entry is used only if the files and directories that the
+ * script queried via the File service still look the same, and if the JavaScript files it
+ * imported have not changed.
+ */
+class ProbeCache
+{
+public:
+    struct Entry
+    {
+        QVariantMap properties;
+        std::vector<QString> importedFilesUsed;
+        FileSystemResults fileSystemResults;
+    };
+
+    ProbeCache(const QString &dirPath);
+
+    bool isEnabled() const { return !m_dirPath.isEmpty(); }
+
+    static QByteArray key(const QString &filePath, const QString &configureScript,
+                          const QVariantMap &initialProperties,
+                          const QProcessEnvironment &environment);
+
+    bool find(const QByteArray &key, Entry *entry) const;
+    void insert(const QByteArray &key, const Entry &entry) const;
+
+private:
+    QString entryFilePath(const QByteArray &key) const;
+
+    const QString m_dirPath;
+};
+
+} // namespace Internal
+} // namespace qbs
+
+#endif // QBS_PROBECACHE_H
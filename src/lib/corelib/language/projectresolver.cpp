@@ -63,8 +63,12 @@
 #include <tools/stringconstants.h>
 
 #include <QtCore/qdir.h>
+#include <QtCore/qrunnable.h>
+#include <QtCore/qset.h>
+#include <QtCore/qthreadpool.h>
 
 #include <algorithm>
+#include <functional>
 #include <queue>
 
 namespace qbs {
@@ -94,7 +98,7 @@ struct ProjectResolver::ProductContext
     Item *item;
     typedef std::pair<ArtifactPropertiesPtr, CodeLocation> ArtifactPropertiesInfo;
     QHash<QStringList, ArtifactPropertiesInfo> artifactPropertiesPerFilter;
-    QHash<QString, CodeLocation> sourceArtifactLocations;
+    std::vector<GroupFiles> groupFiles;
     GroupConstPtr currentGroup;
 };
 
@@ -245,6 +249,7 @@ TopLevelProjectPtr ProjectResolver::resolveTopLevelProject()
     ProjectContext projectContext;
     projectContext.project = project;
     resolveProject(m_loadResult.root, &projectContext);
+    resolvePendingSourceFiles(project.get());
     project->setBuildConfiguration(m_setupParams.finalBuildConfigurationTree());
     project->overriddenValues = m_setupParams.overriddenValues();
     project->canonicalFilePathResults = m_engine->canonicalFilePathResults();
@@ -289,8 +294,10 @@ void ProjectResolver::resolveProject(Item *item, ProjectContext *projectContext)
                                        << projectContext->project->location << error.toString();
             return;
         }
-        if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
+        if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict) {
+            resolvePendingSourceFiles(projectContext->project->topLevelProject());
             throw;
+        }
         m_logger.printWarning(error);
     }
 }
@@ -391,7 +398,7 @@ void ProjectResolver::resolveProduct(Item *item, ProjectContext *projectContext)
     productContext.item = item;
     ResolvedProductPtr product = ResolvedProduct::create();
     product->enabled = projectContext->project->enabled;
-    product->moduleProperties = PropertyMapInternal::create();
+    product->moduleProperties = PropertyMapInternal::create(QVariantMap());
     product->project = projectContext->project;
     productContext.product = product;
     product->location = item->location();
@@ -399,22 +406,67 @@ void ProjectResolver::resolveProduct(Item *item, ProjectContext *projectContext)
     try {
         resolveProductFully(item, projectContext);
     } catch (const ErrorInfo &e) {
-        QString mainErrorString = !product->name.isEmpty()
-                ? Tr::tr("Error while handling product '%1':").arg(product->name)
-                : Tr::tr("Error while handling product:");
-        ErrorInfo fullError(mainErrorString, item->location());
-        appendError(fullError, e);
-        if (!product->enabled) {
-            qCDebug(lcProjectResolver) << fullError.toString();
-            return;
-        }
-        if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
-            throw fullError;
-        m_logger.printWarning(fullError);
-        m_logger.printWarning(ErrorInfo(Tr::tr("Product '%1' had errors and was disabled.")
-                                        .arg(product->name), item->location()));
-        product->enabled = false;
+        if (product->enabled && m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
+            resolvePendingSourceFiles(projectContext->project->topLevelProject());
+        handleProductError(e, product);
     }
+    m_productFiles.push_back(ProductFiles{product, std::move(productContext.groupFiles)});
+}
+
+void ProjectResolver::handleProductError(const ErrorInfo &error,
+                                         const ResolvedProductPtr &product)
+{
+    QString mainErrorString = !product->name.isEmpty()
+            ? Tr::tr("Error while handling product '%1':").arg(product->name)
+            : Tr::tr("Error while handling product:");
+    ErrorInfo fullError(mainErrorString, product->location);
+    appendError(fullError, error);
+    if (!product->enabled) {
+        qCDebug(lcProjectResolver) << fullError.toString();
+        return;
+    }
+    if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
+        throw fullError;
+    m_logger.printWarning(fullError);
+    m_logger.printWarning(ErrorInfo(Tr::tr("Product '%1' had errors and was disabled.")
+                                    .arg(product->name), product->location));
+    product->enabled = false;
+}
+
+static void gatherBuildSystemFiles(const Item *item, Set<const Item *> &seenItems,
+                                   Set<QString> &files)
+{
+    if (!item || seenItems.contains(item))
+        return;
+    seenItems.insert(item);
+    if (item->file()) {
+        files.insert(item->file()->filePath());
+        for (const JsImport &jsImport : item->file()->jsImports())
+            files.unite(Set<QString>::fromList(jsImport.filePaths));
+    }
+    gatherBuildSystemFiles(item->prototype(), seenItems, files);
+    for (const Item::Module &module : item->modules())
+        gatherBuildSystemFiles(module.item, seenItems, files);
+    for (const Item * const child : item->children())
+        gatherBuildSystemFiles(child, seenItems, files);
+}
+
+// The files that can influence the outcome of resolving the product: the ones of the product
+// item itself, its base items, its children, all its modules including the Export items of
+// its dependencies, all module files the module loader considered for it, and those of the
+// enclosing projects.
+static Set<QString> buildSystemFilesOfProduct(const Item *productItem,
+                                              const ResolvedProduct *product,
+                                              const ModuleLoaderResult::ProductInfo &productInfo)
+{
+    Set<QString> files = productInfo.moduleFiles;
+    Set<const Item *> seenItems;
+    gatherBuildSystemFiles(productItem, seenItems, files);
+    for (const ResolvedProject *project = product->project.get(); project;
+         project = project->parentProject.get()) {
+        files.insert(project->location.filePath());
+    }
+    return files;
 }
 
 void ProjectResolver::resolveProductFully(Item *item, ProjectContext *projectContext)
@@ -436,6 +488,7 @@ void ProjectResolver::resolveProductFully(Item *item, ProjectContext *projectCon
     product->enabled = product->enabled
             && m_evaluator->boolValue(item, StringConstants::conditionProperty());
     ModuleLoaderResult::ProductInfo &pi = m_loadResult.productInfos[item];
+    product->buildSystemFiles = buildSystemFilesOfProduct(item, product.get(), pi);
     if (pi.delayedError.hasError()) {
         ErrorInfo errorInfo;
 
@@ -690,8 +743,7 @@ void ProjectResolver::resolveGroupFully(Item *item, ProjectResolver::ProjectCont
     const QVariantMap newModuleProperties
             = resolveAdditionalModuleProperties(item, moduleProperties->value());
     if (!newModuleProperties.empty()) {
-        moduleProperties = PropertyMapInternal::create();
-        moduleProperties->setValue(newModuleProperties);
+        moduleProperties = PropertyMapInternal::create(newModuleProperties);
     }
 
     AccumulatingTimer groupTimer(m_setupParams.logElapsedTime()
@@ -759,12 +811,16 @@ void ProjectResolver::resolveGroupFully(Item *item, ProjectResolver::ProjectCont
         group->fileTags.unite(m_productContext->currentGroup->fileTags);
     }
 
-    const CodeLocation filesLocation = item->property(StringConstants::filesProperty())->location();
     const VariantValueConstPtr moduleProp = item->variantProperty(
                 StringConstants::modulePropertyInternal());
     if (moduleProp)
         group->targetOfModule = moduleProp->value().toString();
-    ErrorInfo fileError;
+
+    // The source artifacts are created in resolveSourceFiles().
+    GroupFiles groupFiles;
+    groupFiles.group = group;
+    groupFiles.files = files;
+    groupFiles.filesLocation = item->property(StringConstants::filesProperty())->location();
     if (!patterns.empty()) {
         group->wildcards = std::unique_ptr<SourceWildCards>(new SourceWildCards);
         SourceWildCards *wildcards = group->wildcards.get();
@@ -772,27 +828,10 @@ void ProjectResolver::resolveGroupFully(Item *item, ProjectResolver::ProjectCont
         wildcards->excludePatterns = m_evaluator->stringListValue(
                     item, StringConstants::excludeFilesProperty());
         wildcards->patterns = patterns;
-        const Set<QString> files = wildcards->expandPatterns(group,
-                FileInfo::path(item->file()->filePath()),
-                projectContext->project->topLevelProject()->buildDirectory);
-        for (const QString &fileName : files)
-            createSourceArtifact(m_productContext->product, fileName, group, true, filesLocation,
-                                 &m_productContext->sourceArtifactLocations, &fileError);
+        groupFiles.wildcardBaseDir = FileInfo::path(item->file()->filePath());
     }
+    m_productContext->groupFiles.push_back(groupFiles);
 
-    for (const QString &fileName : files) {
-        createSourceArtifact(m_productContext->product, fileName, group, false, filesLocation,
-                             &m_productContext->sourceArtifactLocations, &fileError);
-    }
-    if (fileError.hasError()) {
-        if (group->enabled) {
-            if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
-                throw ErrorInfo(fileError);
-            m_logger.printWarning(fileError);
-        } else {
-            qCDebug(lcProjectResolver) << "error for disabled group:" << fileError.toString();
-        }
-    }
     group->name = m_evaluator->stringValue(item, StringConstants::nameProperty());
     if (group->name.isEmpty())
         group->name = Tr::tr("Group %1").arg(m_productContext->product->groups.size());
@@ -814,6 +853,93 @@ void ProjectResolver::resolveGroupFully(Item *item, ProjectResolver::ProjectCont
         resolveGroup(childItem, projectContext);
 }
 
+namespace {
+class WildcardExpansionRunnable : public QRunnable
+{
+public:
+    WildcardExpansionRunnable(const std::function<void()> &expand) : m_expand(expand) {}
+
+private:
+    void run() override { m_expand(); }
+
+    const std::function<void()> m_expand;
+};
+} // namespace
+
+// Expanding wildcards needs only the file system, not the script engine, so it is done
+// for the groups of all products at once on a thread pool. The artifacts are then created
+// in the original order of the groups, so duplicates are detected as before.
+// This is also called when an error is about to abort the resolving, because the files
+// of the products resolved before must be checked first in order to report the same
+// error that a strictly sequential resolving would have found.
+void ProjectResolver::resolvePendingSourceFiles(const TopLevelProject *project)
+{
+    std::vector<ProductFiles> pendingProductFiles;
+    std::swap(pendingProductFiles, m_productFiles);
+    AccumulatingTimer groupTimer(m_setupParams.logElapsedTime()
+                                       ? &m_elapsedTimeGroups : nullptr);
+    std::vector<GroupFiles *> wildcardGroups;
+    for (ProductFiles &productFiles : pendingProductFiles) {
+        for (GroupFiles &groupFiles : productFiles.groups) {
+            if (groupFiles.group->wildcards)
+                wildcardGroups.push_back(&groupFiles);
+        }
+    }
+    const QString &buildDir = project->buildDirectory;
+    const auto expandWildcards = [&buildDir](GroupFiles *groupFiles) {
+        groupFiles->wildcardFiles = groupFiles->group->wildcards->expandPatterns(
+                    groupFiles->group, groupFiles->wildcardBaseDir, buildDir);
+    };
+    if (wildcardGroups.size() > 1) {
+        qCDebug(lcProjectResolver) << "expanding wildcards of" << wildcardGroups.size()
+                                   << "groups concurrently";
+        QThreadPool threadPool;
+        for (GroupFiles * const groupFiles : wildcardGroups) {
+            threadPool.start(new WildcardExpansionRunnable([&expandWildcards, groupFiles] {
+                expandWildcards(groupFiles);
+            }));
+        }
+        threadPool.waitForDone();
+    } else {
+        for (GroupFiles * const groupFiles : wildcardGroups)
+            expandWildcards(groupFiles);
+    }
+
+    for (const ProductFiles &productFiles : qAsConst(pendingProductFiles)) {
+        checkCancelation();
+        QHash<QString, CodeLocation> fileLocations;
+        try {
+            for (const GroupFiles &groupFiles : productFiles.groups)
+                createSourceArtifacts(productFiles.product, groupFiles, &fileLocations);
+        } catch (const ErrorInfo &e) {
+            handleProductError(e, productFiles.product);
+        }
+    }
+}
+
+void ProjectResolver::createSourceArtifacts(const ResolvedProductPtr &product,
+        const GroupFiles &groupFiles, QHash<QString, CodeLocation> *fileLocations)
+{
+    const GroupPtr &group = groupFiles.group;
+    ErrorInfo fileError;
+    for (const QString &fileName : groupFiles.wildcardFiles) {
+        createSourceArtifact(product, fileName, group, true, groupFiles.filesLocation,
+                             fileLocations, &fileError);
+    }
+    for (const QString &fileName : groupFiles.files) {
+        createSourceArtifact(product, fileName, group, false, groupFiles.filesLocation,
+                             fileLocations, &fileError);
+    }
+    if (fileError.hasError()) {
+        if (group->enabled) {
+            if (m_setupParams.productErrorMode() == ErrorHandlingMode::Strict)
+                throw ErrorInfo(fileError);
+            m_logger.printWarning(fileError);
+        } else {
+            qCDebug(lcProjectResolver) << "error for disabled group:" << fileError.toString();
+        }
+    }
+}
 
 QString ProjectResolver::sourceCodeAsFunction(const JSSourceValueConstPtr &value,
                                               const PropertyDeclaration &decl) const
@@ -907,6 +1033,7 @@ void ProjectResolver::resolveRule(Item *item, ProjectContext *projectContext)
 
     rule->multiplex = m_evaluator->boolValue(item, StringConstants::multiplexProperty());
     rule->alwaysRun = m_evaluator->boolValue(item, StringConstants::alwaysRunProperty());
+    rule->jobPool = m_evaluator->stringValue(item, StringConstants::jobPoolProperty());
     rule->inputs = m_evaluator->fileTagsValue(item, StringConstants::inputsProperty());
     rule->inputsFromDependencies
             = m_evaluator->fileTagsValue(item, StringConstants::inputsFromDependenciesProperty());
@@ -1198,6 +1325,7 @@ void ProjectResolver::resolveProductDependencies(const ProjectContext &projectCo
             disabledDependency = true;
         for (const auto &dep : depInfos.dependencies) {
             rproduct->dependencies.insert(dep.product);
+            rproduct->buildSystemFiles.insert(dep.product->location.filePath());
             if (!dep.parameters.empty())
                 rproduct->dependencyParameters.insert(dep.product, dep.parameters);
         }
@@ -1360,7 +1488,8 @@ void ProjectResolver::createProductConfig(ResolvedProduct *product)
 {
     EvalCacheEnabler cachingEnabler(m_evaluator);
     m_evaluator->setPathPropertiesBaseDir(m_productContext->product->sourceDirectory);
-    product->moduleProperties->setValue(evaluateModuleValues(m_productContext->item));
+    product->moduleProperties = PropertyMapInternal::create(
+                evaluateModuleValues(m_productContext->item));
     product->productProperties = evaluateProperties(m_productContext->item, m_productContext->item,
                                                     QVariantMap());
     m_evaluator->clearPathPropertiesBaseDir();
@@ -53,6 +53,7 @@
 #include <QtCore/qstringlist.h>
 
 #include <utility>
+#include <vector>
 
 namespace qbs {
 namespace Internal {
@@ -86,6 +87,21 @@ private:
     struct ModuleContext;
     class ProductContextSwitcher;
 
+    struct GroupFiles
+    {
+        GroupPtr group;
+        QStringList files;
+        QString wildcardBaseDir;
+        Set<QString> wildcardFiles;
+        CodeLocation filesLocation;
+    };
+
+    struct ProductFiles
+    {
+        ResolvedProductPtr product;
+        std::vector<GroupFiles> groups;
+    };
+
     void checkCancelation() const;
     QString verbatimValue(const ValueConstPtr &value, bool *propertyWasSet = 0) const;
     QString verbatimValue(Item *item, const QString &name, bool *propertyWasSet = 0) const;
@@ -98,6 +114,7 @@ private:
     void resolveSubProject(Item *item, ProjectContext *projectContext);
     void resolveProduct(Item *item, ProjectContext *projectContext);
     void resolveProductFully(Item *item, ProjectContext *projectContext);
+    void handleProductError(const ErrorInfo &error, const ResolvedProductPtr &product);
     void resolveModules(const Item *item, ProjectContext *projectContext);
     void resolveModule(const QualifiedId &moduleName, Item *item, bool isProduct,
                        const QVariantMap &parameters, ProjectContext *projectContext);
@@ -106,6 +123,9 @@ private:
                                                   const QVariantMap &currentValues);
     void resolveGroup(Item *item, ProjectContext *projectContext);
     void resolveGroupFully(Item *item, ProjectContext *projectContext, bool isEnabled);
+    void resolvePendingSourceFiles(const TopLevelProject *project);
+    void createSourceArtifacts(const ResolvedProductPtr &product, const GroupFiles &groupFiles,
+                               QHash<QString, CodeLocation> *fileLocations);
     void resolveRule(Item *item, ProjectContext *projectContext);
     void resolveRuleArtifact(const RulePtr &rule, Item *item);
     void resolveRuleArtifactBinding(const RuleArtifactPtr &ruleArtifact, Item *item,
@@ -159,6 +179,7 @@ private:
     QMap<QString, ResolvedProductPtr> m_productsByName;
     QHash<FileTag, QList<ResolvedProductPtr> > m_productsByType;
     QHash<ResolvedProductPtr, Item *> m_productItemMap;
+    std::vector<ProductFiles> m_productFiles;
     mutable QHash<FileContextConstPtr, ResolvedFileContextPtr> m_fileContextMap;
     mutable QHash<CodeLocation, ScriptFunctionPtr> m_scriptFunctionMap;
     mutable QHash<std::pair<QStringRef, QStringList>, QString> m_scriptFunctions;
@@ -44,9 +44,173 @@
 #include <tools/scripttools.h>
 #include <tools/stringconstants.h>
 
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <vector>
+
 namespace qbs {
 namespace Internal {
 
+static uint combinedHash(uint seed, uint hash)
+{
+    return seed ^ (hash + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+static uint variantHash(const QVariant &value);
+
+static uint variantMapHash(const QVariantMap &map)
+{
+    uint hash = 0;
+    for (auto it = map.cbegin(); it != map.cend(); ++it) {
+        hash = combinedHash(hash, qHash(it.key()));
+        hash = combinedHash(hash, variantHash(it.value()));
+    }
+    return hash;
+}
+
+static uint variantHash(const QVariant &value)
+{
+    switch (static_cast<QMetaType::Type>(value.userType())) {
+    case QMetaType::QString:
+        return qHash(value.toString());
+    case QMetaType::QStringList: {
+        uint hash = QMetaType::QStringList;
+        for (const QString &s : value.toStringList())
+            hash = combinedHash(hash, qHash(s));
+        return hash;
+    }
+    case QMetaType::QVariantList: {
+        uint hash = QMetaType::QVariantList;
+        for (const QVariant &v : value.toList())
+            hash = combinedHash(hash, variantHash(v));
+        return hash;
+    }
+    case QMetaType::QVariantMap:
+        return variantMapHash(value.toMap());
+    case QMetaType::Bool:
+        return qHash(value.toBool());
+    case QMetaType::Int:
+        return qHash(value.toInt());
+    default:
+        // Equal values are still found via the comparison in the hash bucket.
+        return qHash(value.userType());
+    }
+}
+
+// QVariant's operator== converts between types, e.g. 1 == "1" == true. Maps that differ
+// in this way must not be merged, so the types have to be compared as well.
+static bool isIdentical(const QVariant &v1, const QVariant &v2);
+
+static bool isIdentical(const QVariantMap &m1, const QVariantMap &m2)
+{
+    // Implicitly shared copies are identical without looking at their contents.
+    if (m1.isSharedWith(m2))
+        return true;
+    if (m1.size() != m2.size())
+        return false;
+    for (auto it1 = m1.cbegin(), it2 = m2.cbegin(); it1 != m1.cend(); ++it1, ++it2) {
+        if (it1.key() != it2.key() || !isIdentical(it1.value(), it2.value()))
+            return false;
+    }
+    return true;
+}
+
+static bool isIdentical(const QVariant &v1, const QVariant &v2)
+{
+    if (v1.userType() != v2.userType())
+        return false;
+    switch (static_cast<QMetaType::Type>(v1.userType())) {
+    case QMetaType::QVariantList: {
+        const QVariantList l1 = v1.toList();
+        const QVariantList l2 = v2.toList();
+        if (l1.isSharedWith(l2))
+            return true;
+        if (l1.size() != l2.size())
+            return false;
+        for (int i = 0; i < l1.size(); ++i) {
+            if (!isIdentical(l1.at(i), l2.at(i)))
+                return false;
+        }
+        return true;
+    }
+    case QMetaType::QVariantMap:
+        return isIdentical(v1.toMap(), v2.toMap());
+    default:
+        return v1 == v2;
+    }
+}
+
+namespace {
+
+// Knows all property maps that are currently alive, so that a map with the same content
+// as an existing one can be shared instead of being created anew.
+class PropertyMapRegistry
+{
+public:
+    PropertyMapPtr find(uint hash, const QVariantMap &value)
+    {
+        auto bucket = m_maps.find(hash);
+        if (bucket == m_maps.end())
+            return PropertyMapPtr();
+        std::vector<std::weak_ptr<PropertyMapInternal>> &candidates = bucket.value();
+        for (auto it = candidates.begin(); it != candidates.end();) {
+            const PropertyMapPtr candidate = it->lock();
+            if (!candidate) {
+                it = candidates.erase(it);
+                --m_entryCount;
+                continue;
+            }
+            if (isIdentical(candidate->value(), value))
+                return candidate;
+            ++it;
+        }
+        if (candidates.empty())
+            m_maps.erase(bucket);
+        return PropertyMapPtr();
+    }
+
+    void add(uint hash, const PropertyMapPtr &map)
+    {
+        m_maps[hash].push_back(map);
+        if (++m_entryCount > m_sweepThreshold)
+            removeExpiredEntries();
+    }
+
+    std::mutex mutex;
+
+private:
+    // Entries of destroyed maps are dropped when their bucket is visited. Buckets that are
+    // never visited again are cleaned up here, at amortized constant cost per insertion.
+    void removeExpiredEntries()
+    {
+        for (auto bucket = m_maps.begin(); bucket != m_maps.end();) {
+            std::vector<std::weak_ptr<PropertyMapInternal>> &candidates = bucket.value();
+            const auto firstExpired = std::remove_if(candidates.begin(), candidates.end(),
+                    [](const std::weak_ptr<PropertyMapInternal> &map) { return map.expired(); });
+            m_entryCount -= std::distance(firstExpired, candidates.end());
+            candidates.erase(firstExpired, candidates.end());
+            if (candidates.empty())
+                bucket = m_maps.erase(bucket);
+            else
+                ++bucket;
+        }
+        m_sweepThreshold = std::max<std::size_t>(1024, 2 * m_entryCount);
+    }
+
+    QHash<uint, std::vector<std::weak_ptr<PropertyMapInternal>>> m_maps;
+    std::size_t m_entryCount = 0;
+    std::size_t m_sweepThreshold = 1024;
+};
+
+PropertyMapRegistry &propertyMapRegistry()
+{
+    static PropertyMapRegistry registry;
+    return registry;
+}
+
+} // namespace
+
 /*!
  * \class PropertyMapInternal
  * \brief The \c PropertyMapInternal class contains a set of properties and their values.
@@ -54,7 +218,9 @@ namespace Internal {
  * \c ResolvedGroups inherit their properties from the respective \c ResolvedProduct, \c SourceArtifacts
  * inherit theirs from the respective \c ResolvedGroup. \c ResolvedGroups can override the value of an
  * inherited property, \c SourceArtifacts cannot. If a property value is overridden, a new
- * \c PropertyMapInternal object is allocated, otherwise the pointer is shared.
+ * \c PropertyMapInternal object is needed, unless a map with the same content exists already.
+ * Property maps are immutable and shared between all their users, which also means that every
+ * distinct map gets stored only once in the build graph file.
  * \sa ResolvedGroup
  * \sa ResolvedProduct
  * \sa SourceArtifact
@@ -63,14 +229,25 @@ PropertyMapInternal::PropertyMapInternal()
 {
 }
 
-PropertyMapInternal::PropertyMapInternal(const PropertyMapInternal &other) : m_value(other.m_value)
+PropertyMapPtr PropertyMapInternal::create(const QVariantMap &value)
 {
+    const uint hash = variantMapHash(value);
+    PropertyMapRegistry &registry = propertyMapRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    PropertyMapPtr map = registry.find(hash, value);
+    if (!map) {
+        map = create();
+        map->setValue(value);
+        registry.add(hash, map);
+    }
+    return map;
 }
 
 QVariant PropertyMapInternal::moduleProperty(const QString &moduleName,
                                                   const QString &key) const
 {
-    return ::qbs::Internal::moduleProperty(m_value, moduleName, key);
+    const auto it = m_moduleValues.constFind(moduleName);
+    return it != m_moduleValues.cend() ? it.value().value(key) : QVariant();
 }
 
 QVariant PropertyMapInternal::qbsPropertyValue(const QString &key) const
@@ -86,11 +263,20 @@ QVariant PropertyMapInternal::property(const QStringList &name) const
 void PropertyMapInternal::setValue(const QVariantMap &map)
 {
     m_value = map;
+    m_moduleValues.clear();
+    for (auto it = m_value.cbegin(); it != m_value.cend(); ++it) {
+        if (it.value().userType() == QMetaType::QVariantMap)
+            m_moduleValues.insert(it.key(), it.value().toMap());
+    }
 }
 
 void PropertyMapInternal::load(PersistentPool &pool)
 {
-    pool.load(m_value);
+    setValue(pool.load<QVariantMap>());
+    const uint hash = variantMapHash(m_value);
+    PropertyMapRegistry &registry = propertyMapRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.add(hash, shared_from_this());
 }
 
 void PropertyMapInternal::store(PersistentPool &pool) const
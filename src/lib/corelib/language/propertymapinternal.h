@@ -42,38 +42,47 @@
 
 #include "forward_decls.h"
 #include <tools/qbs_export.h>
+
+#include <QtCore/qhash.h>
 #include <QtCore/qvariant.h>
 
+#include <memory>
+
 namespace qbs {
 namespace Internal {
 
 class QBS_AUTOTEST_EXPORT PropertyMapInternal
+        : public std::enable_shared_from_this<PropertyMapInternal>
 {
 public:
-    static PropertyMapPtr create() { return PropertyMapPtr(new PropertyMapInternal); }
-    PropertyMapPtr clone() const { return PropertyMapPtr(new PropertyMapInternal(*this)); }
+    // Property maps with the same content are represented by the same object, so a map
+    // cannot be changed after it has been created.
+    static PropertyMapPtr create(const QVariantMap &value);
 
     const QVariantMap &value() const { return m_value; }
     QVariant moduleProperty(const QString &moduleName, const QString &key) const;
     QVariant qbsPropertyValue(const QString &key) const; // Convenience function.
     QVariant property(const QStringList &name) const;
-    void setValue(const QVariantMap &value);
 
     void load(PersistentPool &);
     void store(PersistentPool &) const;
 
 private:
+    friend class PersistentPool;
     friend bool operator==(const PropertyMapInternal &lhs, const PropertyMapInternal &rhs);
 
+    static PropertyMapPtr create() { return PropertyMapPtr(new PropertyMapInternal); }
+
     PropertyMapInternal();
-    PropertyMapInternal(const PropertyMapInternal &other);
+    void setValue(const QVariantMap &value);
 
     QVariantMap m_value;
+    QHash<QString, QVariantMap> m_moduleValues; // For faster lookup of module properties.
 };
 
 inline bool operator==(const PropertyMapInternal &lhs, const PropertyMapInternal &rhs)
 {
-    return lhs.m_value == rhs.m_value;
+    return &lhs == &rhs || lhs.m_value == rhs.m_value;
 }
 
 QVariant QBS_AUTOTEST_EXPORT moduleProperty(const QVariantMap &properties,
@@ -201,6 +201,11 @@ void ScriptEngine::clearImportsCache()
     m_jsImportCache.clear();
 }
 
+void ScriptEngine::setParseCache(ParseCache *parseCache)
+{
+    m_scriptImporter->setParseCache(parseCache);
+}
+
 void ScriptEngine::checkContext(const QString &operation,
                                 const DubiousContextList &dubiousContexts)
 {
@@ -563,24 +568,72 @@ void ScriptEngine::addCanonicalFilePathResult(const QString &filePath,
                                               const QString &resultFilePath)
 {
     m_canonicalFilePathResult.insert(filePath, resultFilePath);
+    if (m_recordedFileSystemResults)
+        m_recordedFileSystemResults->canonicalFilePaths.insert(filePath, resultFilePath);
 }
 
 void ScriptEngine::addFileExistsResult(const QString &filePath, bool exists)
 {
     m_fileExistsResult.insert(filePath, exists);
+    if (m_recordedFileSystemResults)
+        m_recordedFileSystemResults->fileExists.insert(filePath, exists);
 }
 
 void ScriptEngine::addDirectoryEntriesResult(const QString &path, QDir::Filters filters,
                                              const QStringList &entries)
 {
-    m_directoryEntriesResult.insert(
-                std::pair<QString, quint32>(path, static_cast<quint32>(filters)),
-                entries);
+    const std::pair<QString, quint32> key(path, static_cast<quint32>(filters));
+    m_directoryEntriesResult.insert(key, entries);
+    if (m_recordedFileSystemResults)
+        m_recordedFileSystemResults->directoryEntries.insert(key, entries);
 }
 
 void ScriptEngine::addFileLastModifiedResult(const QString &filePath, const FileTime &fileTime)
 {
     m_fileLastModifiedResult.insert(filePath, fileTime);
+    if (m_recordedFileSystemResults)
+        m_recordedFileSystemResults->fileLastModified.insert(filePath, fileTime);
+}
+
+void ScriptEngine::addFileSystemResults(const FileSystemResults &results)
+{
+    for (auto it = results.canonicalFilePaths.cbegin(); it != results.canonicalFilePaths.cend();
+         ++it) {
+        addCanonicalFilePathResult(it.key(), it.value());
+    }
+    for (auto it = results.fileExists.cbegin(); it != results.fileExists.cend(); ++it)
+        addFileExistsResult(it.key(), it.value());
+    for (auto it = results.directoryEntries.cbegin(); it != results.directoryEntries.cend();
+         ++it) {
+        addDirectoryEntriesResult(it.key().first, static_cast<QDir::Filters>(it.key().second),
+                                  it.value());
+    }
+    for (auto it = results.fileLastModified.cbegin(); it != results.fileLastModified.cend(); ++it)
+        addFileLastModifiedResult(it.key(), it.value());
+}
+
+void ScriptEngine::startRecordingFileSystemResults()
+{
+    m_recordedFileSystemResults.reset(new FileSystemResults);
+}
+
+FileSystemResults ScriptEngine::stopRecordingFileSystemResults()
+{
+    QBS_CHECK(m_recordedFileSystemResults);
+    const FileSystemResults results = *m_recordedFileSystemResults;
+    m_recordedFileSystemResults.reset();
+    return results;
+}
+
+QScriptValue ScriptEngine::evaluateCachedProgram(const QString &sourceCode,
+                                                 const QString &fileName, int lineNumber)
+{
+    QScriptProgram &program = m_programCache[sourceCode];
+    if (program.isNull() || program.fileName() != fileName
+            || program.firstLineNumber() != lineNumber) {
+        program = QScriptProgram(sourceCode, fileName, lineNumber);
+    }
+    return evaluate(program);
 }
 
 Set<QString> ScriptEngine::imports() const
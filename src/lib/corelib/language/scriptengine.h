@@ -54,6 +54,7 @@
 #include <QtCore/qstring.h>
 
 #include <QtScript/qscriptengine.h>
+#include <QtScript/qscriptprogram.h>
 
 #include <memory>
 #include <stack>
@@ -65,11 +66,22 @@ namespace qbs {
 namespace Internal {
 class Artifact;
 class JsImport;
+class ParseCache;
 class PrepareScriptObserver;
 class ScriptImporter;
 class ScriptPropertyObserver;
 
 enum class EvalContext { PropertyEvaluation, ProbeExecution, RuleExecution, JsCommand };
+
+// The results of the file system queries that scripts make via the File service.
+struct FileSystemResults
+{
+    QHash<QString, QString> canonicalFilePaths;
+    QHash<QString, bool> fileExists;
+    QHash<std::pair<QString, quint32>, QStringList> directoryEntries;
+    QHash<QString, FileTime> fileLastModified;
+};
+
 class DubiousContext
 {
 public:
@@ -104,6 +116,7 @@ public:
     void import(const FileContextBaseConstPtr &fileCtx, QScriptValue &targetObject,
                 ObserveMode observeMode);
     void clearImportsCache();
+    void setParseCache(ParseCache *parseCache);
 
     void setEvalContext(EvalContext c) { m_evalContext = c; }
     EvalContext evalContext() const { return m_evalContext; }
@@ -157,10 +170,18 @@ public:
     }
 
     QHash<QString, FileTime> fileLastModifiedResults() const { return m_fileLastModifiedResult; }
+    void addFileSystemResults(const FileSystemResults &results);
+    void startRecordingFileSystemResults();
+    FileSystemResults stopRecordingFileSystemResults();
     Set<QString> imports() const;
     static QScriptValueList argumentList(const QStringList &argumentNames,
             const QScriptValue &context);
 
+    // For code that is evaluated again and again, such as rule bindings and the source code
+    // of JavaScriptCommands. It is parsed only once per engine.
+    QScriptValue evaluateCachedProgram(const QString &sourceCode,
+                                       const QString &fileName = QString(), int lineNumber = 1);
+
     QStringList uncaughtExceptionBacktraceOrEmpty() const {
         return hasUncaughtException() ? uncaughtExceptionBacktrace() : QStringList();
     }
@@ -260,6 +281,8 @@ private:
     QHash<QString, bool> m_fileExistsResult;
     QHash<std::pair<QString, quint32>, QStringList> m_directoryEntriesResult;
     QHash<QString, FileTime> m_fileLastModifiedResult;
+    std::unique_ptr<FileSystemResults> m_recordedFileSystemResults;
+    QHash<QString, QScriptProgram> m_programCache;
     std::stack<QString> m_currentDirPathStack;
     std::stack<QStringList> m_extensionSearchPathsStack;
     QScriptValue m_loadFileFunction;
@@ -295,6 +318,20 @@ private:
     const EvalContext m_oldContext;
 };
 
+class ParseCacheSetter
+{
+public:
+    ParseCacheSetter(ScriptEngine *engine, ParseCache *parseCache) : m_engine(engine)
+    {
+        engine->setParseCache(parseCache);
+    }
+
+    ~ParseCacheSetter() { m_engine->setParseCache(nullptr); }
+
+private:
+    ScriptEngine * const m_engine;
+};
+
 } // namespace Internal
 } // namespace qbs
 
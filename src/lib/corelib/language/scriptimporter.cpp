@@ -39,6 +39,7 @@
 
 #include "scriptimporter.h"
 
+#include "parsecache.h"
 #include "scriptengine.h"
 
 #include <parser/qmljsastfwd_p.h>
@@ -141,18 +142,30 @@ void ScriptImporter::importSourceCode(const QString &sourceCode, const QString &
 
     QString &code = m_sourceCodeCache[filePath];
     if (code.isEmpty()) {
-        QbsQmlJS::Engine engine;
-        QbsQmlJS::Lexer lexer(&engine);
-        lexer.setCode(sourceCode, 1, false);
-        QbsQmlJS::Parser parser(&engine);
-        if (!parser.parseProgram()) {
-            throw ErrorInfo(parser.errorMessage(), CodeLocation(filePath, parser.errorLineNumber(),
-                                                                parser.errorColumnNumber()));
+        const QByteArray cacheKey = m_parseCache
+                ? ParseCache::key(ParseCache::Kind::JsFile, sourceCode.toUtf8()) : QByteArray();
+        QByteArray cachedSuffix;
+        QString suffix;
+        if (m_parseCache && m_parseCache->find(cacheKey, &cachedSuffix)) {
+            suffix = QString::fromUtf8(cachedSuffix);
+        } else {
+            QbsQmlJS::Engine engine;
+            QbsQmlJS::Lexer lexer(&engine);
+            lexer.setCode(sourceCode, 1, false);
+            QbsQmlJS::Parser parser(&engine);
+            if (!parser.parseProgram()) {
+                throw ErrorInfo(parser.errorMessage(),
+                                CodeLocation(filePath, parser.errorLineNumber(),
+                                             parser.errorColumnNumber()));
+            }
+
+            IdentifierExtractor extractor;
+            extractor.start(parser.rootNode());
+            suffix = extractor.suffix();
+            if (m_parseCache)
+                m_parseCache->insert(cacheKey, suffix.toUtf8());
         }
-
-        IdentifierExtractor extractor;
-        extractor.start(parser.rootNode());
-        code = QLatin1String("(function(){\n") + sourceCode + extractor.suffix();
+        code = QLatin1String("(function(){\n") + sourceCode + suffix;
     }
 
     QScriptValue result = m_engine->evaluate(code, filePath, 0);
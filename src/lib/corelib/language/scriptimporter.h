@@ -47,18 +47,21 @@
 namespace qbs {
 namespace Internal {
 
+class ParseCache;
 class ScriptEngine;
 
 class ScriptImporter
 {
 public:
     ScriptImporter(ScriptEngine *scriptEngine);
+    void setParseCache(ParseCache *parseCache) { m_parseCache = parseCache; }
     void importSourceCode(const QString &sourceCode, const QString &filePath, QScriptValue &targetObject);
 
 private:
     static void copyProperties(const QScriptValue &src, QScriptValue &dst);
 
     ScriptEngine *m_engine;
+    ParseCache *m_parseCache = nullptr;
     QHash<QString, QString> m_sourceCodeCache;
 };
 
@@ -49,25 +49,31 @@ class BuildOptionsPrivate : public QSharedData
 public:
     BuildOptionsPrivate()
         : maxJobCount(0), dryRun(false), keepGoing(false), forceTimestampCheck(false),
-          forceOutputCheck(false),
+          forceOutputCheck(false), useContentHashes(false), artifactCacheRelocatable(false),
           logElapsedTime(false), echoMode(defaultCommandEchoMode()), install(true),
-          removeExistingInstallation(false), onlyExecuteRules(false)
+          removeExistingInstallation(false), onlyExecuteRules(false),
+          changedFilesIncludeFileDependencies(false)
     {
     }
 
     QStringList changedFiles;
     QStringList filesToConsider;
     QStringList activeFileTags;
+    QString artifactCacheDirectory;
     int maxJobCount;
+    QHash<QString, int> jobLimits;
     bool dryRun;
     bool keepGoing;
     bool forceTimestampCheck;
     bool forceOutputCheck;
+    bool useContentHashes;
+    bool artifactCacheRelocatable;
     bool logElapsedTime;
     CommandEchoMode echoMode;
     bool install;
     bool removeExistingInstallation;
     bool onlyExecuteRules;
+    bool changedFilesIncludeFileDependencies;
 };
 
 } // namespace Internal
@@ -117,6 +123,28 @@ void BuildOptions::setChangedFiles(const QStringList &changedFiles)
     d->changedFiles = changedFiles;
 }
 
+/*!
+ * \brief Returns true if the list of changed files also covers file dependencies
+ *        such as included headers.
+ * By default, this is false, that is, the timestamps of all file dependencies are
+ * checked even if a list of changed files is given.
+ * \sa setChangedFiles
+ */
+bool BuildOptions::changedFilesIncludeFileDependencies() const
+{
+    return d->changedFilesIncludeFileDependencies;
+}
+
+/*!
+ * \brief Controls whether the list of changed files also covers file dependencies.
+ * Only set this to true if the list is known to be complete, for instance because
+ * it was obtained from a file system watcher.
+ */
+void BuildOptions::setChangedFilesIncludeFileDependencies(bool include)
+{
+    d->changedFilesIncludeFileDependencies = include;
+}
+
 /*!
  * \brief The list of files to consider.
  * \sa setFilesToConsider.
@@ -188,6 +216,26 @@ void BuildOptions::setMaxJobCount(int jobCount)
     d->maxJobCount = jobCount;
 }
 
+/*!
+ * \brief Returns the maximum number of commands that can run in parallel per job pool.
+ * The default is an empty hash, which means that only \c maxJobCount applies.
+ */
+QHash<QString, int> BuildOptions::jobLimits() const
+{
+    return d->jobLimits;
+}
+
+/*!
+ * \brief Limits the number of commands that can run in parallel per job pool.
+ * Commands are put into a job pool via their \c jobPool property. This can be used to
+ * run fewer resource-hungry commands, such as linker invocations, at the same time than
+ * other commands. A value <= 0 means that there is no limit for the respective pool.
+ */
+void BuildOptions::setJobLimits(const QHash<QString, int> &jobLimits)
+{
+    d->jobLimits = jobLimits;
+}
+
 /*!
  * \brief Returns true iff qbs will not actually execute any commands, but just show what
  *        would happen.
@@ -269,6 +317,77 @@ void BuildOptions::setForceOutputCheck(bool enabled)
     d->forceOutputCheck = enabled;
 }
 
+/*!
+ * \brief Returns true if qbs takes file contents into account when checking whether
+ * artifacts are up to date.
+ * The default is \c false.
+ */
+bool BuildOptions::useContentHashes() const
+{
+    return d->useContentHashes;
+}
+
+/*!
+ * \brief Controls whether qbs should compare content hashes of input files when an artifact
+ * looks out of date according to its timestamp.
+ * If the inputs of an artifact have the same contents as in the build that created it, the
+ * artifact is considered up to date. This also applies to re-generated artifacts whose content
+ * has not changed, so that their dependents do not need to be rebuilt.
+ * Enabling this introduces some I/O overhead, because input files have to be read.
+ */
+void BuildOptions::setUseContentHashes(bool enabled)
+{
+    d->useContentHashes = enabled;
+}
+
+/*!
+ * \brief Returns the directory in which transformer outputs are cached across builds.
+ * The default is an empty string, which means that no such cache is used.
+ */
+QString BuildOptions::artifactCacheDirectory() const
+{
+    return d->artifactCacheDirectory;
+}
+
+/*!
+ * \brief Sets the directory in which transformer outputs are cached across builds.
+ * Before running the commands of a rule, qbs looks up the outputs in this directory, using
+ * a key that is derived from the commands, their relevant environment, the properties
+ * requested by the rule and the contents of all inputs. If an entry exists, the outputs
+ * are copied into the build directory instead of running the commands.
+ * Only rules whose commands are all processes take part in caching.
+ * The directory can be shared between several build directories.
+ */
+void BuildOptions::setArtifactCacheDirectory(const QString &cacheDir)
+{
+    d->artifactCacheDirectory = cacheDir;
+}
+
+/*!
+ * \brief Returns true iff artifact cache entries do not depend on the location of the
+ * source and build directories.
+ * The default is \c false.
+ */
+bool BuildOptions::artifactCacheIsRelocatable() const
+{
+    return d->artifactCacheRelocatable;
+}
+
+/*!
+ * \brief Controls whether the paths of the source and build directories are part of the
+ * artifact cache keys.
+ * By default, they are, so that outputs are only shared between build directories at the same
+ * location. If relocation is enabled, these directories are replaced by placeholders when
+ * computing the keys, so that e.g. a fresh checkout at another place can make use of the cache.
+ * Note that the absolute paths can end up in the outputs, for instance in debug information or
+ * via the \c __FILE__ macro; such outputs then refer to the directories of the build that
+ * created the cache entry.
+ */
+void BuildOptions::setArtifactCacheRelocatable(bool relocatable)
+{
+    d->artifactCacheRelocatable = relocatable;
+}
+
 /*!
  * \brief Returns true iff the time the operation takes will be logged.
  * The default is \c false.
@@ -363,11 +482,17 @@ void BuildOptions::setExecuteRulesOnly(bool onlyRules)
 bool operator==(const BuildOptions &bo1, const BuildOptions &bo2)
 {
     return bo1.changedFiles() == bo2.changedFiles()
+            && bo1.changedFilesIncludeFileDependencies()
+                == bo2.changedFilesIncludeFileDependencies()
             && bo1.dryRun() == bo2.dryRun()
             && bo1.keepGoing() == bo2.keepGoing()
+            && bo1.useContentHashes() == bo2.useContentHashes()
+            && bo1.artifactCacheDirectory() == bo2.artifactCacheDirectory()
+            && bo1.artifactCacheIsRelocatable() == bo2.artifactCacheIsRelocatable()
             && bo1.logElapsedTime() == bo2.logElapsedTime()
             && bo1.echoMode() == bo2.echoMode()
             && bo1.maxJobCount() == bo2.maxJobCount()
+            && bo1.jobLimits() == bo2.jobLimits()
             && bo1.install() == bo2.install()
             && bo1.removeExistingInstallation() == bo2.removeExistingInstallation();
 }
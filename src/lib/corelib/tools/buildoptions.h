@@ -43,6 +43,7 @@
 
 #include "commandechomode.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qshareddata.h>
 
 QT_BEGIN_NAMESPACE
@@ -66,6 +67,9 @@ public:
     QStringList changedFiles() const;
     void setChangedFiles(const QStringList &changedFiles);
 
+    bool changedFilesIncludeFileDependencies() const;
+    void setChangedFilesIncludeFileDependencies(bool include);
+
     QStringList activeFileTags() const;
     void setActiveFileTags(const QStringList &fileTags);
 
@@ -73,6 +77,9 @@ public:
     int maxJobCount() const;
     void setMaxJobCount(int jobCount);
 
+    QHash<QString, int> jobLimits() const;
+    void setJobLimits(const QHash<QString, int> &jobLimits);
+
     bool dryRun() const;
     void setDryRun(bool dryRun);
 
@@ -85,6 +92,15 @@ public:
     bool forceOutputCheck() const;
     void setForceOutputCheck(bool enabled);
 
+    bool useContentHashes() const;
+    void setUseContentHashes(bool enabled);
+
+    QString artifactCacheDirectory() const;
+    void setArtifactCacheDirectory(const QString &cacheDir);
+
+    bool artifactCacheIsRelocatable() const;
+    void setArtifactCacheRelocatable(bool relocatable);
+
     bool logElapsedTime() const;
     void setLogElapsedTime(bool log);
 
@@ -44,6 +44,7 @@
 #include <tools/stringconstants.h>
 
 #include <QtCore/qcoreapplication.h>
+#include <QtCore/qcryptographichash.h>
 #include <QtCore/qdatetime.h>
 #include <QtCore/qdir.h>
 #include <QtCore/qfileinfo.h>
@@ -53,8 +54,17 @@
 #include <errno.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <utime.h>
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <sys/syscall.h>
+#endif
 #elif defined(Q_OS_WIN)
 #include <QtCore/qt_windows.h>
+#include <sys/utime.h>
 #endif
 
 namespace qbs {
@@ -408,6 +418,28 @@ bool removeFileRecursion(const QFileInfo &f, QString *errorMessage)
     return true;
 }
 
+QByteArray fileContentHash(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    if (!hash.addData(&file))
+        return QByteArray();
+    return hash.result();
+}
+
+bool touchFile(const QString &filePath)
+{
+#if defined(Q_OS_UNIX)
+    return ::utime(QFile::encodeName(filePath).constData(), nullptr) == 0;
+#elif defined(Q_OS_WIN)
+    return ::_wutime(reinterpret_cast<const wchar_t *>(filePath.utf16()), nullptr) == 0;
+#else
+#   error unknown platform
+#endif
+}
+
 bool removeDirectoryWithContents(const QString &path, QString *errorMessage)
 {
     QFileInfo f(path);
@@ -490,6 +522,65 @@ static bool createSymLink(const QByteArray &path1, const QString &path2)
   \note Function was adapted from qtc/src/libs/fileutils.cpp
 */
 
+#if defined(Q_OS_LINUX)
+static bool copyFileData(int srcFd, int tgtFd, off_t size)
+{
+#ifdef FICLONE
+    if (::ioctl(tgtFd, FICLONE, srcFd) == 0)
+        return true;
+#endif
+    off_t copied = 0;
+#ifdef __NR_copy_file_range
+    while (copied < size) {
+        const ssize_t n = ::syscall(__NR_copy_file_range, srcFd, nullptr, tgtFd, nullptr,
+                                    size_t(size - copied), 0u);
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+    if (copied == size)
+        return true;
+#endif
+    // sendfile() works on the file offsets, which copy_file_range() has advanced.
+    while (copied < size) {
+        const ssize_t n = ::sendfile(tgtFd, srcFd, nullptr, size_t(size - copied));
+        if (n <= 0)
+            return false;
+        copied += n;
+    }
+    return true;
+}
+
+// Copies a regular file without moving the data through user space, if the file system
+// allows it: As a reflink, with copy_file_range() or with sendfile(). Like QFile::copy(),
+// it does not sync. Returns false if the caller needs to fall back to QFile::copy().
+static bool copyFileNatively(const QString &srcFilePath, const QString &tgtFilePath)
+{
+    const int srcFd = ::open(QFile::encodeName(srcFilePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (srcFd == -1)
+        return false;
+    struct stat srcStat;
+    if (::fstat(srcFd, &srcStat) != 0 || !S_ISREG(srcStat.st_mode)) {
+        ::close(srcFd);
+        return false;
+    }
+    const QByteArray tgtFilePathEncoded = QFile::encodeName(tgtFilePath);
+    const int tgtFd = ::open(tgtFilePathEncoded.constData(),
+                             O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (tgtFd == -1) {
+        ::close(srcFd);
+        return false;
+    }
+    bool success = copyFileData(srcFd, tgtFd, srcStat.st_size)
+            && ::fchmod(tgtFd, srcStat.st_mode & 0777) == 0;
+    success = ::close(tgtFd) == 0 && success;
+    ::close(srcFd);
+    if (!success)
+        ::unlink(tgtFilePathEncoded.constData());
+    return success;
+}
+#endif
+
 bool copyFileRecursion(const QString &srcFilePath, const QString &tgtFilePath,
         bool preserveSymLinks, bool copyDirectoryContents, QString *errorMessage)
 {
@@ -538,6 +629,10 @@ bool copyFileRecursion(const QString &srcFilePath, const QString &tgtFilePath,
                         .arg(QDir::toNativeSeparators(tgtFilePath), targetFile.errorString());
             }
         }
+#if defined(Q_OS_LINUX)
+        if (copyFileNatively(srcFilePath, tgtFilePath))
+            return true;
+#endif
         if (!file.copy(tgtFilePath)) {
             *errorMessage = Tr::tr("Could not copy file '%1' to '%2'. %3")
                 .arg(QDir::toNativeSeparators(srcFilePath), QDir::toNativeSeparators(tgtFilePath),
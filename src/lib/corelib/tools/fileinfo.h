@@ -99,6 +99,12 @@ private:
 
 bool removeFileRecursion(const QFileInfo &f, QString *errorMessage);
 
+// Returns an empty array if the file cannot be read or is a directory.
+QByteArray fileContentHash(const QString &filePath);
+
+// Sets the modification time of an existing file to the current time.
+bool touchFile(const QString &filePath);
+
 // FIXME: Used by tests.
 bool QBS_EXPORT removeDirectoryWithContents(const QString &path, QString *errorMessage);
 bool QBS_EXPORT copyFileRecursion(const QString &sourcePath, const QString &targetPath,
@@ -43,6 +43,9 @@
 #include <QtCore/qbytearray.h>
 #include <QtCore/qhash.h>
 
+#include <atomic>
+#include <cstring>
+#include <mutex>
 #include <vector>
 
 namespace qbs {
@@ -69,19 +72,16 @@ class StringHolder
 {
 public:
     StringHolder()
-        : n(0), str(nullptr)
+        : n(0), str(nullptr), h(0)
     {}
 
     StringHolder(const char *s, int length)
-        : n(length), str(s)
+        : n(length ? length : int(qstrlen(s))), str(s), h(2166136261u)
     {
-        if (!n)
-            length = n = qstrlen(s);
-        h = 0;
-        while (length--) {
-            h = (h << 4) + *s++;
-            h ^= (h & 0xf0000000) >> 23;
-            h &= 0x0fffffff;
+        // FNV-1a
+        for (int i = 0; i < n; ++i) {
+            h ^= uchar(s[i]);
+            h *= 16777619u;
         }
     }
     int n;
@@ -91,45 +91,183 @@ public:
 
 static bool operator==(const StringHolder &sh1, const StringHolder &sh2)
 {
-    // sh.n is unlikely to discriminate better than the hash.
-    return sh1.h == sh2.h && sh1.str && sh2.str && strcmp(sh1.str, sh2.str) == 0;
+    return sh1.h == sh2.h && sh1.n == sh2.n && std::memcmp(sh1.str, sh2.str, sh1.n) == 0;
 }
 
-
 static uint qHash(const StringHolder &sh)
 {
     return sh.h;
 }
 
-struct IdCache : public QHash<StringHolder, int>
+namespace {
+
+// Holds the names of the ids. The memory is never handed back before the process ends,
+// so the names can be used without holding a lock.
+class StringArena
 {
+public:
+    StringArena() : m_current(nullptr), m_used(0) {}
+
 #ifndef QBS_ALLOW_STATIC_LEAKS
-    ~IdCache()
+    ~StringArena()
     {
-        for (IdCache::iterator it = begin(); it != end(); ++it)
-            delete[](const_cast<char *>(it.key().str));
+        for (const char * const block : m_blocks)
+            delete[] block;
     }
 #endif
+
+    const char *add(const char *str, int length)
+    {
+        const int size = length + 1;
+        char *target;
+        if (size > BlockSize / 8) {
+            target = new char[size];
+            m_blocks.push_back(target);
+        } else {
+            if (!m_current || m_used + size > BlockSize) {
+                m_current = new char[BlockSize];
+                m_blocks.push_back(m_current);
+                m_used = 0;
+            }
+            target = m_current + m_used;
+            m_used += size;
+        }
+        std::memcpy(target, str, length);
+        target[length] = '\0';
+        return target;
+    }
+
+private:
+    enum { BlockSize = 16 * 1024 };
+
+    std::vector<char *> m_blocks;
+    char *m_current;
+    int m_used;
 };
 
+// The name -> id mapping is split into shards with a lock each, so that threads interning
+// different strings rarely wait for each other.
+struct IdShard
+{
+    std::mutex mutex;
+    QHash<StringHolder, int> ids;
+    StringArena names;
+};
 
-static int firstUnusedId = Id::IdsPerPlugin * Id::ReservedPlugins;
+// The id -> name mapping is a table of fixed-size blocks that get allocated on demand and
+// never move. Looking up a name therefore does not need a lock.
+class IdNameTable
+{
+public:
+    IdNameTable()
+    {
+        for (std::atomic<Entry *> &block : m_blocks)
+            block.store(nullptr, std::memory_order_relaxed);
+    }
+
+#ifndef QBS_ALLOW_STATIC_LEAKS
+    ~IdNameTable()
+    {
+        for (std::atomic<Entry *> &block : m_blocks)
+            delete[] block.load(std::memory_order_relaxed);
+    }
+#endif
+
+    const char *name(int id) const
+    {
+        if (id <= 0 || id >= Capacity)
+            return nullptr;
+        const Entry * const block = m_blocks[id / BlockSize].load(std::memory_order_acquire);
+        return block ? block[id % BlockSize].load(std::memory_order_acquire) : nullptr;
+    }
 
-static QHash<int, StringHolder> stringFromId;
-static IdCache idFromString;
+    void setName(int id, const char *name)
+    {
+        QBS_ASSERT(id > 0 && id < Capacity, return);
+        std::atomic<Entry *> &slot = m_blocks[id / BlockSize];
+        Entry *block = slot.load(std::memory_order_acquire);
+        if (!block) {
+            Entry * const newBlock = new Entry[BlockSize];
+            for (int i = 0; i < BlockSize; ++i)
+                newBlock[i].store(nullptr, std::memory_order_relaxed);
+            if (slot.compare_exchange_strong(block, newBlock, std::memory_order_acq_rel)) {
+                block = newBlock;
+            } else {
+                delete[] newBlock; // Another thread was faster.
+            }
+        }
+        block[id % BlockSize].store(name, std::memory_order_release);
+    }
+
+private:
+    typedef std::atomic<const char *> Entry;
+    enum { BlockSize = 4096, BlockCount = 8192, Capacity = BlockSize * BlockCount };
+
+    std::atomic<Entry *> m_blocks[BlockCount];
+};
+
+class IdRegistry
+{
+public:
+    IdRegistry() : m_firstUnusedId(Id::IdsPerPlugin * Id::ReservedPlugins) {}
+
+    int id(const StringHolder &sh)
+    {
+        IdShard &shard = shardFor(sh);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.ids.constFind(sh);
+        if (it != shard.ids.constEnd())
+            return it.value();
+        const int id = m_firstUnusedId++;
+        addName(shard, sh, id);
+        return id;
+    }
+
+    void registerId(const StringHolder &sh, int id)
+    {
+        IdShard &shard = shardFor(sh);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        addName(shard, sh, id);
+    }
+
+    const char *name(int id) const { return m_names.name(id); }
+
+private:
+    enum { ShardCount = 16 };
+
+    IdShard &shardFor(const StringHolder &sh)
+    {
+        // The low bits are used for the buckets of the shard's hash.
+        return m_shards[(sh.h >> 24) % ShardCount];
+    }
+
+    void addName(IdShard &shard, const StringHolder &sh, int id)
+    {
+        StringHolder key = sh;
+        key.str = shard.names.add(sh.str, sh.n);
+        shard.ids.insert(key, id);
+        m_names.setName(id, key.str);
+    }
+
+    IdShard m_shards[ShardCount];
+    IdNameTable m_names;
+    std::atomic<int> m_firstUnusedId;
+};
+
+} // namespace
+
+// Ids get created from static initializers as well as from several threads, so the registry
+// is created on first use.
+static IdRegistry &idRegistry()
+{
+    static IdRegistry registry;
+    return registry;
+}
 
 static int theId(const char *str, int n = 0)
 {
     QBS_ASSERT(str && *str, return 0);
-    StringHolder sh(str, n);
-    int res = idFromString.value(sh, 0);
-    if (res == 0) {
-        res = firstUnusedId++;
-        sh.str = qstrdup(sh.str);
-        idFromString[sh] = res;
-        stringFromId[res] = sh;
-    }
-    return res;
+    return idRegistry().id(StringHolder(str, n));
 }
 
 static int theId(const QByteArray &ba)
@@ -137,6 +275,11 @@ static int theId(const QByteArray &ba)
     return theId(ba.constData(), ba.size());
 }
 
+static const char *stringForId(int id)
+{
+    return idRegistry().name(id);
+}
+
 /*!
     \fn qbs::Internal::Id(int uid)
 
@@ -178,7 +321,7 @@ Id::Id(const QByteArray &name)
 
 QByteArray Id::name() const
 {
-    return stringFromId.value(m_id).str;
+    return stringForId(m_id);
 }
 
 /*!
@@ -193,7 +336,7 @@ QByteArray Id::name() const
 
 QString Id::toString() const
 {
-    return QString::fromUtf8(stringFromId.value(m_id).str);
+    return QString::fromUtf8(stringForId(m_id));
 }
 
 /*!
@@ -205,7 +348,7 @@ QString Id::toString() const
 
 QVariant Id::toSetting() const
 {
-    return QVariant(QString::fromUtf8(stringFromId.value(m_id).str));
+    return QVariant(QString::fromUtf8(stringForId(m_id)));
 }
 
 /*!
@@ -272,14 +415,12 @@ Id Id::withPrefix(const char *prefix) const
 
 void Id::registerId(int uid, const char *name)
 {
-    StringHolder sh(name, 0);
-    idFromString[sh] = uid;
-    stringFromId[uid] = sh;
+    idRegistry().registerId(StringHolder(name, 0), uid);
 }
 
 bool Id::operator==(const char *name) const
 {
-    const char *string = stringFromId.value(m_id).str;
+    const char *string = stringForId(m_id);
     if (string && name)
         return strcmp(string, name) == 0;
     else
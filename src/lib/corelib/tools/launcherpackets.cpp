@@ -72,12 +72,12 @@ StartProcessPacket::StartProcessPacket(quintptr token)
 
 void StartProcessPacket::doSerialize(QDataStream &stream) const
 {
-    stream << command << arguments << workingDir << env;
+    stream << command << arguments << workingDir << envId << env;
 }
 
 void StartProcessPacket::doDeserialize(QDataStream &stream)
 {
-    stream >> command >> arguments >> workingDir >> env;
+    stream >> command >> arguments >> workingDir >> envId >> env;
 }
 
 
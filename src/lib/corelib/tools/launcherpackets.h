@@ -113,6 +113,10 @@ public:
     QString command;
     QStringList arguments;
     QString workingDir;
+
+    // Environments are sent only once per launcher connection. Subsequent requests
+    // refer to them by id and leave env empty.
+    quint32 envId = 0;
     QStringList env;
 
 private:
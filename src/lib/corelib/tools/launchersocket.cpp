@@ -66,6 +66,28 @@ void LauncherSocket::sendData(const QByteArray &data)
         QTimer::singleShot(0, this, &LauncherSocket::handleRequests);
 }
 
+// The environment is typically the largest part of a start request and rarely differs
+// between processes, so the launcher is sent each distinct environment only once.
+// Ids are assigned and packets queued under the same lock, so a packet referring to
+// an id can never overtake the one that introduces it.
+void LauncherSocket::sendStartProcessPacket(StartProcessPacket &packet)
+{
+    if (!isReady())
+        return;
+    std::lock_guard<std::mutex> locker(m_requestsMutex);
+    const auto it = m_environmentIds.constFind(packet.env);
+    if (it != m_environmentIds.cend()) {
+        packet.envId = it.value();
+        packet.env.clear();
+    } else {
+        packet.envId = m_environmentIds.size();
+        m_environmentIds.insert(packet.env, packet.envId);
+    }
+    m_requests.push_back(packet.serialize());
+    if (m_requests.size() == 1)
+        QTimer::singleShot(0, this, &LauncherSocket::handleRequests);
+}
+
 void LauncherSocket::shutdown()
 {
     QBS_ASSERT(m_socket, return);
@@ -80,6 +102,10 @@ void LauncherSocket::setSocket(QLocalSocket *socket)
 {
     QBS_ASSERT(!m_socket, return);
     m_socket = socket;
+    {
+        std::lock_guard<std::mutex> locker(m_requestsMutex);
+        m_environmentIds.clear();
+    }
     m_packetParser.setDevice(m_socket);
     connect(m_socket,
             static_cast<void(QLocalSocket::*)(QLocalSocket::LocalSocketError)>(&QLocalSocket::error),
@@ -99,25 +125,27 @@ void LauncherSocket::handleSocketError()
 
 void LauncherSocket::handleSocketDataAvailable()
 {
-    try {
-        if (!m_packetParser.parse())
+    // Several packets can arrive at once when many short processes finish in a row.
+    while (m_socket) {
+        try {
+            if (!m_packetParser.parse())
+                return;
+        } catch (const PacketParser::InvalidPacketSizeException &e) {
+            handleError(Tr::tr("Internal protocol error: invalid packet size %1.").arg(e.size));
             return;
-    } catch (const PacketParser::InvalidPacketSizeException &e) {
-        handleError(Tr::tr("Internal protocol error: invalid packet size %1.").arg(e.size));
-        return;
-    }
-    switch (m_packetParser.type()) {
-    case LauncherPacketType::ProcessError:
-    case LauncherPacketType::ProcessFinished:
-        emit packetArrived(m_packetParser.type(), m_packetParser.token(),
-                           m_packetParser.packetData());
-        break;
-    default:
-        handleError(Tr::tr("Internal protocol error: invalid packet type %1.")
-                    .arg(static_cast<int>(m_packetParser.type())));
-        return;
+        }
+        switch (m_packetParser.type()) {
+        case LauncherPacketType::ProcessError:
+        case LauncherPacketType::ProcessFinished:
+            emit packetArrived(m_packetParser.type(), m_packetParser.token(),
+                               m_packetParser.packetData());
+            break;
+        default:
+            handleError(Tr::tr("Internal protocol error: invalid packet type %1.")
+                        .arg(static_cast<int>(m_packetParser.type())));
+            return;
+        }
     }
-    handleSocketDataAvailable();
 }
 
 void LauncherSocket::handleSocketDisconnected()
@@ -42,6 +42,7 @@
 
 #include "launcherpackets.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qobject.h>
 
 #include <mutex>
@@ -62,6 +63,7 @@ class LauncherSocket : public QObject
 public:
     bool isReady() const { return m_socket; }
     void sendData(const QByteArray &data);
+    void sendStartProcessPacket(StartProcessPacket &packet);
 
 signals:
     void ready();
@@ -84,6 +86,7 @@ private:
     QLocalSocket *m_socket = nullptr;
     PacketParser m_packetParser;
     std::vector<QByteArray> m_requests;
+    QHash<QStringList, quint32> m_environmentIds;
     std::mutex m_requestsMutex;
 };
 
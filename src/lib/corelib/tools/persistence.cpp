@@ -44,12 +44,18 @@
 #include <tools/error.h>
 #include <tools/qbsassert.h>
 
+#include <QtCore/qdatastream.h>
 #include <QtCore/qdir.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qfile.h>
+
+#include <climits>
+#include <cstring>
 
 namespace qbs {
 namespace Internal {
 
-static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE_110";
+static const char QBS_PERSISTENCE_MAGIC[] = "QBSPERSISTENCE_119";
 
 NoBuildGraphError::NoBuildGraphError(const QString &filePath)
     : ErrorInfo(Tr::tr("Build graph not found for configuration '%1'. Expected location was '%2'.")
@@ -57,10 +63,10 @@ NoBuildGraphError::NoBuildGraphError(const QString &filePath)
 {
 }
 
-PersistentPool::PersistentPool(Logger &logger) : m_logger(logger)
+PersistentPool::PersistentPool(Logger &logger)
+    : m_writeBuffer(nullptr), m_readPos(nullptr), m_readEnd(nullptr), m_logger(logger)
 {
     Q_UNUSED(m_logger);
-    m_stream.setVersion(QDataStream::Qt_4_8);
 }
 
 PersistentPool::~PersistentPool()
@@ -70,6 +76,7 @@ PersistentPool::~PersistentPool()
 
 void PersistentPool::load(const QString &filePath)
 {
+    closeStream();
     std::unique_ptr<QFile> file(new QFile(filePath));
     if (!file->exists())
         throw NoBuildGraphError(filePath);
@@ -78,28 +85,41 @@ void PersistentPool::load(const QString &filePath)
                     .arg(filePath, file->errorString()));
     }
 
-    m_stream.setDevice(file.get());
-    QByteArray magic;
-    m_stream >> magic;
+    // Mapping the file avoids copying its content; the strings and other values are
+    // copied out of it while loading anyway.
+    const qint64 fileSize = file->size();
+    const uchar * const mappedData = fileSize > 0 && fileSize <= INT_MAX
+            ? file->map(0, fileSize) : nullptr;
+    if (mappedData) {
+        m_readData = QByteArray::fromRawData(reinterpret_cast<const char *>(mappedData),
+                                             static_cast<int>(fileSize));
+        m_file = std::move(file);
+    } else {
+        m_readData = file->readAll();
+    }
+    m_readPos = m_readData.constData();
+    m_readEnd = m_readPos + m_readData.size();
+
+    const QByteArray magic = loadMagic();
     if (magic != QBS_PERSISTENCE_MAGIC) {
-        m_stream.setDevice(0);
+        closeStream();
         throw ErrorInfo(Tr::tr("Cannot use stored build graph at '%1': Incompatible file format. "
                            "Expected magic token '%2', got '%3'.")
                     .arg(filePath, QString::fromLatin1(QBS_PERSISTENCE_MAGIC),
                          QString::fromLatin1(magic)));
     }
 
-    m_stream >> m_headData.projectConfig;
-    file.release();
     m_loadedRaw.clear();
     m_loaded.clear();
     m_storageIndices.clear();
     m_stringStorage.clear();
     m_inverseStringStorage.clear();
+    load(m_headData.projectConfig);
 }
 
 void PersistentPool::setupWriteStream(const QString &filePath)
 {
+    closeStream();
     QString dirPath = FileInfo::path(filePath);
     if (!FileInfo::exists(dirPath) && !QDir().mkpath(dirPath)) {
         throw ErrorInfo(Tr::tr("Failure storing build graph: Cannot create directory '%1'.")
@@ -117,41 +137,158 @@ void PersistentPool::setupWriteStream(const QString &filePath)
                 "Cannot open file '%1' for writing: %2").arg(filePath, file->errorString()));
     }
 
-    m_stream.setDevice(file.release());
-    m_stream << QByteArray(qstrlen(QBS_PERSISTENCE_MAGIC), 0) << m_headData.projectConfig;
-    m_lastStoredObjectId = 0;
-    m_lastStoredStringId = 0;
+    m_file = std::move(file);
+    m_fileData.clear();
+    m_writeBuffer = &m_fileData;
+    resetStorageState();
+
+    // The real magic token gets written only once all data has made it to the disk,
+    // so that an incomplete file is never considered valid.
+    storeMagic();
+    store(m_headData.projectConfig);
+}
+
+void PersistentPool::setupWriteStream(QByteArray *data)
+{
+    closeStream();
+    data->clear();
+    m_writeBuffer = data;
+    resetStorageState();
+}
+
+void PersistentPool::setupReadStream(const QByteArray &data)
+{
+    closeStream();
+    m_readData = data;
+    m_readPos = m_readData.constData();
+    m_readEnd = m_readPos + m_readData.size();
+    m_loadedRaw.clear();
+    m_loaded.clear();
+    m_storageIndices.clear();
+    m_stringStorage.clear();
+    m_inverseStringStorage.clear();
 }
 
 void PersistentPool::finalizeWriteStream()
 {
-    if (m_stream.status() != QDataStream::Ok)
-        throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    m_stream.device()->seek(0);
-    m_stream << QByteArray(QBS_PERSISTENCE_MAGIC);
-    if (m_stream.status() != QDataStream::Ok)
-        throw ErrorInfo(Tr::tr("Failure serializing build graph."));
-    const auto file = static_cast<QFile *>(m_stream.device());
-    if (!file->flush()) {
-        file->close();
-        file->remove();
-        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(file->errorString()));
+    QBS_CHECK(m_file && m_writeBuffer == &m_fileData);
+    const qint64 magicOffset = sizeof(quint32);
+    bool success = m_file->write(m_fileData) == m_fileData.size() && m_file->flush();
+    if (success) {
+        success = m_file->seek(magicOffset)
+                && m_file->write(QBS_PERSISTENCE_MAGIC, qstrlen(QBS_PERSISTENCE_MAGIC))
+                    == qint64(qstrlen(QBS_PERSISTENCE_MAGIC))
+                && m_file->flush();
+    }
+    if (!success) {
+        const QString errorString = m_file->errorString();
+        m_file->close();
+        m_file->remove();
+        closeStream();
+        throw ErrorInfo(Tr::tr("Failure serializing build graph: %1").arg(errorString));
     }
 }
 
 void PersistentPool::closeStream()
 {
-    delete m_stream.device();
-    m_stream.setDevice(nullptr);
+    m_readData.clear();
+    m_readPos = m_readEnd = nullptr;
+    m_writeBuffer = nullptr;
+    m_fileData.clear();
+    m_file.reset(); // Also unmaps the file.
 }
 
+void PersistentPool::resetStorageState()
+{
+    m_storageIndices.clear();
+    m_inverseStringStorage.clear();
+    m_lastStoredObjectId = 0;
+    m_lastStoredStringId = 0;
+}
+
+// The magic token is laid out like a QByteArray serialized by QDataStream, which is what
+// older versions of qbs used. Their build graph files are therefore recognized as such
+// and rejected with a proper error message.
+void PersistentPool::storeMagic()
+{
+    const quint32 magicSize = qstrlen(QBS_PERSISTENCE_MAGIC);
+    char sizeData[sizeof magicSize];
+    qToBigEndian(magicSize, reinterpret_cast<uchar *>(sizeData));
+    storeRawData(sizeData, sizeof sizeData);
+    storeRawData(QByteArray(int(magicSize), 0).constData(), int(magicSize));
+}
 
+QByteArray PersistentPool::loadMagic()
+{
+    if (m_readEnd - m_readPos < qint64(sizeof(quint32)))
+        return QByteArray();
+    const quint32 magicSize = qFromBigEndian<quint32>(reinterpret_cast<const uchar *>(m_readPos));
+    m_readPos += sizeof(quint32);
+    if (magicSize > quint32(m_readEnd - m_readPos))
+        return QByteArray();
+    return QByteArray(loadRawData(magicSize), magicSize);
+}
+
+void PersistentPool::throwReadError() const
+{
+    throw ErrorInfo(Tr::tr("Failure loading build graph: The data is corrupt."));
+}
+
+void PersistentPool::storeByteArray(const QByteArray &ba)
+{
+    if (ba.isNull()) {
+        storeVarInt(0);
+        return;
+    }
+    storeVarInt(static_cast<quint64>(ba.size()) + 1);
+    storeRawData(ba.constData(), ba.size());
+}
+
+QByteArray PersistentPool::loadByteArray()
+{
+    const quint64 storedSize = loadVarInt();
+    if (storedSize == 0)
+        return QByteArray();
+    if (storedSize - 1 > quint64(INT_MAX))
+        throwReadError();
+    const int size = static_cast<int>(storedSize - 1);
+    return QByteArray(loadRawData(size), size);
+}
 
 void PersistentPool::storeVariant(const QVariant &variant)
 {
     const quint32 type = static_cast<quint32>(variant.type());
-    m_stream << type;
+    store(type);
     switch (type) {
+    case QMetaType::UnknownType:
+        break;
+    case QMetaType::Bool:
+        store(variant.toBool());
+        break;
+    case QMetaType::Int:
+        store(variant.toInt());
+        break;
+    case QMetaType::UInt:
+        store(variant.toUInt());
+        break;
+    case QMetaType::LongLong:
+        store(variant.toLongLong());
+        break;
+    case QMetaType::ULongLong:
+        store(variant.toULongLong());
+        break;
+    case QMetaType::Double: {
+        const double d = variant.toDouble();
+        quint64 bits;
+        std::memcpy(&bits, &d, sizeof bits);
+        char data[sizeof bits];
+        qToLittleEndian(bits, reinterpret_cast<uchar *>(data));
+        storeRawData(data, sizeof data);
+        break;
+    }
+    case QMetaType::QByteArray:
+        storeByteArray(variant.toByteArray());
+        break;
     case QMetaType::QString:
         storeString(variant.toString());
         break;
@@ -164,8 +301,15 @@ void PersistentPool::storeVariant(const QVariant &variant)
     case QMetaType::QVariantMap:
         store(variant.toMap());
         break;
-    default:
-        m_stream << variant;
+    default: {
+        // Rare types are left to QDataStream.
+        QByteArray data;
+        QDataStream stream(&data, QIODevice::WriteOnly);
+        stream.setVersion(QDataStream::Qt_4_8);
+        stream << variant;
+        storeByteArray(data);
+        break;
+    }
     }
 }
 
@@ -174,6 +318,34 @@ QVariant PersistentPool::loadVariant()
     const quint32 type = load<quint32>();
     QVariant value;
     switch (type) {
+    case QMetaType::UnknownType:
+        break;
+    case QMetaType::Bool:
+        value = load<bool>();
+        break;
+    case QMetaType::Int:
+        value = load<int>();
+        break;
+    case QMetaType::UInt:
+        value = load<uint>();
+        break;
+    case QMetaType::LongLong:
+        value = load<qlonglong>();
+        break;
+    case QMetaType::ULongLong:
+        value = load<qulonglong>();
+        break;
+    case QMetaType::Double: {
+        const quint64 bits = qFromLittleEndian<quint64>(
+                    reinterpret_cast<const uchar *>(loadRawData(sizeof(quint64))));
+        double d;
+        std::memcpy(&d, &bits, sizeof d);
+        value = d;
+        break;
+    }
+    case QMetaType::QByteArray:
+        value = loadByteArray();
+        break;
     case QMetaType::QString:
         value = idLoadString();
         break;
@@ -186,8 +358,13 @@ QVariant PersistentPool::loadVariant()
     case QMetaType::QVariantMap:
         value = load<QVariantMap>();
         break;
-    default:
-        m_stream >> value;
+    default: {
+        const QByteArray data = loadByteArray();
+        QDataStream stream(data);
+        stream.setVersion(QDataStream::Qt_4_8);
+        stream >> value;
+        break;
+    }
     }
     return value;
 }
@@ -206,7 +383,7 @@ const int NullStringId = -2;
 void PersistentPool::storeString(const QString &t)
 {
     if (t.isNull()) {
-        m_stream << NullStringId;
+        storeInteger(NullStringId);
         return;
     }
 
@@ -214,9 +391,12 @@ void PersistentPool::storeString(const QString &t)
     if (id < 0) {
         id = m_lastStoredStringId++;
         m_inverseStringStorage.insert(t, id);
-        m_stream << id << t;
+        storeInteger(id);
+        const QByteArray utf8 = t.toUtf8();
+        storeVarInt(static_cast<quint64>(utf8.size()));
+        storeRawData(utf8.constData(), utf8.size());
     } else {
-        m_stream << id;
+        storeInteger(id);
     }
 }
 
@@ -228,8 +408,11 @@ QString PersistentPool::loadString(int id)
     QBS_CHECK(id >= 0);
 
     if (id >= static_cast<int>(m_stringStorage.size())) {
-        QString s;
-        m_stream >> s;
+        const quint64 size = loadVarInt();
+        if (size > quint64(INT_MAX))
+            throwReadError();
+        const QString s = QString::fromUtf8(loadRawData(static_cast<int>(size)),
+                                            static_cast<int>(size));
         m_stringStorage.resize(id + 1);
         m_stringStorage[id] = s;
         return s;
@@ -240,9 +423,7 @@ QString PersistentPool::loadString(int id)
 
 QString PersistentPool::idLoadString()
 {
-    int id;
-    m_stream >> id;
-    return loadString(id);
+    return loadString(loadInteger<int>());
 }
 
 } // namespace Internal
@@ -41,9 +41,10 @@
 #define QBS_PERSISTENCE
 
 #include "error.h"
+#include "qbs_export.h"
 #include <logging/logger.h>
 
-#include <QtCore/qdatastream.h>
+#include <QtCore/qbytearray.h>
 #include <QtCore/qflags.h>
 #include <QtCore/qprocess.h>
 #include <QtCore/qstring.h>
@@ -53,6 +54,10 @@
 #include <type_traits>
 #include <vector>
 
+QT_BEGIN_NAMESPACE
+class QFile;
+QT_END_NAMESPACE
+
 namespace qbs {
 namespace Internal {
 
@@ -62,7 +67,7 @@ public:
     NoBuildGraphError(const QString &filePath);
 };
 
-class PersistentPool
+class QBS_AUTOTEST_EXPORT PersistentPool
 {
 public:
     PersistentPool(Logger &logger);
@@ -94,6 +99,10 @@ public:
 
     void load(const QString &filePath);
     void setupWriteStream(const QString &filePath);
+
+    // For parts of the build graph that are serialized independently of the rest.
+    void setupWriteStream(QByteArray *data);
+    void setupReadStream(const QByteArray &data);
     void finalizeWriteStream();
     void closeStream();
     void clear();
@@ -109,6 +118,20 @@ private:
 
     template<typename T> void storeSharedObject(const T *object);
 
+    // Integers are stored as varints, with signed values zigzag-encoded, so that the
+    // typical small values take up only one or two bytes.
+    template<typename T> void storeInteger(T value);
+    template<typename T> T loadInteger();
+    void storeVarInt(quint64 value);
+    quint64 loadVarInt();
+
+    void storeRawData(const char *data, int size) { m_writeBuffer->append(data, size); }
+    const char *loadRawData(int size);
+    Q_NORETURN void throwReadError() const;
+
+    void storeByteArray(const QByteArray &ba);
+    QByteArray loadByteArray();
+
     void storeVariant(const QVariant &variant);
     QVariant loadVariant();
 
@@ -116,7 +139,20 @@ private:
     QString loadString(int id);
     QString idLoadString();
 
-    QDataStream m_stream;
+    void resetStorageState();
+    void storeMagic();
+    QByteArray loadMagic();
+
+    // All data is collected in memory and written to the file in one go.
+    QByteArray *m_writeBuffer;
+    QByteArray m_fileData;
+
+    // Points either to a memory-mapped file or to an in-memory buffer.
+    QByteArray m_readData;
+    const char *m_readPos;
+    const char *m_readEnd;
+
+    std::unique_ptr<QFile> m_file;
     HeadData m_headData;
     std::vector<void *> m_loadedRaw;
     std::vector<std::shared_ptr<void>> m_loaded;
@@ -134,7 +170,7 @@ template<typename T> inline const void *uniqueAddress(const T *t) { return t; }
 template<typename T> inline void PersistentPool::storeSharedObject(const T *object)
 {
     if (!object) {
-        m_stream << -1;
+        storeInteger<PersistentObjectId>(-1);
         return;
     }
     const void * const addr = uniqueAddress(object);
@@ -142,17 +178,16 @@ template<typename T> inline void PersistentPool::storeSharedObject(const T *obje
     if (id < 0) {
         id = m_lastStoredObjectId++;
         m_storageIndices.insert(addr, id);
-        m_stream << id;
+        storeInteger(id);
         object->store(*this);
     } else {
-        m_stream << id;
+        storeInteger(id);
     }
 }
 
 template <typename T> inline T *PersistentPool::idLoad()
 {
-    PersistentObjectId id;
-    m_stream >> id;
+    const PersistentObjectId id = loadInteger<PersistentObjectId>();
 
     if (id < 0)
         return nullptr;
@@ -173,8 +208,7 @@ template <typename T> inline T *PersistentPool::idLoad()
 
 template <class T> inline std::shared_ptr<T> PersistentPool::idLoadS()
 {
-    PersistentObjectId id;
-    m_stream >> id;
+    const PersistentObjectId id = loadInteger<PersistentObjectId>();
 
     if (id < 0)
         return std::shared_ptr<T>();
@@ -189,13 +223,64 @@ template <class T> inline std::shared_ptr<T> PersistentPool::idLoadS()
     return t;
 }
 
+template<typename T> inline void PersistentPool::storeInteger(T value)
+{
+    if (std::is_signed<T>::value) {
+        const qint64 v = value;
+        storeVarInt((static_cast<quint64>(v) << 1) ^ static_cast<quint64>(v >> 63));
+    } else {
+        storeVarInt(static_cast<quint64>(value));
+    }
+}
+
+template<typename T> inline T PersistentPool::loadInteger()
+{
+    const quint64 v = loadVarInt();
+    if (std::is_signed<T>::value)
+        return static_cast<T>(static_cast<qint64>(v >> 1) ^ -static_cast<qint64>(v & 1));
+    return static_cast<T>(v);
+}
+
+inline void PersistentPool::storeVarInt(quint64 value)
+{
+    char buffer[10];
+    int size = 0;
+    while (value >= 0x80) {
+        buffer[size++] = static_cast<char>(value | 0x80);
+        value >>= 7;
+    }
+    buffer[size++] = static_cast<char>(value);
+    storeRawData(buffer, size);
+}
+
+inline quint64 PersistentPool::loadVarInt()
+{
+    quint64 value = 0;
+    for (int shift = 0; shift < 64 && m_readPos != m_readEnd; shift += 7) {
+        const uchar byte = static_cast<uchar>(*m_readPos++);
+        value |= static_cast<quint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    throwReadError();
+}
+
+inline const char *PersistentPool::loadRawData(int size)
+{
+    if (size < 0 || m_readEnd - m_readPos < size)
+        throwReadError();
+    const char * const data = m_readPos;
+    m_readPos += size;
+    return data;
+}
+
 /***** Specializations of Helper class *****/
 
 template<typename T>
 struct PersistentPool::Helper<T, typename std::enable_if<std::is_integral<T>::value>::type>
 {
-    static void store(const T &value, PersistentPool *pool) { pool->m_stream << value; }
-    static void load(T &value, PersistentPool *pool) { pool->m_stream >> value; }
+    static void store(const T &value, PersistentPool *pool) { pool->storeInteger(value); }
+    static void load(T &value, PersistentPool *pool) { value = pool->loadInteger<T>(); }
 };
 
 template<typename T>
@@ -204,11 +289,11 @@ struct PersistentPool::Helper<T, typename std::enable_if<std::is_enum<T>::value>
     using U = typename std::underlying_type<T>::type;
     static void store(const T &value, PersistentPool *pool)
     {
-        pool->m_stream << static_cast<U>(value);
+        pool->storeInteger(static_cast<U>(value));
     }
     static void load(T &value, PersistentPool *pool)
     {
-        pool->m_stream >> reinterpret_cast<U &>(value);
+        value = static_cast<T>(pool->loadInteger<U>());
     }
 };
 
@@ -248,6 +333,12 @@ template<> struct PersistentPool::Helper<QString>
     static void load(QString &s, PersistentPool *pool) { s = pool->idLoadString(); }
 };
 
+template<> struct PersistentPool::Helper<QByteArray>
+{
+    static void store(const QByteArray &ba, PersistentPool *pool) { pool->storeByteArray(ba); }
+    static void load(QByteArray &ba, PersistentPool *pool) { ba = pool->loadByteArray(); }
+};
+
 template<> struct PersistentPool::Helper<QVariant>
 {
     static void store(const QVariant &v, PersistentPool *pool) { pool->storeVariant(v); }
@@ -106,6 +106,51 @@ CommandEchoMode Preferences::defaultEchoMode() const
     return commandEchoModeFromName(getPreference(QLatin1String("defaultEchoMode")).toString());
 }
 
+/*!
+ * \brief Returns the directory in which transformer outputs are cached across builds.
+ * An empty string means that no such cache is used.
+ */
+QString Preferences::artifactCacheDirectory() const
+{
+    return getPreference(QLatin1String("artifactCacheDirectory")).toString();
+}
+
+/*!
+ * \brief Returns true iff artifact cache entries can be shared between build directories
+ * located at different places in the file system.
+ */
+bool Preferences::artifactCacheIsRelocatable() const
+{
+    return getPreference(QLatin1String("artifactCacheRelocatable"), false).toBool();
+}
+
+/*!
+ * \brief Returns the directory in which the results of probes are cached across build
+ * directories. An empty string means that no such cache is used.
+ */
+QString Preferences::probeCacheDirectory() const
+{
+    return getPreference(QLatin1String("probeCacheDirectory")).toString();
+}
+
+/*!
+ * \brief Returns the maximum number of commands per job pool that can run in parallel.
+ * The setting is a list of entries of the form \c{<pool>:<limit>}. Invalid entries are ignored.
+ */
+QHash<QString, int> Preferences::jobLimits() const
+{
+    QHash<QString, int> limits;
+    const QStringList entries = getPreference(QLatin1String("jobLimits")).toStringList();
+    for (const QString &entry : entries) {
+        const int separatorPos = entry.lastIndexOf(QLatin1Char(':'));
+        bool ok = false;
+        const int limit = entry.mid(separatorPos + 1).toInt(&ok);
+        if (separatorPos > 0 && ok)
+            limits.insert(entry.left(separatorPos), limit);
+    }
+    return limits;
+}
+
 /*!
  * \brief Returns the list of paths where qbs looks for modules and imports.
  * In addition to user-supplied locations, they will also be looked up at \c{baseDir}/share/qbs.
@@ -43,6 +43,7 @@
 
 #include "commandechomode.h"
 
+#include <QtCore/qhash.h>
 #include <QtCore/qstringlist.h>
 #include <QtCore/qvariant.h>
 
@@ -60,6 +61,10 @@ public:
     QString shell() const;
     QString defaultBuildDirectory() const;
     CommandEchoMode defaultEchoMode() const;
+    QString artifactCacheDirectory() const;
+    bool artifactCacheIsRelocatable() const;
+    QString probeCacheDirectory() const;
+    QHash<QString, int> jobLimits() const;
     QStringList searchPaths(const QString &baseDir = QString()) const;
     QStringList pluginPaths(const QString &baseDir = QString()) const;
 
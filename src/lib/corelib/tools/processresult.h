@@ -52,12 +52,14 @@ QT_END_NAMESPACE
 
 namespace qbs {
 namespace Internal {
+class ArtifactCache;
 class ProcessCommandExecutor;
 class ProcessResultPrivate;
 }
 
 class QBS_EXPORT ProcessResult
 {
+    friend class qbs::Internal::ArtifactCache;
     friend class qbs::Internal::ProcessCommandExecutor;
 public:
     ProcessResult();
@@ -41,8 +41,14 @@
 
 #include <logging/logger.h>
 #include <logging/translator.h>
+#include <tools/error.h>
 
-#include <QtCore/qstring.h>
+#include <QtCore/qcoreapplication.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qjsonarray.h>
+#include <QtCore/qjsondocument.h>
+#include <QtCore/qjsonobject.h>
+#include <QtCore/qthread.h>
 
 namespace qbs {
 namespace Internal {
@@ -53,18 +59,24 @@ public:
     Logger logger;
     QString activity;
     QElapsedTimer timer;
+    bool logEnabled;
+    qint64 traceStartTime;
 };
 
 TimedActivityLogger::TimedActivityLogger(const Logger &logger, const QString &activity,
         bool enabled)
     : d(nullptr)
 {
-    if (!enabled)
+    TraceRecorder &traceRecorder = TraceRecorder::instance();
+    if (!enabled && !traceRecorder.isRecording())
         return;
     d = new TimedActivityLoggerPrivate;
     d->logger = logger;
     d->activity = activity;
-    d->logger.qbsLog(LoggerInfo, true) << Tr::tr("Starting activity '%2'.").arg(activity);
+    d->logEnabled = enabled;
+    d->traceStartTime = traceRecorder.isRecording() ? traceRecorder.currentTime() : -1;
+    if (enabled)
+        d->logger.qbsLog(LoggerInfo, true) << Tr::tr("Starting activity '%2'.").arg(activity);
     d->timer.start();
 }
 
@@ -72,9 +84,13 @@ void TimedActivityLogger::finishActivity()
 {
     if (!d)
         return;
-    const QString timeString = elapsedTimeString(d->timer.elapsed());
-    d->logger.qbsLog(LoggerInfo, true)
-            << Tr::tr("Activity '%2' took %3.").arg(d->activity, timeString);
+    if (d->traceStartTime != -1)
+        TraceRecorder::instance().addEvent("activity", d->activity, d->traceStartTime);
+    if (d->logEnabled) {
+        const QString timeString = elapsedTimeString(d->timer.elapsed());
+        d->logger.qbsLog(LoggerInfo, true)
+                << Tr::tr("Activity '%2' took %3.").arg(d->activity, timeString);
+    }
     delete d;
     d = nullptr;
 }
@@ -103,6 +119,119 @@ void AccumulatingTimer::stop()
     m_timer.invalidate();
 }
 
+TraceRecorder &TraceRecorder::instance()
+{
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.clear();
+    m_laneIds.clear();
+    m_threadLaneIds.clear();
+    m_laneNames.clear();
+    m_timer.start();
+    m_recording = true;
+}
+
+qint64 TraceRecorder::currentTime() const
+{
+    return m_timer.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::addEvent(const char *category, const QString &name, qint64 startTime,
+                             const QString &lane)
+{
+    if (!m_recording)
+        return;
+    const qint64 endTime = currentTime();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_events.push_back(Event{category, name, startTime, endTime - startTime, laneId(lane)});
+}
+
+// Must be called with the mutex locked.
+int TraceRecorder::laneId(const QString &lane)
+{
+    if (!lane.isEmpty()) {
+        const auto it = m_laneIds.constFind(lane);
+        if (it != m_laneIds.cend())
+            return it.value();
+        const int id = int(m_laneNames.size());
+        m_laneNames.push_back(lane);
+        m_laneIds.insert(lane, id);
+        return id;
+    }
+
+    const QThread * const thread = QThread::currentThread();
+    const auto it = m_threadLaneIds.constFind(thread);
+    if (it != m_threadLaneIds.cend())
+        return it.value();
+    const int id = int(m_laneNames.size());
+    const QCoreApplication * const app = QCoreApplication::instance();
+    m_laneNames.push_back(app && app->thread() == thread
+                          ? QStringLiteral("Main thread")
+                          : QStringLiteral("Thread %1").arg(m_threadLaneIds.size() + 1));
+    m_threadLaneIds.insert(thread, id);
+    return id;
+}
+
+void TraceRecorder::writeToFile(const QString &filePath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording = false;
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (size_t i = 0; i < m_laneNames.size(); ++i) {
+        traceEvents.append(QJsonObject{
+                               {QStringLiteral("name"), QStringLiteral("thread_name")},
+                               {QStringLiteral("ph"), QStringLiteral("M")},
+                               {QStringLiteral("pid"), pid},
+                               {QStringLiteral("tid"), int(i)},
+                               {QStringLiteral("args"),
+                                QJsonObject{{QStringLiteral("name"), m_laneNames.at(i)}}}});
+    }
+    for (const Event &event : m_events) {
+        traceEvents.append(QJsonObject{
+                               {QStringLiteral("name"), event.name},
+                               {QStringLiteral("cat"), QLatin1String(event.category)},
+                               {QStringLiteral("ph"), QStringLiteral("X")},
+                               {QStringLiteral("ts"), event.startTime},
+                               {QStringLiteral("dur"), event.duration},
+                               {QStringLiteral("pid"), pid},
+                               {QStringLiteral("tid"), event.lane}});
+    }
+    m_events.clear();
+
+    QFile traceFile(filePath);
+    if (!traceFile.open(QIODevice::WriteOnly)) {
+        throw ErrorInfo(Tr::tr("Cannot open trace file '%1' for writing: %2")
+                        .arg(filePath, traceFile.errorString()));
+    }
+    const QJsonObject trace{{QStringLiteral("traceEvents"), traceEvents},
+                            {QStringLiteral("displayTimeUnit"), QStringLiteral("ms")}};
+    if (traceFile.write(QJsonDocument(trace).toJson(QJsonDocument::Compact)) == -1) {
+        throw ErrorInfo(Tr::tr("Failed to write trace file '%1': %2")
+                        .arg(filePath, traceFile.errorString()));
+    }
+}
+
+TraceEvent::TraceEvent(const char *category, const QString &name) : m_category(category)
+{
+    const TraceRecorder &recorder = TraceRecorder::instance();
+    if (!recorder.isRecording())
+        return;
+    m_name = name;
+    m_startTime = recorder.currentTime();
+}
+
+TraceEvent::~TraceEvent()
+{
+    if (m_startTime != -1)
+        TraceRecorder::instance().addEvent(m_category, m_name, m_startTime);
+}
+
 QString elapsedTimeString(qint64 elapsedTimeInMs)
 {
     qint64 ms = elapsedTimeInMs;
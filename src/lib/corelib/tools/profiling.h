@@ -40,10 +40,18 @@
 #ifndef QBS_PROFILING_H
 #define QBS_PROFILING_H
 
+#include "qbs_export.h"
+
 #include <QtCore/qelapsedtimer.h>
+#include <QtCore/qhash.h>
+#include <QtCore/qstring.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
-class QString;
+class QThread;
 QT_END_NAMESPACE
 
 namespace qbs {
@@ -76,6 +84,59 @@ private:
     qint64 * const m_elapsedTime;
 };
 
+// Collects timed events and writes them in the Chrome trace event format, which can be
+// viewed in chrome://tracing or Perfetto. Nothing is recorded unless start() was called.
+class QBS_EXPORT TraceRecorder // Exported for use by command-line tools.
+{
+public:
+    static TraceRecorder &instance();
+
+    void start();
+    bool isRecording() const { return m_recording; }
+
+    // In microseconds since the call to start().
+    qint64 currentTime() const;
+
+    // Events without an explicit lane are attributed to the calling thread.
+    void addEvent(const char *category, const QString &name, qint64 startTime,
+                  const QString &lane = QString());
+
+    void writeToFile(const QString &filePath);
+
+private:
+    TraceRecorder() = default;
+    int laneId(const QString &lane);
+
+    struct Event
+    {
+        const char *category;
+        QString name;
+        qint64 startTime;
+        qint64 duration;
+        int lane;
+    };
+
+    std::atomic<bool> m_recording{false};
+    QElapsedTimer m_timer;
+    std::mutex m_mutex;
+    std::vector<Event> m_events;
+    QHash<QString, int> m_laneIds;
+    QHash<const QThread *, int> m_threadLaneIds;
+    std::vector<QString> m_laneNames;
+};
+
+class TraceEvent
+{
+public:
+    TraceEvent(const char *category, const QString &name);
+    ~TraceEvent();
+
+private:
+    const char * const m_category;
+    QString m_name;
+    qint64 m_startTime = -1;
+};
+
 } // namespace Internal
 } // namespace qbs
 
@@ -83,7 +83,7 @@ void QbsProcess::doStart()
     p.arguments = m_arguments;
     p.env = m_environment.toStringList();
     p.workingDir = m_workingDirectory;
-    sendPacket(p);
+    LauncherInterface::socket()->sendStartProcessPacket(p);
 }
 
 void QbsProcess::cancel()
@@ -129,30 +129,33 @@ void LauncherSocketHandler::start()
 
 void LauncherSocketHandler::handleSocketData()
 {
-    try {
-        if (!m_packetParser.parse())
+    // The client queues up requests and writes them in one go, so we typically get
+    // a whole batch of start requests here.
+    while (true) {
+        try {
+            if (!m_packetParser.parse())
+                return;
+        } catch (const PacketParser::InvalidPacketSizeException &e) {
+            logWarn(QString::fromLatin1("Internal protocol error: invalid packet size %1.")
+                    .arg(e.size));
             return;
-    } catch (const PacketParser::InvalidPacketSizeException &e) {
-        logWarn(QString::fromLatin1("Internal protocol error: invalid packet size %1.")
-                .arg(e.size));
-        return;
-    }
-    switch (m_packetParser.type()) {
-    case LauncherPacketType::StartProcess:
-        handleStartPacket();
-        break;
-    case LauncherPacketType::StopProcess:
-        handleStopPacket();
-        break;
-    case LauncherPacketType::Shutdown:
-        handleShutdownPacket();
-        return;
-    default:
-        logWarn(QString::fromLatin1("Internal protocol error: invalid packet type %1.")
-                .arg(static_cast<int>(m_packetParser.type())));
-        return;
+        }
+        switch (m_packetParser.type()) {
+        case LauncherPacketType::StartProcess:
+            handleStartPacket();
+            break;
+        case LauncherPacketType::StopProcess:
+            handleStopPacket();
+            break;
+        case LauncherPacketType::Shutdown:
+            handleShutdownPacket();
+            return;
+        default:
+            logWarn(QString::fromLatin1("Internal protocol error: invalid packet type %1.")
+                    .arg(static_cast<int>(m_packetParser.type())));
+            return;
+        }
     }
-    handleSocketData();
 }
 
 void LauncherSocketHandler::handleSocketError()
@@ -220,6 +223,11 @@ void LauncherSocketHandler::handleStopFailure()
 
 void LauncherSocketHandler::handleStartPacket()
 {
+    const auto packet = LauncherPacket::extractPacket<StartProcessPacket>(
+                m_packetParser.token(),
+                m_packetParser.packetData());
+    if (!packet.env.empty())
+        m_environments.insert(packet.envId, packet.env);
     Process *& process = m_processes[m_packetParser.token()];
     if (!process)
         process = setupProcess(m_packetParser.token());
@@ -227,10 +235,7 @@ void LauncherSocketHandler::handleStartPacket()
         logWarn("got start request while process was running");
         return;
     }
-    const auto packet = LauncherPacket::extractPacket<StartProcessPacket>(
-                m_packetParser.token(),
-                m_packetParser.packetData());
-    process->setEnvironment(packet.env);
+    process->setEnvironment(m_environments.value(packet.envId));
     process->setWorkingDirectory(packet.workingDir);
     process->start(packet.command, packet.arguments);
 }
@@ -84,6 +84,7 @@ private:
     QLocalSocket * const m_socket;
     PacketParser m_packetParser;
     QHash<quintptr, Process *> m_processes;
+    QHash<quint32, QStringList> m_environments;
 };
 
 } // namespace Internal
@@ -306,7 +306,7 @@ ScannerPlugin includeScanner =
     closeScanner,
     next,
     additionalFileTags,
-    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies
+    ScannerUsesCppIncludePaths | ScannerRecursiveDependencies | ScannerSupportsConcurrentScanning
 };
 
 ScannerPlugin *cppScanners[] = { &includeScanner, NULL };
@@ -183,7 +183,7 @@ ScannerPlugin qrcScanner =
     closeScannerQrc,
     nextQrc,
     additionalFileTagsQrc,
-    NoScannerFlags
+    ScannerSupportsConcurrentScanning
 };
 
 ScannerPlugin *qtScanners[] = {&qrcScanner, NULL};
@@ -85,7 +85,11 @@ enum ScannerFlags
 {
     NoScannerFlags = 0x00,
     ScannerUsesCppIncludePaths = 0x01,
-    ScannerRecursiveDependencies = 0x02
+    ScannerRecursiveDependencies = 0x02,
+
+    // The open(), next(), additionalFileTags() and close() functions may be called
+    // for different handles from several threads at the same time.
+    ScannerSupportsConcurrentScanning = 0x04
 };
 
 class ScannerPlugin
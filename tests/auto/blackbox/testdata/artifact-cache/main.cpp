@@ -0,0 +1,6 @@
+#pragma message("compiler output to replay")
+
+int main()
+{
+    return 0;
+}
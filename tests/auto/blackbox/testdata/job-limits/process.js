@@ -0,0 +1,17 @@
+var File = require("qbs.File");
+var FileInfo = require("qbs.FileInfo");
+var TextFile = require("qbs.TextFile");
+
+function process(buildDirectory, inputFilePath, outputFilePath)
+{
+    var lockFilePath = FileInfo.joinPaths(buildDirectory, "running");
+    if (File.exists(lockFilePath))
+        throw "Two commands from the exclusive pool are running concurrently.";
+    var lockFile = new TextFile(lockFilePath, TextFile.WriteOnly);
+    lockFile.close();
+    var end = Date.now() + 300;
+    while (Date.now() < end)
+        ;
+    File.remove(lockFilePath);
+    File.copy(inputFilePath, outputFilePath);
+}
@@ -39,6 +39,7 @@
 #include <tools/version.h>
 
 #include <QtCore/qdebug.h>
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qjsonarray.h>
 #include <QtCore/qjsondocument.h>
 #include <QtCore/qjsonobject.h>
@@ -47,6 +48,7 @@
 #include <QtCore/qregexp.h>
 #include <QtCore/qtemporarydir.h>
 #include <QtCore/qtemporaryfile.h>
+#include <QtCore/qthread.h>
 
 #include <functional>
 #include <regex>
@@ -75,6 +77,26 @@ public:
     }
 };
 
+// Sets a preference in the test settings for as long as the object lives.
+class TemporarySetting {
+public:
+    TemporarySetting(const QString &key, const QVariant &value)
+        : m_settings(settings()), m_key(key)
+    {
+        m_settings->setValue(m_key, value);
+        m_settings->sync();
+    }
+
+    ~TemporarySetting() {
+        m_settings->remove(m_key);
+        m_settings->sync();
+    }
+
+private:
+    const SettingsPtr m_settings;
+    const QString m_key;
+};
+
 QMap<QString, QString> TestBlackbox::findCli(int *status)
 {
     QTemporaryDir temp;
@@ -367,6 +389,62 @@ void TestBlackbox::alwaysRun_data()
     QTest::newRow("Rule") << "rule.qbs";
 }
 
+void TestBlackbox::artifactCache()
+{
+    QDir::setCurrent(testDataDir + "/artifact-cache");
+    const QString cacheDir = QDir::currentPath() + "/cache";
+    rmDirR(cacheDir);
+    const TemporarySetting cacheDirSetting("preferences.artifactCacheDirectory", cacheDir);
+
+    rmDirR("build1");
+    rmDirR("build2");
+
+    QbsRunParameters params;
+    params.buildDirectory = "build1";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("[cached]"), m_qbsStdout.constData());
+
+    // By default, the location of the build directory is part of the key.
+    params.buildDirectory = "build2";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("[cached]"), m_qbsStdout.constData());
+    params.buildDirectory = "build1";
+    rmDirR("build1");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp [cached]"), m_qbsStdout.constData());
+
+    // With relocatable entries, a different build directory picks up the compiler output
+    // from the cache.
+    const TemporarySetting relocatableSetting("preferences.artifactCacheRelocatable", true);
+    rmDirR("build1");
+    rmDirR("build2");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("[cached]"), m_qbsStdout.constData());
+    params.buildDirectory = "build2";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp [cached]"), m_qbsStdout.constData());
+    QVERIFY(regularFileExists("build2/" + relativeExecutableFilePath("app")));
+
+    // The output of the compiler is shown again.
+    QVERIFY2(m_qbsStdout.contains("compiler output to replay")
+             || m_qbsStderr.contains("compiler output to replay"),
+             (m_qbsStdout + m_qbsStderr).constData());
+
+    // Changed file contents lead to a different key.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QFile mainFile("main.cpp");
+    QVERIFY2(mainFile.open(QIODevice::ReadWrite), qPrintable(mainFile.errorString()));
+    QByteArray content = mainFile.readAll();
+    content.replace("return 0;", "return 1;");
+    mainFile.resize(0);
+    mainFile.write(content);
+    mainFile.close();
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("compiling main.cpp [cached]"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::artifactScanning()
 {
     const QString projectDir = testDataDir + "/artifact-scanning";
@@ -642,6 +720,30 @@ void TestBlackbox::changeInImportedFile()
     QVERIFY2(!m_qbsStdout.contains("output"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::changeInModuleCandidate()
+{
+    QDir::setCurrent(testDataDir + "/change-in-module-candidate");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("creating output for p1 with special module"),
+             m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating output for p2 with generic module"),
+             m_qbsStdout.constData());
+
+    // The module file that so far was used only by p1 now also applies to p2.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QFile moduleFile("modules/themodule/themodule-special.qbs");
+    QVERIFY2(moduleFile.open(QIODevice::ReadWrite), qPrintable(moduleFile.errorString()));
+    QByteArray content = moduleFile.readAll();
+    content.replace("product.name === \"p1\"", "true");
+    moduleFile.resize(0);
+    moduleFile.write(content);
+    moduleFile.close();
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("creating output for p1"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating output for p2 with special module"),
+             m_qbsStdout.constData());
+}
+
 void TestBlackbox::changeTrackingAndMultiplexing()
 {
     QDir::setCurrent(testDataDir + "/change-tracking-and-multiplexing");
@@ -1205,6 +1307,66 @@ void TestBlackbox::versionScript()
     QVERIFY2(globalSymbols.contains("dummyGlobal"), allSymbols.constData());
 }
 
+void TestBlackbox::watch()
+{
+    QDir::setCurrent(testDataDir + "/watch");
+    QFile::remove("input2.txt");
+    QProcess qbsProcess;
+    qbsProcess.setProcessChannelMode(QProcess::MergedChannels);
+    qbsProcess.start(qbsExecutableFilePath, QStringList() << "build"
+                     << "--settings-dir" << settings()->baseDirectory() << "-d" << "."
+                     << "--watch" << ("profile:" + profileName()));
+    QVERIFY2(qbsProcess.waitForStarted(), qPrintable(qbsProcess.errorString()));
+    struct ProcessKiller {
+        ~ProcessKiller() { process.kill(); process.waitForFinished(); }
+        QProcess &process;
+    } processKiller{qbsProcess};
+    Q_UNUSED(processKiller);
+
+    QByteArray output;
+    QByteArray consumedOutput;
+    const auto waitForOutput = [&qbsProcess, &output, &consumedOutput](const QByteArray &text) {
+        QElapsedTimer timer;
+        timer.start();
+        while (!output.contains(text) && timer.elapsed() < testTimeoutInMsecs()) {
+            if (!qbsProcess.waitForReadyRead(1000) && qbsProcess.state() != QProcess::Running)
+                break;
+            output += qbsProcess.readAll();
+        }
+        const int index = output.indexOf(text);
+        if (index == -1) {
+            qDebug("%s", output.constData());
+            return false;
+        }
+        consumedOutput = output.left(index + text.size());
+        output.remove(0, index + text.size());
+        return true;
+    };
+    const QByteArray watchingMessage = "Watching for changes";
+
+    QVERIFY(waitForOutput(watchingMessage));
+    QVERIFY2(consumedOutput.contains("creating input1.out"), consumedOutput.constData());
+
+    // A changed source file gets rebuilt without resolving the project again.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("input1.txt");
+    QVERIFY(waitForOutput(watchingMessage));
+    QVERIFY2(consumedOutput.contains("creating input1.out"), consumedOutput.constData());
+    QVERIFY2(!consumedOutput.contains("Project files changed"), consumedOutput.constData());
+
+    // A new file matching a wildcard makes the project get resolved again.
+    QFile newFile("input2.txt");
+    QVERIFY2(newFile.open(QIODevice::WriteOnly), qPrintable(newFile.errorString()));
+    newFile.write("second input");
+    newFile.close();
+    QVERIFY(waitForOutput(watchingMessage));
+    QVERIFY2(consumedOutput.contains("Project files changed"), consumedOutput.constData());
+    QVERIFY2(consumedOutput.contains("creating input2.out"), consumedOutput.constData());
+    QVERIFY2(!consumedOutput.contains("creating input1.out"), consumedOutput.constData());
+    QVERIFY(regularFileExists(relativeProductBuildDir("watch") + "/input2.out"));
+    QFile::remove("input2.txt");
+}
+
 void TestBlackbox::wholeArchive()
 {
     QDir::setCurrent(testDataDir + "/whole-archive");
@@ -1362,6 +1524,57 @@ void TestBlackbox::concurrentExecutor()
     QVERIFY2(!m_qbsStderr.contains("ASSERT"), m_qbsStderr.constData());
 }
 
+void TestBlackbox::concurrentPrepareScripts()
+{
+    QDir::setCurrent(testDataDir + "/concurrent-prepare-scripts");
+    QbsRunParameters failParams(QStringList("products.concurrent-prepare-scripts"
+                                            ".failInPrepare:true"));
+    failParams.expectFailure = true;
+    QVERIFY(runQbs(failParams) != 0);
+    QVERIFY2(m_qbsStderr.contains("prepare failed for input5.txt"), m_qbsStderr.constData());
+
+    QCOMPARE(runQbs(QbsRunParameters("resolve", QStringList("products.concurrent-prepare-scripts"
+                                                            ".failInPrepare:false"))), 0);
+    QCOMPARE(runQbs(), 0);
+    for (int i = 1; i <= 24; ++i) {
+        const QString outputFile = relativeProductBuildDir("concurrent-prepare-scripts")
+                + "/input" + QString::number(i) + ".out";
+        QFile f(outputFile);
+        QVERIFY2(f.open(QIODevice::ReadOnly), qPrintable(outputFile));
+        QCOMPARE(f.readAll().trimmed(), "input " + QByteArray::number(i));
+    }
+}
+
+void TestBlackbox::concurrentProbes()
+{
+    QDir::setCurrent(testDataDir + "/concurrent-probes");
+
+    // The two slow probes report when their configure scripts started and finished.
+    const auto checkOverlap = [this]() -> bool {
+        QRegExp regExp("slow probes: (\\d+) (\\d+) (\\d+) (\\d+)");
+        if (regExp.indexIn(QString::fromLocal8Bit(m_qbsStdout)) == -1)
+            return false;
+        const qint64 start1 = regExp.cap(1).toLongLong();
+        const qint64 end1 = regExp.cap(2).toLongLong();
+        const qint64 start2 = regExp.cap(3).toLongLong();
+        const qint64 end2 = regExp.cap(4).toLongLong();
+        return start1 < end2 && start2 < end1;
+    };
+    const bool expectOverlap = QThread::idealThreadCount() > 1;
+
+    QbsRunParameters params("resolve");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("result: first+second, true"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("slow probes: "), m_qbsStdout.constData());
+    if (expectOverlap)
+        QVERIFY2(checkOverlap(), m_qbsStdout.constData());
+    params.arguments << "--force-probe-execution";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("result: first+second, true"), m_qbsStdout.constData());
+    if (expectOverlap)
+        QVERIFY2(checkOverlap(), m_qbsStdout.constData());
+}
+
 void TestBlackbox::conditionalExport()
 {
     QDir::setCurrent(testDataDir + "/conditional-export");
@@ -1410,6 +1623,56 @@ void TestBlackbox::conflictingArtifacts()
     QVERIFY2(m_qbsStderr.contains("Conflicting artifacts"), m_qbsStderr.constData());
 }
 
+void TestBlackbox::contentHashes()
+{
+    QDir::setCurrent(testDataDir + "/content-hashes");
+    const QbsRunParameters params(QStringList("--use-content-hashes"));
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("creating intermediate file"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating final file"), m_qbsStdout.constData());
+
+    // Timestamp changes only.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("input.txt");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("creating intermediate file"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("creating final file"), m_qbsStdout.constData());
+
+    // The outputs were touched, so the file system agrees with the build graph.
+    const QString intermediateFilePath = relativeProductBuildDir("content-hashes")
+            + "/intermediate.txt";
+    QVERIFY(QFileInfo(intermediateFilePath).lastModified()
+            >= QFileInfo("input.txt").lastModified());
+    QCOMPARE(runQbs(QbsRunParameters(QStringList{"--use-content-hashes",
+                                                 "--check-timestamps"})), 0);
+    QVERIFY2(!m_qbsStdout.contains("creating"), m_qbsStdout.constData());
+
+    // Content change that does not affect the intermediate file.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QFile inputFile("input.txt");
+    QVERIFY2(inputFile.open(QIODevice::WriteOnly), qPrintable(inputFile.errorString()));
+    inputFile.write("first line\nchanged second line\n");
+    inputFile.close();
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("creating intermediate file"), m_qbsStdout.constData());
+    QVERIFY2(!m_qbsStdout.contains("creating final file"), m_qbsStdout.constData());
+
+    // Content change that propagates.
+    WAIT_FOR_NEW_TIMESTAMP();
+    QVERIFY2(inputFile.open(QIODevice::WriteOnly), qPrintable(inputFile.errorString()));
+    inputFile.write("changed first line\nchanged second line\n");
+    inputFile.close();
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("creating intermediate file"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("creating final file"), m_qbsStdout.constData());
+
+    // Without the option, timestamps are all that counts.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("input.txt");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("creating intermediate file"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::cxxLanguageVersion()
 {
     QDir::setCurrent(testDataDir + "/cxx-language-version");
@@ -1518,6 +1781,25 @@ void TestBlackbox::cpuFeatures()
     }
 }
 
+void TestBlackbox::criticalPathScheduling()
+{
+    QDir::setCurrent(testDataDir + "/critical-path-scheduling");
+    const QbsRunParameters params(QStringList() << "-j" << "1");
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("processing slow input"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("processing fast input"), m_qbsStdout.constData());
+
+    // The durations recorded in the first build make the slow command get scheduled first.
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("fast.txt");
+    touch("slow.txt");
+    QCOMPARE(runQbs(params), 0);
+    const int slowIndex = m_qbsStdout.indexOf("processing slow input");
+    const int fastIndex = m_qbsStdout.indexOf("processing fast input");
+    QVERIFY2(slowIndex != -1 && fastIndex != -1, m_qbsStdout.constData());
+    QVERIFY2(slowIndex < fastIndex, m_qbsStdout.constData());
+}
+
 void TestBlackbox::renameDependency()
 {
     QDir::setCurrent(testDataDir + "/renameDependency");
@@ -2166,6 +2448,22 @@ void TestBlackbox::ruleWithNonRequiredInputs()
     QVERIFY2(m_qbsStdout.contains("Generating"), m_qbsStdout.constData());
 }
 
+void TestBlackbox::scanResultsFile()
+{
+    QDir::setCurrent(testDataDir + "/scan-results-file");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    QVERIFY(regularFileExists(relativeBuildGraphFilePath() + ".scan"));
+
+    // The include dependency must be known in a new qbs process.
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(!m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("header.h");
+    QCOMPARE(runQbs(), 0);
+    QVERIFY2(m_qbsStdout.contains("compiling main.cpp"), m_qbsStdout.constData());
+}
+
 void TestBlackbox::setupBuildEnvironment()
 {
     QDir::setCurrent(testDataDir + "/setup-build-environment");
@@ -2475,6 +2773,37 @@ void TestBlackbox::pluginDependency()
     QVERIFY(m_qbsStdout.contains("plugin4"));
 }
 
+void TestBlackbox::probeCache()
+{
+    QDir::setCurrent(testDataDir + "/probe-cache");
+    const QString cacheDir = QDir::currentPath() + "/cache";
+    rmDirR(cacheDir);
+    QFile::remove("marker.txt");
+    const TemporarySetting cacheDirSetting("preferences.probeCacheDirectory", cacheDir);
+
+    QbsRunParameters params("resolve");
+    params.buildDirectory = "build1";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("marker exists: false"), m_qbsStdout.constData());
+
+    // A different build directory picks up the probe result from the cache.
+    params.buildDirectory = "build2";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(!m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("marker exists: false"), m_qbsStdout.constData());
+
+    // A changed file system result invalidates the cache entry.
+    QFile marker("marker.txt");
+    QVERIFY2(marker.open(QIODevice::WriteOnly), qPrintable(marker.errorString()));
+    marker.close();
+    params.buildDirectory = "build3";
+    QCOMPARE(runQbs(params), 0);
+    QVERIFY2(m_qbsStdout.contains("running probe"), m_qbsStdout.constData());
+    QVERIFY2(m_qbsStdout.contains("marker exists: true"), m_qbsStdout.constData());
+    QVERIFY(QFile::remove("marker.txt"));
+}
+
 void TestBlackbox::probeChangeTracking()
 {
     QDir::setCurrent(testDataDir + "/probe-change-tracking");
@@ -3511,6 +3840,20 @@ void TestBlackbox::compilerDefinesByLanguage()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::jobLimits()
+{
+    QDir::setCurrent(testDataDir + "/job-limits");
+    QbsRunParameters params(QStringList() << "--job-limits" << "exclusive");
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("Illegal job limit"), m_qbsStderr.constData());
+
+    params.arguments = QStringList() << "-j" << "4" << "--job-limits" << "exclusive:1";
+    params.expectFailure = false;
+    QCOMPARE(runQbs(params), 0);
+    QCOMPARE(m_qbsStdout.count("processing input"), 8);
+}
+
 void TestBlackbox::jsExtensionsFile()
 {
     QDir::setCurrent(testDataDir + "/jsextensions-file");
@@ -3917,6 +4260,32 @@ void TestBlackbox::multipleChanges()
     QVERIFY(m_qbsStdout.contains("prop: true"));
 }
 
+void TestBlackbox::nativeFileCommands()
+{
+    QDir::setCurrent(testDataDir + "/native-file-commands");
+    QCOMPARE(runQbs(QStringList("-vv")), 0);
+    QCOMPARE(m_qbsStderr.count("running command natively"), 6);
+    const QString buildDir = relativeProductBuildDir("native-file-commands");
+    for (const QString &baseName : {QString("first"), QString("second")}) {
+        QFile copy(buildDir + '/' + baseName + ".copy2");
+        QVERIFY2(copy.open(QIODevice::ReadOnly), qPrintable(copy.fileName()));
+        QCOMPARE(copy.readAll().trimmed(), baseName.toUtf8());
+        QVERIFY(!QFile::exists(copy.fileName() + ".tmp"));
+        QFile written(buildDir + '/' + baseName + ".txt");
+        QVERIFY2(written.open(QIODevice::ReadOnly), qPrintable(written.fileName()));
+        QCOMPARE(written.readAll().trimmed(), "content of " + baseName.toUtf8());
+    }
+
+    QbsRunParameters params("resolve", QStringList("products.native-file-commands"
+                                                   ".removeSource:true"));
+    QCOMPARE(runQbs(params), 0);
+    params.command = "build";
+    params.arguments.clear();
+    params.expectFailure = true;
+    QVERIFY(runQbs(params) != 0);
+    QVERIFY2(m_qbsStderr.contains("first.copy.missing"), m_qbsStderr.constData());
+}
+
 void TestBlackbox::nestedGroups()
 {
     QDir::setCurrent(testDataDir + "/nested-groups");
@@ -4596,6 +4965,54 @@ void TestBlackbox::topLevelSearchPath()
     QCOMPARE(runQbs(params), 0);
 }
 
+void TestBlackbox::traceFile()
+{
+    QDir::setCurrent(testDataDir + "/trace-file");
+    const auto readTraceEvents = [] {
+        QFile traceFile("trace.json");
+        if (!traceFile.open(QIODevice::ReadOnly))
+            return QJsonArray();
+        return QJsonDocument::fromJson(traceFile.readAll()).object()
+                .value("traceEvents").toArray();
+    };
+    const auto eventNames = [](const QJsonArray &events, const QString &category) {
+        QStringList names;
+        for (const QJsonValue &v : events) {
+            const QJsonObject event = v.toObject();
+            if (event.value("ph").toString() == "X" && event.value("cat").toString() == category)
+                names << event.value("name").toString();
+        }
+        names.sort();
+        return names;
+    };
+
+    QbsRunParameters params(QStringList() << "-j" << "2" << "--trace-file" << "trace.json");
+    QCOMPARE(runQbs(params), 0);
+    QJsonArray events = readTraceEvents();
+    QVERIFY(!events.empty());
+    for (const QJsonValue &v : qAsConst(events)) {
+        const QJsonObject event = v.toObject();
+        if (event.value("ph").toString() != "X")
+            continue;
+        QVERIFY(event.value("ts").toDouble() >= 0);
+        QVERIFY(event.value("dur").toDouble() >= 0);
+    }
+    QCOMPARE(eventNames(events, "job"), QStringList() << "a.out" << "b.out");
+    QVERIFY(!eventNames(events, "rule").empty());
+    const QStringList probeNames = eventNames(events, "probe");
+    QCOMPARE(probeNames.size(), 1);
+    QVERIFY2(probeNames.first().startsWith("theProbe_"), qPrintable(probeNames.first()));
+    QVERIFY(eventNames(events, "buildgraph").contains("Storing build graph"));
+
+    WAIT_FOR_NEW_TIMESTAMP();
+    touch("a.txt");
+    QCOMPARE(runQbs(params), 0);
+    events = readTraceEvents();
+    QCOMPARE(eventNames(events, "job"), QStringList("a.out"));
+    QVERIFY(eventNames(events, "buildgraph").contains("Loading build graph"));
+    QVERIFY(eventNames(events, "probe").empty());
+}
+
 void TestBlackbox::checkProjectFilePath()
 {
     QDir::setCurrent(testDataDir + "/project_filepath_check");
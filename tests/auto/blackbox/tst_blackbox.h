@@ -42,6 +42,7 @@ private slots:
     void addFileTagToGeneratedArtifact();
     void alwaysRun();
     void alwaysRun_data();
+    void artifactCache();
     void artifactScanning();
     void assembly();
     void auxiliaryInputsFromDependencies();
@@ -53,6 +54,7 @@ private slots:
     void changedFiles();
     void changeInDisabledProduct();
     void changeInImportedFile();
+    void changeInModuleCandidate();
     void changeTrackingAndMultiplexing();
     void checkProjectFilePath();
     void checkTimestamps();
@@ -64,13 +66,17 @@ private slots:
     void commandFile();
     void compilerDefinesByLanguage();
     void concurrentExecutor();
+    void concurrentPrepareScripts();
+    void concurrentProbes();
     void conditionalExport();
     void conditionalFileTagger();
     void configure();
     void conflictingArtifacts();
+    void contentHashes();
     void cxxLanguageVersion();
     void cxxLanguageVersion_data();
     void cpuFeatures();
+    void criticalPathScheduling();
     void dependenciesProperty();
     void dependencyProfileMismatch();
     void deprecatedProperty();
@@ -127,6 +133,7 @@ private slots:
     void invalidInstallDir();
     void invalidLibraryNames();
     void invalidLibraryNames_data();
+    void jobLimits();
     void jsExtensionsFile();
     void jsExtensionsFileInfo();
     void jsExtensionsProcess();
@@ -151,6 +158,7 @@ private slots:
     void missingProjectFile();
     void missingOverridePrefix();
     void multipleChanges();
+    void nativeFileCommands();
     void nestedGroups();
     void nestedProperties();
     void newOutputArtifact();
@@ -168,6 +176,7 @@ private slots:
     void pkgConfigProbe_data();
     void pkgConfigProbeSysroot();
     void pluginDependency();
+    void probeCache();
     void probeChangeTracking();
     void probeProperties();
     void probeInExportedModule();
@@ -199,6 +208,7 @@ private slots:
     void ruleCycle();
     void ruleWithNoInputs();
     void ruleWithNonRequiredInputs();
+    void scanResultsFile();
     void setupBuildEnvironment();
     void setupRunEnvironment();
     void smartRelinking();
@@ -222,6 +232,7 @@ private slots:
     void tar();
     void toolLookup();
     void topLevelSearchPath();
+    void traceFile();
     void trackAddFile();
     void trackAddFileTag();
     void trackAddProduct();
@@ -240,6 +251,7 @@ private slots:
     void versionCheck();
     void versionCheck_data();
     void versionScript();
+    void watch();
     void wholeArchive();
     void wholeArchive_data();
     void wildCardsAndRules();
@@ -41,6 +41,8 @@
 #include <buildgraph/artifact.h>
 #include <buildgraph/buildgraph.h>
 #include <buildgraph/cycledetector.h>
+#include <buildgraph/depscanner.h>
+#include <buildgraph/inputartifactscanner.h>
 #include <buildgraph/productbuilddata.h>
 #include <buildgraph/projectbuilddata.h>
 #include <language/language.h>
@@ -49,8 +51,17 @@
 
 #include "../shared/logging/consolelogger.h"
 
+#include <QtCore/qfile.h>
+#include <QtCore/qtemporarydir.h>
+#include <QtCore/qthread.h>
+#include <QtCore/qthreadpool.h>
+
 #include <QtTest/qtest.h>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
 using namespace qbs;
 using namespace qbs::Internal;
 
@@ -138,6 +149,104 @@ void TestBuildGraph::testCycle()
     QVERIFY(!cycleDetected(productWithNoCycle()));
 }
 
+namespace {
+// Reports every line of a file as a dependency and records how many files were being
+// scanned at the same time.
+class LineScanner : public DependencyScanner
+{
+public:
+    LineScanner(bool concurrent) : m_concurrent(concurrent) {}
+
+    int maxConcurrentScans() const { return m_maxConcurrentScans; }
+
+private:
+    QStringList collectSearchPaths(Artifact *) override { return QStringList(); }
+    QStringList collectDependencies(FileResourceBase *file, const char *fileTags) override
+    {
+        const int concurrentScans = ++m_concurrentScans;
+        int maxConcurrentScans = m_maxConcurrentScans;
+        while (concurrentScans > maxConcurrentScans
+               && !m_maxConcurrentScans.compare_exchange_weak(maxConcurrentScans,
+                                                              concurrentScans)) {
+        }
+        QThread::msleep(10);
+        QFile f(file->filePath());
+        if (!f.open(QIODevice::ReadOnly)) {
+            --m_concurrentScans;
+            throw ErrorInfo(f.errorString());
+        }
+        QStringList dependencies;
+        for (const QByteArray &line : f.readAll().split('\n')) {
+            if (!line.isEmpty())
+                dependencies << QString::fromLatin1(line) + QLatin1Char(' ')
+                                + QString::fromLatin1(fileTags);
+        }
+        --m_concurrentScans;
+        return dependencies;
+    }
+    bool recursive() const override { return false; }
+    bool supportsConcurrentScanning() const override { return m_concurrent; }
+    const void *key() const override { return this; }
+    QString createId() const override { return QLatin1String("line-scanner"); }
+    bool areModulePropertiesCompatible(const PropertyMapConstPtr &,
+                                       const PropertyMapConstPtr &) const override
+    {
+        return true;
+    }
+
+    const bool m_concurrent;
+    std::atomic<int> m_concurrentScans{0};
+    std::atomic<int> m_maxConcurrentScans{0};
+};
+} // namespace
+
+void TestBuildGraph::testConcurrentScanning()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    std::vector<std::unique_ptr<Artifact>> artifacts;
+    std::vector<FileResourceBase *> files;
+    for (int i = 0; i < 20; ++i) {
+        const QString filePath = dir.path() + QLatin1String("/file") + QString::number(i);
+        QFile f(filePath);
+        if (i != 7) { // Let the scan of one file fail.
+            QVERIFY(f.open(QIODevice::WriteOnly));
+            for (int j = 0; j <= i; ++j)
+                f.write("dep" + QByteArray::number(i) + '_' + QByteArray::number(j) + '\n');
+            f.close();
+        }
+        artifacts.push_back(std::unique_ptr<Artifact>(new Artifact));
+        artifacts.back()->setFilePath(filePath);
+        files.push_back(artifacts.back().get());
+    }
+
+    LineScanner serialScanner(false);
+    LineScanner concurrentScanner(true);
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(4);
+    const std::vector<FileScanResult> serialResults
+            = scanFiles(&serialScanner, files, "cpp", nullptr);
+    const std::vector<FileScanResult> concurrentResults
+            = scanFiles(&concurrentScanner, files, "cpp", &threadPool);
+    QCOMPARE(serialScanner.maxConcurrentScans(), 1);
+    QVERIFY(concurrentScanner.maxConcurrentScans() > 1);
+    QCOMPARE(concurrentResults.size(), serialResults.size());
+    for (size_t i = 0; i < serialResults.size(); ++i) {
+        QCOMPARE(serialResults.at(i).dependencies.size(), i == 7 ? 0 : int(i) + 1);
+        QCOMPARE(concurrentResults.at(i).dependencies, serialResults.at(i).dependencies);
+        QCOMPARE(concurrentResults.at(i).error.hasError(), i == 7);
+        QCOMPARE(serialResults.at(i).error.hasError(), i == 7);
+    }
+
+    // Scanners that do not opt in are never run concurrently, even if there is a thread pool.
+    LineScanner nonConcurrentScanner(false);
+    const std::vector<FileScanResult> nonConcurrentResults
+            = scanFiles(&nonConcurrentScanner, files, "cpp", &threadPool);
+    QCOMPARE(nonConcurrentScanner.maxConcurrentScans(), 1);
+    for (size_t i = 0; i < serialResults.size(); ++i)
+        QCOMPARE(nonConcurrentResults.at(i).dependencies, serialResults.at(i).dependencies);
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -56,6 +56,7 @@ private slots:
     void initTestCase();
     void cleanupTestCase();
     void testCycle();
+    void testConcurrentScanning();
 
 private:
     qbs::Internal::ResolvedProductConstPtr productWithDirectCycle();
@@ -0,0 +1,4 @@
+function things(prefix)
+{
+    return [prefix + "a", prefix + "b"];
+}
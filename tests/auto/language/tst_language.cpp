@@ -49,6 +49,7 @@
 #include <language/item.h>
 #include <language/itempool.h>
 #include <language/language.h>
+#include <language/parsecache.h>
 #include <language/propertymapinternal.h>
 #include <language/scriptengine.h>
 #include <language/value.h>
@@ -65,7 +66,9 @@
 
 #include "../shared/logging/consolelogger.h"
 
+#include <QtCore/qdatastream.h>
 #include <QtCore/qprocess.h>
+#include <QtCore/qtemporarydir.h>
 
 #include <algorithm>
 #include <utility>
@@ -720,6 +723,9 @@ void TestLanguage::erroneousFiles_data()
             << "Can't find variable: outer";
     QTest::newRow("invalid_file")
             << "does not exist";
+    QTest::newRow("file-error-before-evaluation-error")
+            << "Error while handling product 'missing file':.*"
+               "File '.*nonexistent.txt' does not exist.";
     QTest::newRow("invalid-parameter-rhs")
             << "ReferenceError: Can't find variable: access";
     QTest::newRow("invalid-parameter-type")
@@ -1409,6 +1415,52 @@ void TestLanguage::jsImportUsedInMultipleScopes()
     QVERIFY(!exceptionCaught);
 }
 
+void TestLanguage::memoizedModuleProperties()
+{
+    bool exceptionCaught = false;
+    try {
+        defaultParameters.setProjectFilePath(testProject("memoized-module-properties.qbs"));
+        const TopLevelProjectPtr project = loader->loadProject(defaultParameters);
+        QVERIFY(!!project);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        QCOMPARE(products.size(), 3);
+        const auto stringValue = [](const PropertyMapConstPtr &properties,
+                                    const QString &name) {
+            return properties->moduleProperty("memomod", name).toString();
+        };
+        const auto listValue = [](const PropertyMapConstPtr &properties, const QString &name) {
+            return properties->moduleProperty("memomod", name).toStringList();
+        };
+
+        // The values evaluated for p1 must not be re-used where "base" is different.
+        const ResolvedProductConstPtr p1 = products.value("p1");
+        QVERIFY(!!p1);
+        QCOMPARE(stringValue(p1->moduleProperties, "derived"), QString("default-derived"));
+        QCOMPARE(listValue(p1->moduleProperties, "list"),
+                 QStringList({"default-derived", "suffix"}));
+        const ResolvedProductConstPtr p2 = products.value("p2");
+        QVERIFY(!!p2);
+        QCOMPARE(stringValue(p2->moduleProperties, "derived"), QString("custom-derived"));
+        QCOMPARE(listValue(p2->moduleProperties, "list"),
+                 QStringList({"custom-derived", "suffix"}));
+        const ResolvedProductConstPtr p3 = products.value("p3");
+        QVERIFY(!!p3);
+        QCOMPARE(stringValue(p3->moduleProperties, "derived"), QString("default-derived"));
+        GroupConstPtr group;
+        for (const GroupConstPtr &g : p3->groups) {
+            if (g->name == "g")
+                group = g;
+        }
+        QVERIFY(!!group);
+        QCOMPARE(stringValue(group->properties, "derived"), QString("group-derived"));
+        QCOMPARE(listValue(group->properties, "list"), QStringList({"group-derived", "suffix"}));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 void TestLanguage::moduleProperties_data()
 {
     QTest::addColumn<QString>("propertyName");
@@ -2001,6 +2053,134 @@ void TestLanguage::parameterTypes()
     QCOMPARE(exceptionCaught, false);
 }
 
+// Everything the parsed form of the project files can have an influence on.
+static QVariantMap projectDump(const TopLevelProjectConstPtr &project)
+{
+    QVariantMap dump;
+    for (const ResolvedProductConstPtr &product : project->allProducts()) {
+        QVariantMap productDump;
+        productDump.insert("location", product->location.toString());
+        productDump.insert("productProperties", product->productProperties);
+        productDump.insert("moduleProperties", product->moduleProperties->value());
+        for (const GroupConstPtr &group : product->groups) {
+            QStringList files;
+            for (const SourceArtifactConstPtr &artifact : group->allFiles())
+                files << artifact->absoluteFilePath;
+            QVariantMap groupDump;
+            groupDump.insert("location", group->location.toString());
+            groupDump.insert("files", files);
+            groupDump.insert("properties", group->properties->value());
+            productDump.insert("group " + group->name, groupDump);
+        }
+        dump.insert(product->name, productDump);
+    }
+    return dump;
+}
+
+static QByteArray fileContents(const QString &filePath)
+{
+    QFile file(filePath);
+    return file.open(QIODevice::ReadOnly) ? file.readAll() : QByteArray();
+}
+
+static bool writeFile(const QString &filePath, const QByteArray &contents)
+{
+    QFile file(filePath);
+    return file.open(QIODevice::WriteOnly) && file.write(contents) == contents.size();
+}
+
+static QByteArray cacheEntry(const QString &cacheFilePath, const QByteArray &key)
+{
+    ParseCache cache(cacheFilePath);
+    cache.load();
+    QByteArray data;
+    cache.find(key, &data);
+    return data;
+}
+
+void TestLanguage::parseCache()
+{
+    bool exceptionCaught = false;
+    try {
+        const QTemporaryDir buildRoot;
+        QVERIFY(buildRoot.isValid());
+        const QString cacheFilePath = ParseCache::deriveFilePath(buildRoot.path());
+        SetupProjectParameters params = defaultParameters;
+        params.setBuildRoot(buildRoot.path());
+        params.setProjectFilePath(testProject("parse-cache/parse-cache.qbs"));
+        const QByteArray projectFileContents = fileContents(params.projectFilePath());
+        QVERIFY(!projectFileContents.isEmpty());
+        const QByteArray projectFileKey
+                = ParseCache::key(ParseCache::Kind::QbsFile, projectFileContents);
+
+        const QVariantMap referenceDump = projectDump(loader->loadProject(params));
+        QVERIFY(referenceDump.contains("p1"));
+        QVERIFY(referenceDump.contains("p2"));
+        const QByteArray cacheContents = fileContents(cacheFilePath);
+        const QByteArray projectFileEntry = cacheEntry(cacheFilePath, projectFileKey);
+        QVERIFY(!projectFileEntry.isEmpty());
+
+        // Everything is taken from the cache, so it does not get rewritten.
+        QCOMPARE(projectDump(loader->loadProject(params)), referenceDump);
+        QCOMPARE(fileContents(cacheFilePath), cacheContents);
+
+        // A corrupt cache file is ignored and replaced.
+        QVERIFY(writeFile(cacheFilePath, cacheContents.left(cacheContents.size() / 2)));
+        QCOMPARE(projectDump(loader->loadProject(params)), referenceDump);
+        QCOMPARE(cacheEntry(cacheFilePath, projectFileKey), projectFileEntry);
+
+        // Same for a cache file written by a different qbs version.
+        QByteArray foreignContents;
+        QDataStream foreignStream(&foreignContents, QIODevice::WriteOnly);
+        QHash<QByteArray, QByteArray> foreignEntries;
+        foreignEntries.insert(projectFileKey, QByteArray("from another version"));
+        foreignStream << QByteArray("QBSPARSECACHE_1_0.0.1") << foreignEntries;
+        QVERIFY(writeFile(cacheFilePath, foreignContents));
+        QCOMPARE(projectDump(loader->loadProject(params)), referenceDump);
+        QCOMPARE(cacheEntry(cacheFilePath, projectFileKey), projectFileEntry);
+
+        // A corrupt entry in an otherwise valid cache file is ignored as well.
+        {
+            ParseCache cache(cacheFilePath);
+            cache.load();
+            cache.insert(projectFileKey, QByteArray("\x05\x00\x00\x00garbage", 11));
+            cache.store();
+        }
+        QVERIFY(cacheEntry(cacheFilePath, projectFileKey) != projectFileEntry);
+        QCOMPARE(projectDump(loader->loadProject(params)), referenceDump);
+        QCOMPARE(cacheEntry(cacheFilePath, projectFileKey), projectFileEntry);
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
+void TestLanguage::parseCacheErrorLocations()
+{
+    const QTemporaryDir buildRoot;
+    QVERIFY(buildRoot.isValid());
+    SetupProjectParameters params = defaultParameters;
+    params.setBuildRoot(buildRoot.path());
+    params.setProjectFilePath(testProject("parse-cache/duplicate-binding.qbs"));
+
+    // The second attempt reads the file from the cache, which was written despite the error.
+    QStringList errors;
+    for (int i = 0; i < 2; ++i) {
+        try {
+            loader->loadProject(params);
+            QFAIL("No error thrown on duplicate binding.");
+        } catch (const ErrorInfo &e) {
+            errors << e.toString();
+        }
+        QVERIFY(QFile::exists(ParseCache::deriveFilePath(buildRoot.path())));
+    }
+    QVERIFY2(errors.first().contains(QRegExp("Duplicate binding for 'name'"
+                                             ".*duplicate-binding.qbs:5:5")),
+             qPrintable(errors.first()));
+    QCOMPARE(errors.last(), errors.first());
+}
+
 void TestLanguage::pathProperties()
 {
     bool exceptionCaught = false;
@@ -2498,6 +2678,38 @@ void TestLanguage::requiredAndNonRequiredDependencies_data()
                                                       << false;
 }
 
+void TestLanguage::sharedPropertyMaps()
+{
+    bool exceptionCaught = false;
+    try {
+        SetupProjectParameters params = defaultParameters;
+        params.setProjectFilePath(testProject("shared-property-maps.qbs"));
+        const TopLevelProjectConstPtr project = loader->loadProject(params);
+        QVERIFY(!!project);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        const ResolvedProductConstPtr product = products.value("p");
+        QVERIFY(!!product);
+        QHash<QString, GroupConstPtr> groups;
+        for (const GroupConstPtr &group : product->groups)
+            groups.insert(group->name, group);
+        QCOMPARE(groups.size(), 4);
+        const PropertyMapConstPtr props1 = groups.value("g1")->properties;
+        const PropertyMapConstPtr props2 = groups.value("g2")->properties;
+        const PropertyMapConstPtr props3 = groups.value("g3")->properties;
+        const PropertyMapConstPtr props4 = groups.value("g4")->properties;
+        QCOMPARE(props1->moduleProperty("dummy", "someString").toString(), QString("x"));
+        QCOMPARE(props3->moduleProperty("dummy", "someString").toString(), QString("y"));
+        QCOMPARE(props1.get(), props2.get());
+        QVERIFY(props1.get() != props3.get());
+        QVERIFY(props4 == product->moduleProperties);
+        QVERIFY(groups.value("g2")->files.front()->properties == props1);
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 void TestLanguage::throwingProbe()
 {
     QFETCH(bool, enableProbe);
@@ -2848,6 +3060,46 @@ void TestLanguage::wildcards()
     QCOMPARE(exceptionCaught, false);
 }
 
+void TestLanguage::wildcardsInMultipleProducts()
+{
+    bool exceptionCaught = false;
+    try {
+        defaultParameters.setProjectFilePath(
+                    testProject("wildcards-in-multiple-products/"
+                                "wildcards-in-multiple-products.qbs"));
+        const TopLevelProjectPtr project = loader->loadProject(defaultParameters);
+        QVERIFY(!!project);
+        const QHash<QString, ResolvedProductPtr> products = productsFromProject(project);
+        QCOMPARE(products.size(), 3);
+        const QString baseDir = QFileInfo(defaultParameters.projectFilePath()).absolutePath()
+                + QLatin1Char('/');
+        const auto relativeFilePaths = [&baseDir](const ResolvedProductConstPtr &product)
+                -> QStringList {
+            QStringList filePaths;
+            for (const SourceArtifactConstPtr &artifact : product->allFiles()) {
+                QString filePath = artifact->absoluteFilePath;
+                if (filePath.startsWith(baseDir))
+                    filePath.remove(0, baseDir.size());
+                filePaths << filePath;
+            }
+            filePaths.sort();
+            return filePaths;
+        };
+        QVERIFY(!!products.value("a"));
+        QCOMPARE(relativeFilePaths(products.value("a")),
+                 QStringList({"a/a1.txt", "a/a2.txt"}));
+        QVERIFY(!!products.value("b"));
+        QCOMPARE(relativeFilePaths(products.value("b")), QStringList("b/b1.txt"));
+        QVERIFY(!!products.value("c"));
+        QCOMPARE(relativeFilePaths(products.value("c")),
+                 QStringList({"a/a1.txt", "c/c1.txt", "c/sub/c2.txt"}));
+    } catch (const ErrorInfo &e) {
+        exceptionCaught = true;
+        qDebug() << e.toString();
+    }
+    QCOMPARE(exceptionCaught, false);
+}
+
 int main(int argc, char *argv[])
 {
     QCoreApplication app(argc, argv);
@@ -117,6 +117,7 @@ private slots:
     void jsExtensions();
     void jsImportUsedInMultipleScopes_data();
     void jsImportUsedInMultipleScopes();
+    void memoizedModuleProperties();
     void moduleProperties_data();
     void moduleProperties();
     void modulePropertiesInGroups();
@@ -134,6 +135,8 @@ private slots:
     void overriddenPropertiesAndPrototypes();
     void overriddenPropertiesAndPrototypes_data();
     void parameterTypes();
+    void parseCache();
+    void parseCacheErrorLocations();
     void pathProperties();
     void productConditions();
     void productDirectories();
@@ -151,6 +154,7 @@ private slots:
     void relaxedErrorMode_data();
     void requiredAndNonRequiredDependencies();
     void requiredAndNonRequiredDependencies_data();
+    void sharedPropertyMaps();
     void throwingProbe();
     void throwingProbe_data();
     void defaultValue();
@@ -161,6 +165,7 @@ private slots:
     void versionCompare();
     void wildcards_data();
     void wildcards();
+    void wildcardsInMultipleProducts();
 };
 
 #endif // TST_LANGUAGE_H
@@ -48,6 +48,8 @@
 #include <tools/fileinfo.h>
 #include <tools/filesaver.h>
 #include <tools/hostosinfo.h>
+#include <tools/id.h>
+#include <tools/persistence.h>
 #include <tools/processutils.h>
 #include <tools/profile.h>
 #include <tools/set.h>
@@ -59,12 +61,17 @@
 #include <QtCore/qdir.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qpoint.h>
 #include <QtCore/qsettings.h>
 #include <QtCore/qtemporarydir.h>
 #include <QtCore/qtemporaryfile.h>
 
 #include <QtTest/qtest.h>
 
+#include <limits>
+#include <thread>
+#include <vector>
+
 using namespace qbs;
 using namespace qbs::Internal;
 
@@ -423,6 +430,102 @@ void TestTools::testProcessNameByPid()
     QCOMPARE(qAppName(), processNameByPid(QCoreApplication::applicationPid()));
 }
 
+static std::vector<QByteArray> idNames(const char *prefix, int count)
+{
+    std::vector<QByteArray> names;
+    for (int i = 0; i < count; ++i)
+        names.push_back(prefix + QByteArray::number(i));
+    return names;
+}
+
+void TestTools::id_concurrentInterning()
+{
+    const std::vector<QByteArray> names = idNames("concurrently-interned-", 5000);
+    const int threadCount = 8;
+    std::vector<std::vector<int>> ids(threadCount);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&names, &ids, t] {
+            for (const QByteArray &name : names)
+                ids[t].push_back(Id(name).uniqueIdentifier());
+        });
+    }
+    for (std::thread &thread : threads)
+        thread.join();
+    for (int t = 1; t < threadCount; ++t)
+        QVERIFY(ids.at(t) == ids.front());
+    for (size_t i = 0; i < names.size(); ++i) {
+        QCOMPARE(Id::fromUniqueIdentifier(ids.front().at(i)).name(), names.at(i));
+        QVERIFY(Id::fromUniqueIdentifier(ids.front().at(i)) == names.at(i).constData());
+    }
+}
+
+void TestTools::persistentPool_roundTrip()
+{
+    const QString nonAsciiString = QString::fromUtf8("some/p\xc3\xa4th");
+    const QVariantMap map {
+        {"invalid", QVariant()},
+        {"bool", true},
+        {"int", -42},
+        {"uint", 4000000000u},
+        {"longlong", Q_INT64_C(-1099511627776)},
+        {"double", 0.1},
+        {"bytes", QByteArray("\0x", 2)},
+        {"string", nonAsciiString},
+        {"list", QVariantList{1, "two", QStringList{"three", "four"}}},
+        {"map", QVariantMap{{"nested", 3.5}}},
+        {"other", QPoint(1, 2)}
+    };
+
+    Logger logger;
+    QByteArray data;
+    {
+        PersistentPool pool(logger);
+        pool.setupWriteStream(&data);
+        pool.store(map);
+        pool.store(QString());
+        pool.store(nonAsciiString);
+        pool.store(QByteArray());
+        pool.store(std::numeric_limits<qint64>::min());
+        pool.store(std::numeric_limits<quint64>::max());
+        pool.store(-1);
+    }
+
+    PersistentPool pool(logger);
+    pool.setupReadStream(data);
+    const QVariantMap loadedMap = pool.load<QVariantMap>();
+    QCOMPARE(loadedMap, map);
+    for (auto it = map.cbegin(); it != map.cend(); ++it)
+        QCOMPARE(loadedMap.value(it.key()).userType(), it.value().userType());
+    QVERIFY(pool.load<QString>().isNull());
+    QCOMPARE(pool.load<QString>(), nonAsciiString);
+    QVERIFY(pool.load<QByteArray>().isNull());
+    QCOMPARE(pool.load<qint64>(), std::numeric_limits<qint64>::min());
+    QCOMPARE(pool.load<quint64>(), std::numeric_limits<quint64>::max());
+    QCOMPARE(pool.load<int>(), -1);
+}
+
+void TestTools::persistentPool_truncatedData()
+{
+    Logger logger;
+    QByteArray data;
+    {
+        PersistentPool pool(logger);
+        pool.setupWriteStream(&data);
+        pool.store(QString("some string"));
+    }
+    data.chop(1);
+
+    PersistentPool pool(logger);
+    pool.setupReadStream(data);
+    bool exceptionCaught = false;
+    try {
+        pool.load<QString>();
+    } catch (const ErrorInfo &) {
+        exceptionCaught = true;
+    }
+    QVERIFY(exceptionCaught);
+}
 
 int toNumber(const QString &str)
 {
@@ -70,6 +70,11 @@ private slots:
     void testSettingsMigration();
     void testSettingsMigration_data();
 
+    void id_concurrentInterning();
+
+    void persistentPool_roundTrip();
+    void persistentPool_truncatedData();
+
     void set_operator_eq();
     void set_swap();
     void set_size();
@@ -32,7 +32,13 @@
 
 namespace qbsBenchmarker {
 
-enum Activity { ActivityResolving = 1, ActivityRuleExecution = 2, ActivityNullBuild = 4 };
+enum Activity {
+    ActivityResolving = 1,
+    ActivityRuleExecution = 2,
+    ActivityNullBuild = 4,
+    ActivityCommandExecution = 8,
+    ActivityBuildGraphStorage = 16
+};
 Q_DECLARE_FLAGS(Activities, Activity)
 Q_DECLARE_OPERATORS_FOR_FLAGS(Activities)
 
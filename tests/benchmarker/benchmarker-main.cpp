@@ -67,6 +67,12 @@ static void printResults(Activity activity, const BenchmarkResults &results,
     case ActivityNullBuild:
         std::cout << "Null Build";
         break;
+    case ActivityCommandExecution:
+        std::cout << "Command Execution";
+        break;
+    case ActivityBuildGraphStorage:
+        std::cout << "Build Graph Storage";
+        break;
     }
     std::cout << " ==========" << std::endl;
     const BenchmarkResult result = results.value(activity);
@@ -100,6 +106,10 @@ static void printResults(Activities activities, const BenchmarkResults &results,
         printResults(ActivityRuleExecution, results, regressionThreshold);
     if (activities & ActivityNullBuild)
         printResults(ActivityNullBuild, results, regressionThreshold);
+    if (activities & ActivityCommandExecution)
+        printResults(ActivityCommandExecution, results, regressionThreshold);
+    if (activities & ActivityBuildGraphStorage)
+        printResults(ActivityBuildGraphStorage, results, regressionThreshold);
 }
 
 int main(int argc, char *argv[])
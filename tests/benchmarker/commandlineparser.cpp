@@ -39,6 +39,8 @@ namespace qbsBenchmarker {
 static QString resolveActivity() { return "resolving"; }
 static QString ruleExecutionActivity() { return "rule-execution"; }
 static QString nullBuildActivity() { return "null-build"; }
+static QString commandExecutionActivity() { return "command-execution"; }
+static QString buildGraphStorageActivity() { return "build-graph-storage"; }
 static QString allActivities() { return "all"; }
 
 CommandLineParser::CommandLineParser()
@@ -64,9 +66,12 @@ void CommandLineParser::parse()
                                      "repo path");
     parser.addOption(qbsRepoOption);
     QCommandLineOption activitiesOption(QStringList{"activities", "a"},
-            QString::fromLatin1("The activities to benchmark. Possible values (CSV): %1,%2,%3,%4")
+            QString::fromLatin1("The activities to benchmark. Possible values (CSV): "
+                                "%1,%2,%3,%4,%5,%6")
                     .arg(resolveActivity(), ruleExecutionActivity(), nullBuildActivity(),
-                         allActivities()), "activities", allActivities());
+                         commandExecutionActivity(), buildGraphStorageActivity(),
+                         allActivities()),
+            "activities", allActivities());
     parser.addOption(activitiesOption);
     QCommandLineOption thresholdOption(QStringList{"regression-threshold", "t"},
             "A relative increase higher than this is considered a performance regression. "
@@ -90,7 +95,8 @@ void CommandLineParser::parse()
     m_activities = 0;
     for (const QString &activityString : activitiesList) {
         if (activityString == allActivities()) {
-            m_activities = ActivityResolving | ActivityRuleExecution | ActivityNullBuild;
+            m_activities = ActivityResolving | ActivityRuleExecution | ActivityNullBuild
+                    | ActivityCommandExecution | ActivityBuildGraphStorage;
             break;
         } else if (activityString == resolveActivity()) {
             m_activities = ActivityResolving;
@@ -98,6 +104,10 @@ void CommandLineParser::parse()
             m_activities |= ActivityRuleExecution;
         } else if (activityString == nullBuildActivity()) {
             m_activities |= ActivityNullBuild;
+        } else if (activityString == commandExecutionActivity()) {
+            m_activities |= ActivityCommandExecution;
+        } else if (activityString == buildGraphStorageActivity()) {
+            m_activities |= ActivityBuildGraphStorage;
         } else {
             throwException(activitiesOption.names().front(), activityString, parser.helpText());
         }
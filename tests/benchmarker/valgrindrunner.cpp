@@ -63,6 +63,10 @@ void ValgrindRunner::run()
         futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceRuleExecution));
     if (m_activities & ActivityNullBuild)
         futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceNullBuild));
+    if (m_activities & ActivityCommandExecution)
+        futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceCommandExecution));
+    if (m_activities & ActivityBuildGraphStorage)
+        futures.push_back(QtConcurrent::run(this, &ValgrindRunner::traceBuildGraphStorage));
     while (!futures.empty())
         futures.takeFirst().waitForFinished();
 }
@@ -92,6 +96,26 @@ void ValgrindRunner::traceNullBuild()
     traceActivity(ActivityNullBuild, buildDirCallgrind, buildDirMassif);
 }
 
+void ValgrindRunner::traceCommandExecution()
+{
+    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.command-execution.callgrind";
+    const QString buildDirMassif = m_baseOutputDir + "/build-dir.command-execution.massif";
+    runProcess(qbsCommandLine("resolve", buildDirCallgrind, false));
+    runProcess(qbsCommandLine("resolve", buildDirMassif, false));
+    traceActivity(ActivityCommandExecution, buildDirCallgrind, buildDirMassif);
+}
+
+// Updating the timestamps loads the complete build graph and stores it again, with hardly
+// any other work in between.
+void ValgrindRunner::traceBuildGraphStorage()
+{
+    const QString buildDirCallgrind = m_baseOutputDir + "/build-dir.build-graph-storage.callgrind";
+    const QString buildDirMassif = m_baseOutputDir + "/build-dir.build-graph-storage.massif";
+    runProcess(qbsCommandLine("build", buildDirCallgrind, false));
+    runProcess(qbsCommandLine("build", buildDirMassif, false));
+    traceActivity(ActivityBuildGraphStorage, buildDirCallgrind, buildDirMassif);
+}
+
 void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCallgrind,
                                    const QString &buildDirMassif)
 {
@@ -114,6 +138,16 @@ void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCal
         qbsCommand = "build";
         dryRun = false;
         break;
+    case ActivityCommandExecution:
+        activityString = "command-execution";
+        qbsCommand = "build";
+        dryRun = false;
+        break;
+    case ActivityBuildGraphStorage:
+        activityString = "build-graph-storage";
+        qbsCommand = "update-timestamps";
+        dryRun = false;
+        break;
     }
 
     const QString outFileCallgrind = m_baseOutputDir + "/outfile." + activityString + ".callgrind";
@@ -130,8 +164,9 @@ void ValgrindRunner::traceActivity(Activity activity, const QString &buildDirCal
 QStringList ValgrindRunner::qbsCommandLine(const QString &command, const QString &buildDir,
                                            bool dryRun) const
 {
-    QStringList commandLine = QStringList() << m_qbsBinary << command << "-qq" << "-d" << buildDir
-                                            << "-f" << m_testProject;
+    QStringList commandLine = QStringList() << m_qbsBinary << command << "-qq" << "-d" << buildDir;
+    if (command != "update-timestamps") // Works on the existing build graph only.
+        commandLine << "-f" << m_testProject;
     if (dryRun)
         commandLine << "--dry-run";
     return commandLine;
@@ -65,6 +65,8 @@ private:
     void traceResolving();
     void traceRuleExecution();
     void traceNullBuild();
+    void traceCommandExecution();
+    void traceBuildGraphStorage();
     void traceActivity(Activity activity, const QString &buildDirCallgrind,
                        const QString &buildDirMassif);
     QStringList qbsCommandLine(const QString &command, const QString &buildDir, bool dryRun) const;
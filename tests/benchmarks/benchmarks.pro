@@ -0,0 +1,3 @@
+TEMPLATE = subdirs
+
+qbs_enable_unit_tests: SUBDIRS += id-interner
@@ -0,0 +1,12 @@
+TARGET = tst_bench_idinterner
+DESTDIR = ../../../bin
+INCLUDEPATH += $$PWD/../../../src
+
+QT = core testlib
+CONFIG += console c++11
+CONFIG -= app_bundle
+target.CONFIG += no_default_install
+
+SOURCES = tst_bench_idinterner.cpp
+
+include(../../../src/lib/corelib/use_corelib.pri)
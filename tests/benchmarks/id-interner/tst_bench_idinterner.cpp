@@ -0,0 +1,163 @@
+/****************************************************************************
+**
+** Copyright (C) 2018 The Qt Company Ltd.
+** Contact: https://www.qt.io/licensing/
+**
+** This file is part of Qbs.
+**
+** $QT_BEGIN_LICENSE:LGPL$
+** Commercial License Usage
+** Licensees holding valid commercial Qt licenses may use this file in
+** accordance with the commercial license agreement provided with the
+** Software or, alternatively, in accordance with the terms contained in
+** a written agreement between you and The Qt Company. For licensing terms
+** and conditions see https://www.qt.io/terms-conditions. For further
+** information use the contact form at https://www.qt.io/contact-us.
+**
+** GNU Lesser General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU Lesser
+** General Public License version 3 as published by the Free Software
+** Foundation and appearing in the file LICENSE.LGPL3 included in the
+** packaging of this file. Please review the following information to
+** ensure the GNU Lesser General Public License version 3 requirements
+** will be met: https://www.gnu.org/licenses/lgpl-3.0.html.
+**
+** GNU General Public License Usage
+** Alternatively, this file may be used under the terms of the GNU
+** General Public License version 2.0 or (at your option) the GNU General
+** Public license version 3 or any later version approved by the KDE Free
+** Qt Foundation. The licenses are as published by the Free Software
+** Foundation and appearing in the file LICENSE.GPL2 and LICENSE.GPL3
+** included in the packaging of this file. Please review the following
+** information to ensure the GNU General Public License requirements will
+** be met: https://www.gnu.org/licenses/gpl-2.0.html and
+** https://www.gnu.org/licenses/gpl-3.0.html.
+**
+** $QT_END_LICENSE$
+**
+****************************************************************************/
+
+#include <tools/id.h>
+
+#include <QtTest/qtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+using namespace qbs::Internal;
+
+class TestIdInterner : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void lookup();
+    void lookup_data();
+};
+
+static std::vector<QByteArray> idNames(const char *prefix, int count)
+{
+    std::vector<QByteArray> names;
+    for (int i = 0; i < count; ++i)
+        names.push_back(prefix + QByteArray::number(i));
+    return names;
+}
+
+namespace {
+// The interner as it was before it became safe to use from several threads.
+class LegacyIdInterner
+{
+public:
+    ~LegacyIdInterner()
+    {
+        for (auto it = m_ids.cbegin(); it != m_ids.cend(); ++it)
+            delete[] it.key().str;
+    }
+
+    int id(const char *str)
+    {
+        const Key key(str);
+        int res = m_ids.value(key, 0);
+        if (res == 0) {
+            res = m_firstUnusedId++;
+            m_ids.insert(Key(qstrdup(str)), res);
+        }
+        return res;
+    }
+
+private:
+    struct Key
+    {
+        explicit Key(const char *s) : str(s), h(0)
+        {
+            int length = int(qstrlen(s));
+            while (length--) {
+                h = (h << 4) + *s++;
+                h ^= (h & 0xf0000000) >> 23;
+                h &= 0x0fffffff;
+            }
+        }
+        bool operator==(const Key &other) const
+        {
+            return h == other.h && std::strcmp(str, other.str) == 0;
+        }
+
+        const char *str;
+        uint h;
+    };
+    friend uint qHash(const Key &key) { return key.h; }
+
+    QHash<Key, int> m_ids;
+    int m_firstUnusedId = 1;
+};
+} // namespace
+
+void TestIdInterner::lookup()
+{
+    QFETCH(bool, legacy);
+    QFETCH(int, threadCount);
+    const std::vector<QByteArray> names = idNames("benchmark-tag-", 2000);
+    LegacyIdInterner legacyInterner;
+    for (const QByteArray &name : names) {
+        if (legacy)
+            legacyInterner.id(name.constData());
+        else
+            Id(name).uniqueIdentifier();
+    }
+    const auto lookUpAll = [&names, &legacyInterner, legacy]() -> qint64 {
+        qint64 sum = 0;
+        for (int i = 0; i < 10; ++i) {
+            for (const QByteArray &name : names) {
+                sum += legacy ? legacyInterner.id(name.constData())
+                              : Id(name).uniqueIdentifier();
+            }
+        }
+        return sum;
+    };
+    QBENCHMARK {
+        if (threadCount == 1) {
+            QVERIFY(lookUpAll() > 0);
+        } else {
+            std::vector<std::thread> threads;
+            for (int t = 0; t < threadCount; ++t)
+                threads.emplace_back(lookUpAll);
+            for (std::thread &thread : threads)
+                thread.join();
+        }
+    }
+}
+
+void TestIdInterner::lookup_data()
+{
+    QTest::addColumn<bool>("legacy");
+    QTest::addColumn<int>("threadCount");
+    // The legacy interner is not thread-safe, so it only takes part in the single-thread run.
+    QTest::newRow("legacy interner, 1 thread") << true << 1;
+    QTest::newRow("sharded interner, 1 thread") << false << 1;
+    QTest::newRow("sharded interner, 4 threads") << false << 4;
+}
+
+QTEST_GUILESS_MAIN(TestIdInterner)
+
+#include "tst_bench_idinterner.moc"
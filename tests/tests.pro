@@ -1,2 +1,2 @@
 TEMPLATE = subdirs
-SUBDIRS = auto fuzzy-test benchmarker
+SUBDIRS = auto fuzzy-test benchmarker benchmarks